@@ -22,6 +22,11 @@ external int audiopc_set_source_path(ffi.Pointer<ffi.Char> path);
 @ffi.Native<ffi.Int32 Function(ffi.Pointer<ffi.Char>)>()
 external int audiopc_set_source_url(ffi.Pointer<ffi.Char> url);
 
+/// Set a live Icecast/SHOUTcast or HLS (`.m3u8`) stream as the source.  The
+/// stream is buffered, reconnects automatically and cannot seek.
+@ffi.Native<ffi.Int32 Function(ffi.Pointer<ffi.Char>)>()
+external int audiopc_set_source_live(ffi.Pointer<ffi.Char> url);
+
 @ffi.Native<ffi.Int32 Function(ffi.Pointer<ffi.Uint8>, ffi.Int32)>()
 external int audiopc_set_source_memory(ffi.Pointer<ffi.Uint8> data, int len);
 
@@ -46,9 +51,23 @@ external double audiopc_get_rate();
 @ffi.Native<ffi.Int32 Function(ffi.Int32)>()
 external int audiopc_set_max_queue_seconds(int seconds);
 
+/// Enable (non-zero) or disable (0) TPDF dither on integer output formats.
+@ffi.Native<ffi.Int32 Function(ffi.Int32)>()
+external int audiopc_set_output_dither(int enabled);
+
 @ffi.Native<ffi.Int32 Function()>()
 external int audiopc_get_max_queue_seconds();
 
+/// Choose how decoded samples are queued: `QUEUE_STORAGE_F32`,
+/// `QUEUE_STORAGE_I16` or `QUEUE_STORAGE_F16`.  The 16-bit modes halve the
+/// memory of long queues.
+@ffi.Native<ffi.Int32 Function(ffi.Int32)>()
+external int audiopc_set_queue_storage(int mode);
+
+/// Bytes allocated for the decoded sample queue.
+@ffi.Native<ffi.Int64 Function()>()
+external int audiopc_queue_bytes();
+
 @ffi.Native<ffi.Int32 Function()>()
 external int audiopc_buffered_samples();
 
@@ -61,31 +80,93 @@ external int audiopc_seek_millis(int millis);
 @ffi.Native<ffi.Int32 Function()>()
 external int audiopc_duration_millis();
 
+/// Progress of the background load started by the last `set_source` call
+/// (one of the `SOURCE_LOAD_*` constants).
+@ffi.Native<ffi.Int32 Function()>()
+external int audiopc_source_load_state();
+
 @ffi.Native<ffi.Int32 Function()>()
 external int audiopc_position_millis();
 
+/// Current host time (ns): the time base of `audiopc_schedule_at_time` and
+/// the clock queries, shared by everything in the process.
+@ffi.Native<ffi.Int64 Function()>(isLeaf: true)
+external int audiopc_clock_now_ns();
+
+/// Output frame (engine sample time) heard at host time `host_ns`, or -1
+/// until the output has started.
+@ffi.Native<ffi.Int64 Function(ffi.Int64)>(isLeaf: true)
+external int audiopc_clock_frame_at(int host_ns);
+
+/// Host time (ns) at which output frame `frame` is heard, or -1 until the
+/// output has started.
+@ffi.Native<ffi.Int64 Function(ffi.Int64)>(isLeaf: true)
+external int audiopc_clock_time_at(int frame);
+
+/// Run `command` (`SCHEDULE_*`, taking `value` as its argument) when output
+/// frame `frame` is heard, splitting the callback block at that sample.
+/// Starts the output if needed.  Returns the command's id (> 0), which tags
+/// its `EVENT_SCHEDULE_FIRED` event.
+@ffi.Native<ffi.Int32 Function(ffi.Int32, ffi.Double, ffi.Int64)>()
+external int audiopc_schedule(int command, double value, int frame);
+
+/// Like `audiopc_schedule`, due at host time `host_ns` (see
+/// `audiopc_clock_now_ns`).
+@ffi.Native<ffi.Int32 Function(ffi.Int32, ffi.Double, ffi.Int64)>()
+external int audiopc_schedule_at_time(int command, double value, int host_ns);
+
+/// Cancel scheduled command `id`.
+@ffi.Native<ffi.Int32 Function(ffi.Int32)>()
+external int audiopc_cancel_scheduled(int id);
+
+/// Cancel every scheduled command.
+@ffi.Native<ffi.Int32 Function()>()
+external int audiopc_clear_schedule();
+
 @ffi.Native<ffi.Int32 Function()>()
 external int audiopc_is_playing();
 
 @ffi.Native<ffi.Int32 Function()>()
 external int audiopc_get_player_state();
 
-@ffi.Native<ffi.Int32 Function()>()
+/// Wait up to `timeout_ms` for the next engine event and write it into
+/// `buffer` as JSON: `{"kind": EVENT_*, ...fields}`.
+///
+/// Blocks without holding the engine lock, so call it from a dedicated
+/// thread or isolate.  `buffer` should hold `EVENT_JSON_MAX_BYTES`.
+/// Returns the JSON length, 0 on timeout, -2 for bad arguments or an event
+/// that did not fit (it is discarded), -500 if the engine is unavailable.
+@ffi.Native<ffi.Int32 Function(ffi.Pointer<ffi.Char>, ffi.Int32, ffi.Int32)>()
+external int audiopc_wait_event(
+  ffi.Pointer<ffi.Char> buffer,
+  int max_len,
+  int timeout_ms,
+);
+
+/// Events discarded so far because nobody drained the bus in time.
+@ffi.Native<ffi.Int64 Function()>()
+external int audiopc_dropped_event_count();
+
+@ffi.Native<ffi.Int32 Function()>(isLeaf: true)
 external int audiopc_visualizer_available_samples();
 
-@ffi.Native<ffi.Int32 Function()>()
+@ffi.Native<ffi.Int32 Function()>(isLeaf: true)
 external int audiopc_visualizer_sample_rate();
 
-@ffi.Native<ffi.Int32 Function()>()
+@ffi.Native<ffi.Int32 Function()>(isLeaf: true)
 external int audiopc_visualizer_channels();
 
-@ffi.Native<ffi.Int32 Function(ffi.Pointer<ffi.Float>, ffi.Int32)>()
+@ffi.Native<
+  ffi.Int32 Function(ffi.Pointer<ffi.Float>, ffi.Int32)
+>(isLeaf: true)
 external int audiopc_copy_visualizer_samples(
   ffi.Pointer<ffi.Float> buffer,
   int max_samples,
 );
 
-@ffi.Native<ffi.Int32 Function(ffi.Pointer<ffi.Float>, ffi.Int32)>()
+@ffi.Native<
+  ffi.Int32 Function(ffi.Pointer<ffi.Float>, ffi.Int32)
+>(isLeaf: true)
 external int audiopc_copy_visualizer_spectrum(
   ffi.Pointer<ffi.Float> buffer,
   int max_bars,
@@ -145,14 +226,178 @@ external int audiopc_set_lowpass_hz(double cutoff_hz, double q);
 @ffi.Native<ffi.Int32 Function(ffi.Float, ffi.Float)>()
 external int audiopc_set_high_pass_filter(double cutoff_hz, double q);
 
+/// Convolve the output with the impulse response in the file at `path`.
+/// Blocks while the IR is decoded and transformed.
+@ffi.Native<ffi.Int32 Function(ffi.Pointer<ffi.Char>, ffi.Float, ffi.Float)>()
+external int audiopc_set_convolution_ir_path(
+  ffi.Pointer<ffi.Char> path,
+  double wet,
+  double dry,
+);
+
+/// Convolve the output with an impulse response given as `len` encoded
+/// bytes.
+@ffi.Native<
+  ffi.Int32 Function(ffi.Pointer<ffi.Uint8>, ffi.Int32, ffi.Float, ffi.Float)
+>()
+external int audiopc_set_convolution_ir_memory(
+  ffi.Pointer<ffi.Uint8> data,
+  int len,
+  double wet,
+  double dry,
+);
+
+@ffi.Native<ffi.Int32 Function(ffi.Float, ffi.Float)>()
+external int audiopc_set_convolution_mix(double wet, double dry);
+
+@ffi.Native<ffi.Int32 Function()>()
+external int audiopc_clear_convolution();
+
+/// Decode the file at `path` once and cache it under `key`.
+@ffi.Native<ffi.Int32 Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>)>()
+external int audiopc_preload_sample_path(
+  ffi.Pointer<ffi.Char> key,
+  ffi.Pointer<ffi.Char> path,
+);
+
+/// Decode `len` encoded bytes once and cache them under `key`.
+@ffi.Native<
+  ffi.Int32 Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Uint8>, ffi.Int32)
+>()
+external int audiopc_preload_sample_memory(
+  ffi.Pointer<ffi.Char> key,
+  ffi.Pointer<ffi.Uint8> data,
+  int len,
+);
+
+/// Play the sound cached under `key` on top of the current source.
+@ffi.Native<ffi.Int32 Function(ffi.Pointer<ffi.Char>, ffi.Float)>()
+external int audiopc_play_sample(ffi.Pointer<ffi.Char> key, double gain);
+
+/// Remove the sound cached under `key`.  Returns `-1` if there was none.
+@ffi.Native<ffi.Int32 Function(ffi.Pointer<ffi.Char>)>()
+external int audiopc_unload_sample(ffi.Pointer<ffi.Char> key);
+
+@ffi.Native<ffi.Int32 Function()>()
+external int audiopc_clear_sample_bank();
+
+/// Set the sample bank's memory budget in bytes, evicting least recently
+/// used sounds if it is exceeded.
+@ffi.Native<ffi.Int32 Function(ffi.Int64)>()
+external int audiopc_set_sample_bank_budget(int bytes);
+
+/// Bytes currently held by cached sounds.
+@ffi.Native<ffi.Int64 Function()>()
+external int audiopc_sample_bank_bytes();
+
+/// Record the input device `device_name` (null for the system default) to a
+/// WAV file at `path`, replacing any running capture.  `format` is
+/// `CAPTURE_FORMAT_WAV_PCM16` or `CAPTURE_FORMAT_WAV_F32`; a non-zero
+/// `monitor` also plays the input through the effect chains.
+@ffi.Native<
+  ffi.Int32 Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>, ffi.Int32, ffi.Int32)
+>()
+external int audiopc_start_capture(
+  ffi.Pointer<ffi.Char> path,
+  ffi.Pointer<ffi.Char> device_name,
+  int format,
+  int monitor,
+);
+
+/// Stop the running capture and finalise its file.
+@ffi.Native<ffi.Int32 Function()>()
+external int audiopc_stop_capture();
+
+/// Start (non-zero) or stop (0) monitoring the running capture.  Fails when
+/// the input could not be opened at the output sample rate.
+@ffi.Native<ffi.Int32 Function(ffi.Int32)>()
+external int audiopc_set_capture_monitor(int enabled);
+
+/// Input frames the running capture dropped because the writer fell
+/// behind, or -1 when nothing is being captured.
+@ffi.Native<ffi.Int64 Function()>()
+external int audiopc_capture_dropped_frames();
+
+/// Write the running capture's state (frames, drops, backlogs) as JSON into
+/// `buffer`.  Returns -1 when nothing is being captured.
+@ffi.Native<ffi.Int32 Function(ffi.Pointer<ffi.Char>, ffi.Int32)>()
+external int audiopc_get_capture_stats(
+  ffi.Pointer<ffi.Char> buffer,
+  int max_len,
+);
+
+/// Analyse the file or URL at `path` (tempo, beat grid, onsets) and write
+/// the result as JSON into `buffer`.  Blocks while decoding unless the
+/// result is cached; the engine is not needed.
+@ffi.Native<
+  ffi.Int32 Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>, ffi.Int32)
+>()
+external int audiopc_analyze_track(
+  ffi.Pointer<ffi.Char> path,
+  ffi.Pointer<ffi.Char> buffer,
+  int max_len,
+);
+
+/// Analyse the paths in the JSON array `paths_json` in the background on up
+/// to `threads` threads (0 = one per core).  Returns the job id (> 0) that
+/// tags its `EVENT_ANALYSIS_*` events.
+@ffi.Native<ffi.Int32 Function(ffi.Pointer<ffi.Char>, ffi.Int32)>()
+external int audiopc_start_analysis(
+  ffi.Pointer<ffi.Char> paths_json,
+  int threads,
+);
+
+/// Cancel a batch analysis started by `audiopc_start_analysis`.
+@ffi.Native<ffi.Int32 Function(ffi.Int32)>()
+external int audiopc_cancel_analysis(int job);
+
+/// Forget every cached analysis result.
+@ffi.Native<ffi.Int32 Function()>()
+external int audiopc_clear_analysis_cache();
+
+/// Request (non-zero) or drop (0) elevated priority for the output callback
+/// and decode workers.  Linux only; applied by each thread on its next
+/// iteration, so it works before or after the engine is initialised.
+@ffi.Native<ffi.Int32 Function(ffi.Int32)>()
+external int audiopc_set_realtime_priority(int enabled);
+
+/// Priority most recently obtained by the threads of `role`
+/// (`THREAD_ROLE_*`), as a `THREAD_PRIORITY_*` code.
+@ffi.Native<ffi.Int32 Function(ffi.Int32)>()
+external int audiopc_thread_priority(int role);
+
+/// Write a JSON snapshot of the engine's runtime metrics into `buffer`.
+@ffi.Native<ffi.Int32 Function(ffi.Pointer<ffi.Char>, ffi.Int32)>()
+external int audiopc_get_metrics(ffi.Pointer<ffi.Char> buffer, int max_len);
+
+/// Export the recent callback history as a Chrome trace-event JSON file.
+@ffi.Native<ffi.Int32 Function(ffi.Pointer<ffi.Char>)>()
+external int audiopc_write_metrics_trace(ffi.Pointer<ffi.Char> path);
+
+@ffi.Native<ffi.Int32 Function()>()
+external int audiopc_reset_metrics();
+
+@ffi.Native<ffi.Int32 Function()>()
+external int audiopc_underrun_count();
+
 const int DEFAULT_MAX_QUEUE_SECONDS = 20;
 
 const int MIN_MAX_QUEUE_SECONDS = 1;
 
 const int MAX_MAX_QUEUE_SECONDS = 120;
 
+const int QUEUE_STORAGE_F32 = 0;
+
+const int QUEUE_STORAGE_I16 = 1;
+
+const int QUEUE_STORAGE_F16 = 2;
+
 const int DECODE_BACKPRESSURE_SLEEP_MS = 2;
 
+const int DECODE_POOL_MAX_THREADS = 4;
+
+const int DECODE_POOL_SLICE_MS = 4;
+
 const int DEFAULT_VISUALIZER_SECONDS = 2;
 
 const int VISUALIZER_FFT_SIZE = 2048;
@@ -166,3 +411,177 @@ const double MIN_RATE = 0.5;
 const double MAX_RATE = 2.0;
 
 const int DEVICE_POLL_INTERVAL_MS = 2000;
+
+const int METRICS_HISTOGRAM_BUCKETS = 256;
+
+const int METRICS_TRACE_CAPACITY = 4096;
+
+const int FILTER_GLIDE_MILLIS = 30;
+
+const int CHAIN_CROSSFADE_MILLIS = 30;
+
+const int CHAIN_RETIRE_SLOTS = 4;
+
+const int OUTPUT_SCRATCH_SAMPLES = 16384;
+
+const int SOURCE_LOAD_IDLE = 0;
+
+const int SOURCE_LOAD_LOADING = 1;
+
+const int SOURCE_LOAD_READY = 2;
+
+const int SOURCE_LOAD_FAILED = 3;
+
+const int DEFAULT_SAMPLE_BANK_BUDGET_BYTES = 67108864;
+
+const int MAX_SAMPLE_VOICES = 32;
+
+const int CONVOLVER_BLOCK_FRAMES = 512;
+
+const int CONVOLVER_MAX_IR_SECONDS = 10;
+
+const int LIVE_JITTER_BUFFER_BYTES = 4194304;
+
+const int LIVE_PREBUFFER_BYTES = 65536;
+
+const int LIVE_READ_CHUNK_BYTES = 16384;
+
+const int LIVE_HTTP_TIMEOUT_MS = 10000;
+
+const int LIVE_RECONNECT_BASE_MS = 500;
+
+const int LIVE_RECONNECT_MAX_MS = 10000;
+
+const int LIVE_MAX_RECONNECT_ATTEMPTS = 8;
+
+const int LIVE_HLS_PREFETCH_SEGMENTS = 3;
+
+const int LIVE_HLS_LIVE_EDGE_SEGMENTS = 3;
+
+const int HTTP_READ_RETRIES = 3;
+
+const int HTTP_RETRY_BASE_MS = 250;
+
+const int EVENT_QUEUE_CAPACITY = 256;
+
+const int EVENT_QUEUE_RESERVED = 64;
+
+const int EVENT_WAIT_SLICE_MS = 10;
+
+const int EVENT_POSITION_INTERVAL_MS = 100;
+
+const int EVENT_JSON_MAX_BYTES = 8192;
+
+const int EVENT_PLAYBACK_STARTED = 1;
+
+const int EVENT_PLAYBACK_PAUSED = 2;
+
+const int EVENT_PLAYBACK_RESUMED = 3;
+
+const int EVENT_PLAYBACK_FINISHED = 4;
+
+const int EVENT_PLAYBACK_STOPPED = 5;
+
+const int EVENT_TRACK_CHANGED = 6;
+
+const int EVENT_SOURCE_LOADED = 7;
+
+const int EVENT_QUEUE_EXHAUSTED = 8;
+
+const int EVENT_QUEUE_UPDATED = 9;
+
+const int EVENT_ERROR = 10;
+
+const int EVENT_UNDERRUN = 11;
+
+const int EVENT_DECODER_WARNING = 12;
+
+const int EVENT_BUFFERING = 13;
+
+const int EVENT_BUFFERING_COMPLETE = 14;
+
+const int EVENT_RECONNECTING = 15;
+
+const int EVENT_STREAM_METADATA = 16;
+
+const int EVENT_DEVICE_ADDED = 17;
+
+const int EVENT_DEVICE_REMOVED = 18;
+
+const int EVENT_DEFAULT_DEVICE_CHANGED = 19;
+
+const int EVENT_POSITION = 20;
+
+const int EVENT_ANALYSIS_PROGRESS = 21;
+
+const int EVENT_ANALYSIS_RESULT = 22;
+
+const int EVENT_ANALYSIS_FINISHED = 23;
+
+const int EVENT_SCHEDULE_FIRED = 24;
+
+const int CAPTURE_FORMAT_WAV_PCM16 = 0;
+
+const int CAPTURE_FORMAT_WAV_F32 = 1;
+
+const int CAPTURE_RING_SECONDS = 4;
+
+const int CAPTURE_WRITE_BATCH_FRAMES = 8192;
+
+const int CAPTURE_WRITER_IDLE_MS = 20;
+
+const int CAPTURE_MONITOR_MAX_LATENCY_MS = 20;
+
+const int ANALYSIS_SAMPLE_RATE = 22050;
+
+const int ANALYSIS_FFT_SIZE = 1024;
+
+const int ANALYSIS_HOP_SIZE = 512;
+
+const double ANALYSIS_LOG_COMPRESSION = 100.0;
+
+const double ANALYSIS_MIN_BPM = 60.0;
+
+const double ANALYSIS_MAX_BPM = 200.0;
+
+const double ANALYSIS_PREFERRED_BPM = 120.0;
+
+const double ANALYSIS_ONSET_THRESHOLD = 1.0;
+
+const int ANALYSIS_ONSET_PEAK_FRAMES = 3;
+
+const int ANALYSIS_ONSET_MEAN_FRAMES = 16;
+
+const int ANALYSIS_PROGRESS_SECONDS = 30;
+
+const int ANALYSIS_CACHE_ENTRIES = 512;
+
+const int ANALYSIS_JSON_MAX_BYTES = 1048576;
+
+const int THREAD_ROLE_CALLBACK = 0;
+
+const int THREAD_ROLE_DECODE = 1;
+
+const int THREAD_PRIORITY_NORMAL = 0;
+
+const int THREAD_PRIORITY_ELEVATED = 1;
+
+const int THREAD_PRIORITY_REALTIME = 2;
+
+const int THREAD_PRIORITY_DENIED = -1;
+
+const int THREAD_RT_PRIORITY_CALLBACK = 10;
+
+const int THREAD_NICE_CALLBACK = -11;
+
+const int THREAD_NICE_DECODE = -6;
+
+const int SCHEDULE_PLAY = 0;
+
+const int SCHEDULE_PAUSE = 1;
+
+const int SCHEDULE_SEEK = 2;
+
+const int SCHEDULE_VOLUME = 3;
+
+const int MAX_SCHEDULED_COMMANDS = 64;
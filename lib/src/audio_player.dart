@@ -1,6 +1,8 @@
-import 'dart:async' show Timer;
+import 'dart:async';
 import 'dart:convert';
 import 'dart:ffi' as ffi;
+import 'dart:io' show sleep;
+import 'dart:isolate';
 import 'dart:typed_data';
 
 import 'package:audiopc_interface/audiopc_interface.dart';
@@ -12,8 +14,7 @@ import '../audiopc.g.dart' as bindings;
 class AudioPlayer with PlayerStateMixin implements AudiopcInterface {
   static bool _ok(int code) => code == 0;
 
-  late final Timer _positionTimer;
-  late final Timer _stateTimer;
+  late final StreamSubscription<Map<String, dynamic>> _eventSubscription;
 
   /// Reads backend capabilities from the Rust/CPAL layer.
   @override
@@ -25,24 +26,33 @@ class AudioPlayer with PlayerStateMixin implements AudiopcInterface {
     );
   }
 
-  /// Creates a player and starts a periodic position publisher.
+  /// Creates a player that follows position and state through the native
+  /// event bus.
   AudioPlayer() {
-    _positionTimer = Timer.periodic(const Duration(milliseconds: 100), (_) {
-      if (state == PlayerState.playing) {
-        positionController.add(positionMillis);
-      }
-    });
+    _EventPump.attach();
+    _eventSubscription = _EventPump.stream.listen(_onEvent);
+  }
 
-    _stateTimer = Timer.periodic(const Duration(seconds: 1), (_) {
-      // Polling for state changes is not ideal, but the Rust backend does not currently support callbacks.
-      // In a future iteration, we could add a callback mechanism to notify Dart of state changes immediately.
-      final stateCode = bindings.audiopc_get_player_state();
-      if (stateCode >= 0 && stateCode < PlayerState.values.length) {
-        setState(PlayerState.values[stateCode]);
-      }
-    });
+  /// Every native engine event as decoded JSON: an `EVENT_*` code under
+  /// `kind` plus the event's fields (see `audiopc_wait_event`).
+  Stream<Map<String, dynamic>> get events => _EventPump.stream;
+
+  void _onEvent(Map<String, dynamic> event) {
+    switch (event['kind']) {
+      case bindings.EVENT_POSITION:
+        positionController.add(event['current_ms'] as int);
+      case bindings.EVENT_PLAYBACK_STARTED || bindings.EVENT_PLAYBACK_RESUMED:
+        setState(PlayerState.playing);
+      case bindings.EVENT_PLAYBACK_PAUSED:
+        setState(PlayerState.paused);
+      case bindings.EVENT_PLAYBACK_STOPPED || bindings.EVENT_PLAYBACK_FINISHED:
+        setState(PlayerState.stopped);
+    }
   }
 
+  /// Events the native bus discarded because they were not drained in time.
+  int get droppedEventCount => bindings.audiopc_dropped_event_count();
+
   /// Sets a local file path as the active source.
   @override
   bool setFileSource(String path) {
@@ -67,6 +77,19 @@ class AudioPlayer with PlayerStateMixin implements AudiopcInterface {
     }
   }
 
+  /// Sets a live Icecast/SHOUTcast or HLS (`.m3u8`) stream as the active
+  /// source. Live streams are buffered, reconnect automatically after a
+  /// dropped connection, and cannot seek.
+  bool setLiveSource(String url) {
+    final ptr = url.toNativeUtf8().cast<ffi.Char>();
+    try {
+      setState(PlayerState.idle);
+      return _ok(bindings.audiopc_set_source_live(ptr));
+    } finally {
+      calloc.free(ptr);
+    }
+  }
+
   /// Sets an in-memory byte buffer as the active source.
   @override
   bool setMemorySource(List<int> data) {
@@ -143,6 +166,20 @@ class AudioPlayer with PlayerStateMixin implements AudiopcInterface {
   @override
   bool setVolume(double value) => _ok(bindings.audiopc_set_volume(value));
 
+  /// Enables TPDF dither when the output device uses an integer sample
+  /// format. On by default; has no effect on float devices.
+  bool setOutputDither(bool enabled) =>
+      _ok(bindings.audiopc_set_output_dither(enabled ? 1 : 0));
+
+  /// Chooses how decoded audio is buffered, one of the `QUEUE_STORAGE_*`
+  /// constants. The 16-bit modes halve the memory of long queues (see
+  /// `audiopc_set_max_queue_seconds`) at a small precision cost.
+  bool setQueueStorage(int mode) =>
+      _ok(bindings.audiopc_set_queue_storage(mode));
+
+  /// Bytes allocated for the decoded audio queue.
+  int get queueBytes => bindings.audiopc_queue_bytes();
+
   /// Sets low-pass cutoff in Hz. Use 0 to disable filtering.
   @override
   bool setLowPassHz(double hz) => _ok(bindings.audiopc_set_lowpass_hz(hz, 10));
@@ -159,6 +196,40 @@ class AudioPlayer with PlayerStateMixin implements AudiopcInterface {
   @override
   int get durationMillis => bindings.audiopc_duration_millis();
 
+  /// Progress of loading the current source, one of the `SOURCE_LOAD_*`
+  /// constants. Sources load in the background, so [durationMillis] stays
+  /// negative until this reports `SOURCE_LOAD_READY`.
+  int get sourceLoadState => bindings.audiopc_source_load_state();
+
+  /// Current host time in nanoseconds: the time base of [scheduleAtTime]
+  /// and the clock queries, shared by every player in the process.
+  int get clockNowNs => bindings.audiopc_clock_now_ns();
+
+  /// Output frame (engine sample time) heard at host time [hostNs], or -1
+  /// until the output has started.
+  int clockFrameAt(int hostNs) => bindings.audiopc_clock_frame_at(hostNs);
+
+  /// Host time in nanoseconds at which output [frame] is heard, or -1 until
+  /// the output has started.
+  int clockTimeAt(int frame) => bindings.audiopc_clock_time_at(frame);
+
+  /// Runs [command] (`SCHEDULE_*`) exactly when output [frame] is heard.
+  /// [value] is the target in milliseconds for a seek and the gain for a
+  /// volume change. Returns the id its `EVENT_SCHEDULE_FIRED` event
+  /// carries, or a negative error code.
+  int scheduleAtFrame(int command, int frame, {double value = 0}) =>
+      bindings.audiopc_schedule(command, value, frame);
+
+  /// Like [scheduleAtFrame], due at host time [hostNs] (see [clockNowNs]).
+  int scheduleAtTime(int command, int hostNs, {double value = 0}) =>
+      bindings.audiopc_schedule_at_time(command, value, hostNs);
+
+  /// Cancels the scheduled command [id].
+  bool cancelScheduled(int id) => _ok(bindings.audiopc_cancel_scheduled(id));
+
+  /// Cancels every scheduled command.
+  bool clearSchedule() => _ok(bindings.audiopc_clear_schedule());
+
   /// Number of visualizer samples ready to be copied.
   @override
   int get visualizerAvailableSamples =>
@@ -172,53 +243,64 @@ class AudioPlayer with PlayerStateMixin implements AudiopcInterface {
   @override
   int get visualizerChannels => bindings.audiopc_visualizer_channels();
 
-  /// Copies normalized time-domain visualizer samples.
+  /// Copies normalized time-domain visualizer samples into a new list the
+  /// caller owns.
+  ///
+  /// A render loop polling every frame should reuse one list with
+  /// [copyVisualizerSamplesInto] instead.
   @override
   List<double> getVisualizerSamples(int maxSamples) {
     if (maxSamples <= 0) {
       return const [];
     }
+    final samples = Float32List(maxSamples);
+    final copied = copyVisualizerSamplesInto(samples);
+    return copied > 0 ? Float32List.sublistView(samples, 0, copied) : const [];
+  }
 
-    final ptr = calloc<ffi.Float>(maxSamples);
-    try {
-      final copied = bindings.audiopc_copy_visualizer_samples(ptr, maxSamples);
-      if (copied <= 0) {
-        return const [];
-      }
-      final raw = ptr.asTypedList(copied);
-      return List<double>.generate(
-        copied,
-        (index) => raw[index].toDouble(),
-        growable: false,
-      );
-    } finally {
-      calloc.free(ptr);
+  /// Copies up to `target.length` normalized time-domain visualizer samples
+  /// into [target] and returns how many were written.
+  ///
+  /// The native side writes straight into [target], so nothing is allocated
+  /// and nothing keeps referring to it after the call.
+  int copyVisualizerSamplesInto(Float32List target) {
+    if (target.isEmpty) {
+      return 0;
     }
+    final copied = bindings.audiopc_copy_visualizer_samples(
+      target.address,
+      target.length,
+    );
+    return copied > 0 ? copied : 0;
   }
 
-  /// Copies normalized frequency-domain bars for a spectrum view.
+  /// Copies normalized frequency-domain bars for a spectrum view into a new
+  /// list the caller owns.
+  ///
+  /// A render loop polling every frame should reuse one list with
+  /// [copyVisualizerSpectrumInto] instead.
   @override
   List<double> getVisualizerSpectrum(int maxBars) {
     if (maxBars <= 0) {
       return const [];
     }
+    final bars = Float32List(maxBars);
+    final copied = copyVisualizerSpectrumInto(bars);
+    return copied > 0 ? Float32List.sublistView(bars, 0, copied) : const [];
+  }
 
-    final ptr = calloc<ffi.Float>(maxBars);
-    try {
-      final copied = bindings.audiopc_copy_visualizer_spectrum(ptr, maxBars);
-      if (copied <= 0) {
-        return const [];
-      }
-
-      final raw = ptr.asTypedList(copied);
-      return List<double>.generate(
-        copied,
-        (index) => raw[index].toDouble(),
-        growable: false,
-      );
-    } finally {
-      calloc.free(ptr);
+  /// Copies up to `target.length` spectrum bars into [target] and returns
+  /// how many were written. Like [copyVisualizerSamplesInto], it allocates
+  /// nothing.
+  int copyVisualizerSpectrumInto(Float32List target) {
+    if (target.isEmpty) {
+      return 0;
     }
+    final copied = bindings.audiopc_copy_visualizer_spectrum(
+      target.address,
+      target.length,
+    );
+    return copied > 0 ? copied : 0;
   }
 
   /// Retrieves the current metadata snapshot from the native backend.
@@ -278,12 +360,287 @@ class AudioPlayer with PlayerStateMixin implements AudiopcInterface {
     }
   }
 
-  /// Stops playback and releases timers and stream controllers.
+  /// Number of buffer underruns since the current source was loaded.
+  int get underrunCount => bindings.audiopc_underrun_count();
+
+  /// Returns a snapshot of native runtime metrics: callback duration and
+  /// load, queue fill, decode time per packet, lock waits, and startup/seek
+  /// latencies. Histogram entries carry `count`, `mean`, `p50`, `p90`,
+  /// `p99`, `p999` and `max`.
+  Map<String, dynamic> getMetrics() {
+    const maxLen = 16384;
+    final ptr = calloc<ffi.Char>(maxLen);
+    try {
+      final result = bindings.audiopc_get_metrics(ptr, maxLen);
+      if (result < 0) {
+        throw Exception('Failed to retrieve metrics (error code: $result)');
+      }
+      final jsonString = ptr.cast<Utf8>().toDartString();
+      return jsonDecode(jsonString) as Map<String, dynamic>;
+    } finally {
+      calloc.free(ptr);
+    }
+  }
+
+  /// Writes the recent audio-callback history to `path` as a Chrome
+  /// trace-event file (open it in `chrome://tracing` or Perfetto).
+  bool writeMetricsTrace(String path) {
+    final ptr = path.toNativeUtf8().cast<ffi.Char>();
+    try {
+      return _ok(bindings.audiopc_write_metrics_trace(ptr));
+    } finally {
+      calloc.free(ptr);
+    }
+  }
+
+  /// Clears all native runtime metrics.
+  bool resetMetrics() => _ok(bindings.audiopc_reset_metrics());
+
+  /// Convolves the output with the impulse response in the file at [path]
+  /// (room correction or reverb). The IR is decoded and transformed on a
+  /// background isolate; [wet] and [dry] set the mix.
+  Future<bool> setConvolutionIr(
+    String path, {
+    double wet = 1.0,
+    double dry = 0.0,
+  }) {
+    return Isolate.run(() {
+      final ptr = path.toNativeUtf8().cast<ffi.Char>();
+      try {
+        return _ok(bindings.audiopc_set_convolution_ir_path(ptr, wet, dry));
+      } finally {
+        calloc.free(ptr);
+      }
+    });
+  }
+
+  /// Like [setConvolutionIr] for an impulse response held in memory.
+  Future<bool> setConvolutionIrMemory(
+    Uint8List data, {
+    double wet = 1.0,
+    double dry = 0.0,
+  }) {
+    return Isolate.run(() {
+      final ptr = malloc.allocate<ffi.Uint8>(data.length);
+      try {
+        ptr.asTypedList(data.length).setAll(0, data);
+        return _ok(
+          bindings.audiopc_set_convolution_ir_memory(ptr, data.length, wet, dry),
+        );
+      } finally {
+        malloc.free(ptr);
+      }
+    });
+  }
+
+  /// Changes the wet/dry mix of the loaded impulse response.
+  bool setConvolutionMix(double wet, double dry) =>
+      _ok(bindings.audiopc_set_convolution_mix(wet, dry));
+
+  /// Removes the impulse response.
+  bool clearConvolution() => _ok(bindings.audiopc_clear_convolution());
+
+  /// Decodes the file at [path] once and caches it as [key] for
+  /// low-latency replay with [playSample]. Decoding runs on a background
+  /// isolate; the sound can be played once the future completes.
+  Future<bool> preloadSample(String key, String path) {
+    return Isolate.run(() {
+      final keyPtr = key.toNativeUtf8().cast<ffi.Char>();
+      final pathPtr = path.toNativeUtf8().cast<ffi.Char>();
+      try {
+        return _ok(bindings.audiopc_preload_sample_path(keyPtr, pathPtr));
+      } finally {
+        calloc.free(keyPtr);
+        calloc.free(pathPtr);
+      }
+    });
+  }
+
+  /// Like [preloadSample] for encoded audio [data] held in memory.
+  Future<bool> preloadSampleMemory(String key, Uint8List data) {
+    return Isolate.run(() {
+      final keyPtr = key.toNativeUtf8().cast<ffi.Char>();
+      final dataPtr = malloc.allocate<ffi.Uint8>(data.length);
+      try {
+        dataPtr.asTypedList(data.length).setAll(0, data);
+        return _ok(
+          bindings.audiopc_preload_sample_memory(keyPtr, dataPtr, data.length),
+        );
+      } finally {
+        calloc.free(keyPtr);
+        malloc.free(dataPtr);
+      }
+    });
+  }
+
+  /// Plays the sound cached as [key] on top of the current source.
+  bool playSample(String key, {double gain = 1.0}) {
+    final ptr = key.toNativeUtf8().cast<ffi.Char>();
+    try {
+      return _ok(bindings.audiopc_play_sample(ptr, gain));
+    } finally {
+      calloc.free(ptr);
+    }
+  }
+
+  /// Removes the sound cached as [key].
+  bool unloadSample(String key) {
+    final ptr = key.toNativeUtf8().cast<ffi.Char>();
+    try {
+      return _ok(bindings.audiopc_unload_sample(ptr));
+    } finally {
+      calloc.free(ptr);
+    }
+  }
+
+  /// Removes every cached sound. Sounds already playing finish normally.
+  bool clearSampleBank() => _ok(bindings.audiopc_clear_sample_bank());
+
+  /// Sets the memory budget for cached sounds in bytes. Least recently
+  /// played sounds are evicted when it is exceeded.
+  bool setSampleBankBudget(int bytes) =>
+      _ok(bindings.audiopc_set_sample_bank_budget(bytes));
+
+  /// Bytes currently held by cached sounds.
+  int get sampleBankBytes => bindings.audiopc_sample_bank_bytes();
+
+  /// Records the input device [deviceName] (the system default when null)
+  /// to a WAV file at [path], replacing any running capture. [format] is
+  /// `CAPTURE_FORMAT_WAV_PCM16` or `CAPTURE_FORMAT_WAV_F32`. With [monitor],
+  /// the input is also played through the output and its filters.
+  bool startCapture(
+    String path, {
+    String? deviceName,
+    int format = bindings.CAPTURE_FORMAT_WAV_PCM16,
+    bool monitor = false,
+  }) {
+    final pathPtr = path.toNativeUtf8().cast<ffi.Char>();
+    final devicePtr = deviceName == null
+        ? ffi.nullptr
+        : deviceName.toNativeUtf8().cast<ffi.Char>();
+    try {
+      return _ok(
+        bindings.audiopc_start_capture(
+          pathPtr,
+          devicePtr,
+          format,
+          monitor ? 1 : 0,
+        ),
+      );
+    } finally {
+      calloc.free(pathPtr);
+      if (devicePtr != ffi.nullptr) calloc.free(devicePtr);
+    }
+  }
+
+  /// Stops the running capture and finalises its file.
+  bool stopCapture() => _ok(bindings.audiopc_stop_capture());
+
+  /// Starts or stops playing the running capture through the output.
+  /// Fails when the input could not run at the output sample rate.
+  bool setCaptureMonitor(bool enabled) =>
+      _ok(bindings.audiopc_set_capture_monitor(enabled ? 1 : 0));
+
+  /// Input frames the running capture dropped, or -1 when idle.
+  int get captureDroppedFrames => bindings.audiopc_capture_dropped_frames();
+
+  /// State of the running capture (`captured_frames`, `dropped_frames`,
+  /// `record_backlog_ms`, `monitor_backlog_ms`, ...), or null when idle.
+  Map<String, dynamic>? getCaptureStats() {
+    const maxLen = 4096;
+    final ptr = calloc<ffi.Char>(maxLen);
+    try {
+      final result = bindings.audiopc_get_capture_stats(ptr, maxLen);
+      if (result < 0) return null;
+      return jsonDecode(ptr.cast<Utf8>().toDartString())
+          as Map<String, dynamic>;
+    } finally {
+      calloc.free(ptr);
+    }
+  }
+
+  /// Analyses the track at [path] on a background isolate: `bpm`,
+  /// `confidence`, `duration_ms`, `beats_ms` and `onsets_ms`. Results are
+  /// cached natively, so repeated calls for an unchanged file are cheap.
+  /// Null when the track cannot be decoded.
+  Future<Map<String, dynamic>?> analyzeTrack(String path) {
+    return Isolate.run(() {
+      final pathPtr = path.toNativeUtf8().cast<ffi.Char>();
+      final ptr = calloc<ffi.Char>(bindings.ANALYSIS_JSON_MAX_BYTES);
+      try {
+        final result = bindings.audiopc_analyze_track(
+          pathPtr,
+          ptr,
+          bindings.ANALYSIS_JSON_MAX_BYTES,
+        );
+        if (result < 0) return null;
+        return jsonDecode(ptr.cast<Utf8>().toDartString())
+            as Map<String, dynamic>;
+      } finally {
+        calloc.free(pathPtr);
+        calloc.free(ptr);
+      }
+    });
+  }
+
+  /// Analyses [paths] in the background on up to [threads] threads (0 = one
+  /// per core). Returns the job id to pass to [analysisEvents] and
+  /// [cancelAnalysis], or a negative error code.
+  int startAnalysis(List<String> paths, {int threads = 0}) {
+    final ptr = jsonEncode(paths).toNativeUtf8().cast<ffi.Char>();
+    try {
+      return bindings.audiopc_start_analysis(ptr, threads);
+    } finally {
+      calloc.free(ptr);
+    }
+  }
+
+  /// Progress and per-track results (`EVENT_ANALYSIS_*`) of the batch
+  /// [job], closing once every track is done. Subscribe before the batch
+  /// can finish; events are not replayed.
+  ///
+  /// The native result event only carries a summary; its full `analysis`
+  /// (with `beats_ms` and `onsets_ms`) is read from the native cache before
+  /// the event is delivered.
+  Stream<Map<String, dynamic>> analysisEvents(int job) => events
+      .where((event) => event['job'] == job)
+      .takeWhile((event) => event['kind'] != bindings.EVENT_ANALYSIS_FINISHED)
+      .asyncMap(_withFullAnalysis);
+
+  Future<Map<String, dynamic>> _withFullAnalysis(
+    Map<String, dynamic> event,
+  ) async {
+    if (event['kind'] != bindings.EVENT_ANALYSIS_RESULT ||
+        event['analysis'] == null) {
+      return event;
+    }
+    final analysis = await analyzeTrack(event['path'] as String);
+    return {...event, 'analysis': analysis ?? event['analysis']};
+  }
+
+  /// Cancels the batch analysis [job].
+  bool cancelAnalysis(int job) => _ok(bindings.audiopc_cancel_analysis(job));
+
+  /// Forgets every cached analysis result.
+  bool clearAnalysisCache() => _ok(bindings.audiopc_clear_analysis_cache());
+
+  /// Requests real-time priority for the output callback and raised
+  /// priority for the decode workers (Linux only; process-wide). Check
+  /// [threadPriority] to see what the system granted.
+  bool setRealtimePriority(bool enabled) =>
+      _ok(bindings.audiopc_set_realtime_priority(enabled ? 1 : 0));
+
+  /// Priority most recently obtained by the threads of [role]
+  /// (`THREAD_ROLE_*`), as a `THREAD_PRIORITY_*` code.
+  int threadPriority(int role) => bindings.audiopc_thread_priority(role);
+
+  /// Stops playback and releases the event subscription and stream
+  /// controllers.
   @override
   void dispose() {
     stop();
-    _positionTimer.cancel();
-    _stateTimer.cancel();
+    _eventSubscription.cancel();
+    _EventPump.detach();
     positionController.close();
     playerStateController.close();
   }
@@ -412,3 +769,70 @@ class AudioPlayer with PlayerStateMixin implements AudiopcInterface {
     return true;
   }
 }
+
+/// Pumps the native event bus into a broadcast stream.
+///
+/// The bus hands each event to a single waiter, so every player shares one
+/// background isolate blocked in `audiopc_wait_event`. The isolate runs
+/// while at least one player is attached.
+class _EventPump {
+  static const _waitMillis = 250;
+
+  static final _controller = StreamController<Map<String, dynamic>>.broadcast();
+  static ReceivePort? _port;
+  static ffi.Pointer<ffi.Bool>? _stop;
+  static int _players = 0;
+
+  static Stream<Map<String, dynamic>> get stream => _controller.stream;
+
+  /// Registers a player, starting the isolate for the first one.
+  static void attach() {
+    if (_players++ == 0) {
+      final port = ReceivePort()
+        ..listen((json) => _controller.add(jsonDecode(json as String)));
+      final stop = calloc<ffi.Bool>();
+      _port = port;
+      _stop = stop;
+      Isolate.spawn(
+        _run,
+        (port.sendPort, stop.address),
+        debugName: 'audiopc events',
+      );
+    }
+  }
+
+  /// Releases a player; the isolate exits after its current wait when the
+  /// last one detaches.
+  static void detach() {
+    if (_players == 0 || --_players > 0) return;
+    // The isolate frees the flag once it sees it.
+    _stop?.value = true;
+    _port?.close();
+    _stop = null;
+    _port = null;
+  }
+
+  static void _run((SendPort, int) args) {
+    final (port, stopAddress) = args;
+    final stop = ffi.Pointer<ffi.Bool>.fromAddress(stopAddress);
+    final buffer = calloc<ffi.Char>(bindings.EVENT_JSON_MAX_BYTES);
+    try {
+      while (!stop.value) {
+        final len = bindings.audiopc_wait_event(
+          buffer,
+          bindings.EVENT_JSON_MAX_BYTES,
+          _waitMillis,
+        );
+        if (len > 0) {
+          port.send(buffer.cast<Utf8>().toDartString(length: len));
+        } else if (len < -2) {
+          // Engine unavailable; back off instead of spinning.
+          sleep(const Duration(milliseconds: _waitMillis));
+        }
+      }
+    } finally {
+      calloc.free(buffer);
+      calloc.free(stop);
+    }
+  }
+}
@@ -0,0 +1,651 @@
+/// Offline tempo, beat grid and onset analysis of whole tracks.
+///
+/// ```text
+/// BlockDecoder (mono, 22.05 kHz) ──► spectral flux ──┬─► peak picking ──► onsets
+///                                                    └─► autocorrelation + comb ──► tempo
+///                                                                       └─► grid fit ──► beats
+/// ```
+///
+/// The onset function is the half-wave rectified spectral flux of
+/// log-compressed STFT magnitudes, one value per [`ANALYSIS_HOP_SIZE`].  The
+/// tempo is the autocorrelation lag whose comb of multiples scores best,
+/// weighted towards [`ANALYSIS_PREFERRED_BPM`] to settle octave ambiguity.
+/// The beat grid is a constant-tempo grid whose period and phase are then
+/// fitted to the onset function over the whole track, which refines the
+/// tempo well below one analysis frame.
+///
+/// All analyzers share one FFT plan.  Batches run on their own threads (not
+/// the playback decode pool) and report progress, per-track results and
+/// completion as [`AudioEvent`]s.  Results are cached by path and
+/// invalidated when the file's size or modification time changes.
+
+use std::collections::{HashMap, VecDeque};
+use std::fs;
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex};
+use std::thread;
+use std::time::SystemTime;
+
+use once_cell::sync::Lazy;
+use rustfft::{num_complex::Complex, num_traits::Zero, Fft, FftPlanner};
+use serde_json::json;
+
+use crate::engine::BlockDecoder;
+use crate::enums::{
+    ANALYSIS_CACHE_ENTRIES, ANALYSIS_FFT_SIZE, ANALYSIS_HOP_SIZE, ANALYSIS_LOG_COMPRESSION,
+    ANALYSIS_MAX_BPM, ANALYSIS_MIN_BPM, ANALYSIS_ONSET_MEAN_FRAMES, ANALYSIS_ONSET_PEAK_FRAMES,
+    ANALYSIS_ONSET_THRESHOLD, ANALYSIS_PREFERRED_BPM, ANALYSIS_PROGRESS_SECONDS,
+    ANALYSIS_SAMPLE_RATE,
+};
+use crate::events::{AudioEvent, EventSender};
+use crate::source::AudioSource;
+use crate::{error, info};
+
+/// Onset-function frames per second.
+const FRAME_RATE: f32 = ANALYSIS_SAMPLE_RATE as f32 / ANALYSIS_HOP_SIZE as f32;
+
+// ── Result ────────────────────────────────────────────────────────────────────
+
+/// Tempo, beat grid and onsets of one track.  Times are in milliseconds from
+/// the start of the track.
+#[derive(Debug, Clone, Default)]
+pub struct TrackAnalysis {
+    /// Estimated tempo; 0 when no periodicity was found.
+    pub bpm:         f32,
+    /// Normalised autocorrelation at the chosen tempo, 0–1.
+    pub confidence:  f32,
+    pub duration_ms: u64,
+    pub beats_ms:    Vec<u64>,
+    pub onsets_ms:   Vec<u64>,
+}
+
+impl TrackAnalysis {
+    pub fn to_json(&self) -> serde_json::Value {
+        json!({
+            "bpm":         self.bpm,
+            "confidence":  self.confidence,
+            "duration_ms": self.duration_ms,
+            "beats_ms":    self.beats_ms,
+            "onsets_ms":   self.onsets_ms,
+        })
+    }
+
+    /// Tempo and counts without the beat and onset lists, which outgrow an
+    /// event buffer on ordinary tracks.  The full result is a cache hit for
+    /// `audiopc_analyze_track` once the batch has analysed the path.
+    pub fn summary_json(&self) -> serde_json::Value {
+        json!({
+            "bpm":         self.bpm,
+            "confidence":  self.confidence,
+            "duration_ms": self.duration_ms,
+            "beat_count":  self.beats_ms.len(),
+            "onset_count": self.onsets_ms.len(),
+        })
+    }
+}
+
+// ── Onset function ────────────────────────────────────────────────────────────
+
+/// Forward FFT plan shared by every analyzer; `rustfft` plans are immutable
+/// and each caller brings its own scratch.
+static FFT_PLAN: Lazy<Arc<dyn Fft<f32>>> =
+    Lazy::new(|| FftPlanner::new().plan_fft_forward(ANALYSIS_FFT_SIZE));
+
+static WINDOW: Lazy<Vec<f32>> = Lazy::new(|| {
+    (0..ANALYSIS_FFT_SIZE)
+        .map(|i| {
+            let x = i as f32 / ANALYSIS_FFT_SIZE as f32;
+            0.5 - 0.5 * (2.0 * std::f32::consts::PI * x).cos()
+        })
+        .collect()
+});
+
+/// Streaming spectral-flux onset function over mono samples.
+struct SpectralFlux {
+    fft:      Arc<dyn Fft<f32>>,
+    frame:    Vec<Complex<f32>>,
+    scratch:  Vec<Complex<f32>>,
+    /// Log magnitudes of the previous frame.
+    previous: Vec<f32>,
+    /// Samples not yet covered by a full frame.
+    pending:  Vec<f32>,
+    flux:     Vec<f32>,
+}
+
+impl SpectralFlux {
+    fn new() -> Self {
+        let fft = Arc::clone(&FFT_PLAN);
+        let scratch_len = fft.get_inplace_scratch_len();
+        Self {
+            fft,
+            frame:    vec![Complex::zero(); ANALYSIS_FFT_SIZE],
+            scratch:  vec![Complex::zero(); scratch_len],
+            previous: vec![0.0; ANALYSIS_FFT_SIZE / 2 + 1],
+            pending:  Vec::with_capacity(ANALYSIS_FFT_SIZE * 2),
+            flux:     Vec::new(),
+        }
+    }
+
+    fn push(&mut self, samples: &[f32]) {
+        self.pending.extend_from_slice(samples);
+        let mut start = 0;
+        while self.pending.len() - start >= ANALYSIS_FFT_SIZE {
+            self.analyse_frame(start);
+            start += ANALYSIS_HOP_SIZE;
+        }
+        self.pending.drain(..start);
+    }
+
+    fn analyse_frame(&mut self, start: usize) {
+        let input = &self.pending[start..start + ANALYSIS_FFT_SIZE];
+        for ((bin, &sample), &w) in self.frame.iter_mut().zip(input).zip(WINDOW.iter()) {
+            *bin = Complex::new(sample * w, 0.0);
+        }
+        self.fft.process_with_scratch(&mut self.frame, &mut self.scratch);
+
+        let mut flux = 0.0f32;
+        for (bin, previous) in self.frame.iter().zip(self.previous.iter_mut()) {
+            let magnitude = (1.0 + ANALYSIS_LOG_COMPRESSION * bin.norm()).ln();
+            flux += (magnitude - *previous).max(0.0);
+            *previous = magnitude;
+        }
+        self.flux.push(flux);
+    }
+}
+
+/// Time (ms) of the centre of onset-function frame `frame`.
+fn frame_millis(frame: f32) -> u64 {
+    let sample = frame * ANALYSIS_HOP_SIZE as f32 + ANALYSIS_FFT_SIZE as f32 / 2.0;
+    (sample as f64 * 1000.0 / ANALYSIS_SAMPLE_RATE as f64).round() as u64
+}
+
+fn mean_and_deviation(values: &[f32]) -> (f32, f32) {
+    if values.is_empty() {
+        return (0.0, 0.0);
+    }
+    let n = values.len() as f32;
+    let mean = values.iter().sum::<f32>() / n;
+    let variance = values.iter().map(|v| (v - mean) * (v - mean)).sum::<f32>() / n;
+    (mean, variance.sqrt())
+}
+
+// ── Onsets ────────────────────────────────────────────────────────────────────
+
+/// Frames that are local maxima and exceed the local mean by
+/// [`ANALYSIS_ONSET_THRESHOLD`] standard deviations.
+fn pick_onsets(flux: &[f32]) -> Vec<u64> {
+    let (_, deviation) = mean_and_deviation(flux);
+    if deviation <= f32::EPSILON {
+        return Vec::new();
+    }
+    let threshold = ANALYSIS_ONSET_THRESHOLD * deviation;
+
+    // Prefix sums give each local mean in O(1).
+    let mut prefix = Vec::with_capacity(flux.len() + 1);
+    prefix.push(0.0f64);
+    for &v in flux {
+        prefix.push(prefix[prefix.len() - 1] + v as f64);
+    }
+
+    let mut onsets = Vec::new();
+    for (i, &value) in flux.iter().enumerate() {
+        let peak_lo = i.saturating_sub(ANALYSIS_ONSET_PEAK_FRAMES);
+        let peak_hi = (i + ANALYSIS_ONSET_PEAK_FRAMES + 1).min(flux.len());
+        // Ties resolve to the first frame of a plateau.
+        let is_peak = flux[peak_lo..i].iter().all(|&v| v < value)
+            && flux[i + 1..peak_hi].iter().all(|&v| v <= value);
+        if !is_peak {
+            continue;
+        }
+        let mean_lo = i.saturating_sub(ANALYSIS_ONSET_MEAN_FRAMES);
+        let mean_hi = (i + ANALYSIS_ONSET_MEAN_FRAMES + 1).min(flux.len());
+        let local_mean = ((prefix[mean_hi] - prefix[mean_lo]) / (mean_hi - mean_lo) as f64) as f32;
+        if value >= local_mean + threshold {
+            onsets.push(frame_millis(i as f32));
+        }
+    }
+    onsets
+}
+
+// ── Tempo ─────────────────────────────────────────────────────────────────────
+
+/// Harmonics of a candidate lag summed by the comb score.
+const COMB_HARMONICS: usize = 4;
+
+/// Beat period in onset-function frames and its confidence, or `None` if
+/// the function is too short or flat.
+fn estimate_period(flux: &[f32]) -> Option<(f32, f32)> {
+    let min_lag = (FRAME_RATE * 60.0 / ANALYSIS_MAX_BPM).floor().max(1.0) as usize;
+    let max_lag = (FRAME_RATE * 60.0 / ANALYSIS_MIN_BPM).ceil() as usize;
+    if flux.len() < max_lag * 2 {
+        return None;
+    }
+    let (mean, deviation) = mean_and_deviation(flux);
+    if deviation <= f32::EPSILON {
+        return None;
+    }
+    let centred: Vec<f32> = flux.iter().map(|v| v - mean).collect();
+
+    let lags = (max_lag * COMB_HARMONICS).min(centred.len() - 1);
+    let energy: f32 = centred.iter().map(|v| v * v).sum();
+    let autocorrelation: Vec<f32> = (0..=lags)
+        .map(|lag| {
+            let sum: f32 = centred[..centred.len() - lag]
+                .iter()
+                .zip(&centred[lag..])
+                .map(|(a, b)| a * b)
+                .sum();
+            sum / energy
+        })
+        .collect();
+
+    let score = |lag: usize| -> f32 {
+        let mut comb = 0.0;
+        let mut weight = 0.0;
+        for harmonic in 1..=COMB_HARMONICS {
+            // The true period is rarely a whole number of frames, so the
+            // peak of harmonic `h` can sit up to `h / 2` lags away.
+            let centre = lag * harmonic;
+            let radius = harmonic.div_ceil(2);
+            let Some(window) = autocorrelation.get(centre - radius..=centre + radius) else { break };
+            let ac = window.iter().copied().fold(f32::MIN, f32::max);
+            comb += ac / harmonic as f32;
+            weight += 1.0 / harmonic as f32;
+        }
+        // Log-Gaussian prior, one octave wide, around the preferred tempo.
+        let octaves = (FRAME_RATE * 60.0 / lag as f32 / ANALYSIS_PREFERRED_BPM).log2();
+        comb / weight * (-0.5 * octaves * octaves).exp()
+    };
+
+    let scores: Vec<f32> = (min_lag..=max_lag).map(score).collect();
+    let (best, &best_score) = scores
+        .iter()
+        .enumerate()
+        .max_by(|a, b| a.1.total_cmp(b.1))?;
+    if best_score <= 0.0 {
+        return None;
+    }
+
+    // Parabolic interpolation between the neighbouring integer lags.
+    let mut period = (min_lag + best) as f32;
+    if best > 0 && best + 1 < scores.len() {
+        let (l, c, r) = (scores[best - 1], scores[best], scores[best + 1]);
+        let denominator = l - 2.0 * c + r;
+        if denominator.abs() > f32::EPSILON {
+            period += (0.5 * (l - r) / denominator).clamp(-0.5, 0.5);
+        }
+    }
+    let lag = min_lag + best;
+    let confidence = autocorrelation[lag - 1..=lag + 1]
+        .iter()
+        .copied()
+        .fold(0.0, f32::max)
+        .min(1.0);
+    Some((period, confidence))
+}
+
+/// Linearly interpolated onset function at fractional frame `t`.
+#[inline]
+fn sample_at(flux: &[f32], t: f32) -> f32 {
+    let i = t as usize;
+    let frac = t - i as f32;
+    match (flux.get(i), flux.get(i + 1)) {
+        (Some(&a), Some(&b)) => a + (b - a) * frac,
+        (Some(&a), None)     => a,
+        _ => 0.0,
+    }
+}
+
+/// Period search span (± frames) and step of the grid fit.
+const GRID_PERIOD_SPAN: f32 = 1.0;
+const GRID_PERIOD_STEP: f32 = 0.02;
+/// Phase step (frames) of the grid fit.
+const GRID_PHASE_STEP: f32 = 0.25;
+
+/// Fit a constant-tempo grid to the onset function around `period`.
+/// Returns `(period, phase)` in frames; the score is the mean onset
+/// strength on the grid, so shorter periods gain nothing from extra beats.
+fn fit_grid(flux: &[f32], period: f32) -> (f32, f32) {
+    let end = flux.len() as f32;
+    let mut best = (period, 0.0, f32::MIN);
+    let steps = (2.0 * GRID_PERIOD_SPAN / GRID_PERIOD_STEP).round() as i32;
+    for step in 0..=steps {
+        let candidate = period - GRID_PERIOD_SPAN + step as f32 * GRID_PERIOD_STEP;
+        if candidate < 1.0 {
+            continue;
+        }
+        let mut phase = 0.0;
+        while phase < candidate {
+            let (mut sum, mut count) = (0.0f32, 0u32);
+            let mut t = phase;
+            while t < end {
+                sum += sample_at(flux, t);
+                count += 1;
+                t += candidate;
+            }
+            let score = if count > 0 { sum / count as f32 } else { 0.0 };
+            if score > best.2 {
+                best = (candidate, phase, score);
+            }
+            phase += GRID_PHASE_STEP;
+        }
+    }
+    (best.0, best.1)
+}
+
+// ── Analysis ──────────────────────────────────────────────────────────────────
+
+/// Analyse an onset function covering `duration_ms` of audio.
+fn analyse_flux(flux: &[f32], duration_ms: u64) -> TrackAnalysis {
+    let onsets_ms = pick_onsets(flux);
+    let Some((coarse, confidence)) = estimate_period(flux) else {
+        return TrackAnalysis { duration_ms, onsets_ms, ..TrackAnalysis::default() };
+    };
+
+    let (period, phase) = fit_grid(flux, coarse);
+    let mut beats_ms = Vec::new();
+    let mut t = phase;
+    while t < flux.len() as f32 {
+        beats_ms.push(frame_millis(t));
+        t += period;
+    }
+
+    TrackAnalysis {
+        bpm: FRAME_RATE * 60.0 / period,
+        confidence,
+        duration_ms,
+        beats_ms,
+        onsets_ms,
+    }
+}
+
+/// Analyse mono samples at [`ANALYSIS_SAMPLE_RATE`].
+pub fn analyse_samples(samples: &[f32]) -> TrackAnalysis {
+    let mut flux = SpectralFlux::new();
+    flux.push(samples);
+    let duration_ms = samples.len() as u64 * 1000 / ANALYSIS_SAMPLE_RATE as u64;
+    analyse_flux(&flux.flux, duration_ms)
+}
+
+/// Decode and analyse `path` (a file or HTTP(S) URL).
+///
+/// Every [`ANALYSIS_PROGRESS_SECONDS`] of decoded audio, `progress` receives
+/// the completed percentage (if the duration is known) and the tempo
+/// estimated so far.  Returns early with an error once `cancel` is set.
+fn analyse_path(
+    path:         &str,
+    cancel:       &AtomicBool,
+    mut progress: impl FnMut(Option<f32>, Option<f32>),
+) -> Result<TrackAnalysis, String> {
+    let source = if path.starts_with("http://") || path.starts_with("https://") {
+        AudioSource::Url(path.to_string())
+    } else {
+        AudioSource::Path(path.to_string())
+    };
+    let mut blocks = BlockDecoder::open(source, 1, ANALYSIS_SAMPLE_RATE)?;
+    let total_samples = blocks
+        .duration
+        .map(|d| d.as_secs_f64() * ANALYSIS_SAMPLE_RATE as f64)
+        .filter(|&n| n > 0.0);
+    let report_every = (ANALYSIS_PROGRESS_SECONDS * ANALYSIS_SAMPLE_RATE) as u64;
+
+    let mut flux = SpectralFlux::new();
+    let mut decoded = 0u64;
+    let mut next_report = report_every;
+    while let Some(block) = blocks.next_block()? {
+        if cancel.load(Ordering::Relaxed) {
+            return Err("Analysis cancelled".to_string());
+        }
+        flux.push(&block);
+        decoded += block.len() as u64;
+        if decoded >= next_report {
+            next_report += report_every;
+            let percent = total_samples.map(|n| (decoded as f64 / n * 100.0).min(100.0) as f32);
+            let bpm = estimate_period(&flux.flux).map(|(period, _)| FRAME_RATE * 60.0 / period);
+            progress(percent, bpm);
+        }
+    }
+
+    let duration_ms = decoded * 1000 / ANALYSIS_SAMPLE_RATE as u64;
+    Ok(analyse_flux(&flux.flux, duration_ms))
+}
+
+// ── Cache ─────────────────────────────────────────────────────────────────────
+
+/// Identifies the version of a file a result was computed from.  URLs have
+/// no stamp and are cached by address alone.
+type Stamp = Option<(u64, SystemTime)>;
+
+fn stamp(path: &str) -> Stamp {
+    let meta = fs::metadata(path).ok()?;
+    Some((meta.len(), meta.modified().ok()?))
+}
+
+struct AnalysisCache {
+    entries: HashMap<String, (Stamp, Arc<TrackAnalysis>)>,
+    /// Insertion order, oldest first.
+    order:   VecDeque<String>,
+}
+
+static CACHE: Lazy<Mutex<AnalysisCache>> = Lazy::new(|| {
+    Mutex::new(AnalysisCache { entries: HashMap::new(), order: VecDeque::new() })
+});
+
+fn cached(path: &str, stamp: &Stamp) -> Option<Arc<TrackAnalysis>> {
+    let cache = CACHE.lock().ok()?;
+    cache
+        .entries
+        .get(path)
+        .filter(|(s, _)| s == stamp)
+        .map(|(_, analysis)| Arc::clone(analysis))
+}
+
+fn remember(path: &str, stamp: Stamp, analysis: Arc<TrackAnalysis>) {
+    let Ok(mut cache) = CACHE.lock() else { return };
+    if cache.entries.insert(path.to_string(), (stamp, analysis)).is_none() {
+        cache.order.push_back(path.to_string());
+    }
+    while cache.order.len() > ANALYSIS_CACHE_ENTRIES {
+        if let Some(oldest) = cache.order.pop_front() {
+            cache.entries.remove(&oldest);
+        }
+    }
+}
+
+/// Drop every cached result.
+pub fn clear_cache() {
+    if let Ok(mut cache) = CACHE.lock() {
+        cache.entries.clear();
+        cache.order.clear();
+    }
+}
+
+/// Analyse `path`, or return the cached result if the file is unchanged.
+pub fn analyse_track(
+    path:     &str,
+    cancel:   &AtomicBool,
+    progress: impl FnMut(Option<f32>, Option<f32>),
+) -> Result<Arc<TrackAnalysis>, String> {
+    let stamp = stamp(path);
+    if let Some(analysis) = cached(path, &stamp) {
+        return Ok(analysis);
+    }
+    let analysis = Arc::new(analyse_path(path, cancel, progress)?);
+    remember(path, stamp, Arc::clone(&analysis));
+    Ok(analysis)
+}
+
+// ── Batches ───────────────────────────────────────────────────────────────────
+
+/// A running batch analysis.  Dropping it cancels the remaining tracks.
+pub struct AnalysisBatch {
+    pub job:  u64,
+    cancel:   Arc<AtomicBool>,
+    finished: Arc<AtomicBool>,
+}
+
+impl AnalysisBatch {
+    /// Analyse `paths` on up to `threads` threads (0 = one per core),
+    /// publishing progress and results on `events`.
+    pub fn start(
+        job:     u64,
+        paths:   Vec<String>,
+        threads: usize,
+        events:  EventSender,
+    ) -> Result<Self, String> {
+        let cancel   = Arc::new(AtomicBool::new(false));
+        let finished = Arc::new(AtomicBool::new(false));
+        let threads = match threads {
+            0 => thread::available_parallelism().map(|n| n.get()).unwrap_or(1),
+            n => n,
+        }
+        .clamp(1, paths.len().max(1));
+
+        let batch_cancel   = Arc::clone(&cancel);
+        let batch_finished = Arc::clone(&finished);
+        thread::Builder::new()
+            .name("audiopc-analysis".into())
+            .spawn(move || {
+                run_batch(job, &paths, threads, &batch_cancel, &events);
+                batch_finished.store(true, Ordering::Release);
+                let _ = events.send(AudioEvent::AnalysisFinished { job });
+            })
+            .map_err(|e| format!("Failed to spawn analysis thread: {e}"))?;
+
+        info!("Analysis job {job} started on {threads} thread(s)");
+        Ok(Self { job, cancel, finished })
+    }
+
+    pub fn cancel(&self) {
+        self.cancel.store(true, Ordering::Relaxed);
+    }
+
+    pub fn is_finished(&self) -> bool {
+        self.finished.load(Ordering::Acquire)
+    }
+}
+
+impl Drop for AnalysisBatch {
+    fn drop(&mut self) {
+        self.cancel();
+    }
+}
+
+/// Workers take the next unclaimed path until none are left.
+fn run_batch(job: u64, paths: &[String], threads: usize, cancel: &AtomicBool, events: &EventSender) {
+    let next = AtomicUsize::new(0);
+    thread::scope(|scope| {
+        for index in 0..threads {
+            let worker = thread::Builder::new()
+                .name(format!("audiopc-analysis-{index}"))
+                .spawn_scoped(scope, || loop {
+                    let i = next.fetch_add(1, Ordering::Relaxed);
+                    let Some(path) = paths.get(i) else { break };
+                    if cancel.load(Ordering::Relaxed) {
+                        break;
+                    }
+                    let analysis = analyse_track(path, cancel, |percent, bpm| {
+                        let _ = events.send(AudioEvent::AnalysisProgress {
+                            job,
+                            path: path.clone(),
+                            percent,
+                            bpm,
+                        });
+                    });
+                    if let Err(e) = &analysis {
+                        error!("Analysis of '{path}' failed: {e}");
+                    }
+                    let _ = events.send(AudioEvent::AnalysisResult { job, path: path.clone(), analysis });
+                });
+            if let Err(e) = worker {
+                error!("Failed to spawn analysis worker {index}: {e}");
+            }
+        }
+    });
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::enums::EVENT_JSON_MAX_BYTES;
+    use std::time::Instant;
+
+    /// Mono click track at [`ANALYSIS_SAMPLE_RATE`]: a 5 ms decaying 2 kHz
+    /// burst on every beat, starting `offset_ms` in.
+    fn click_track(bpm: f32, seconds: f32, offset_ms: f32) -> Vec<f32> {
+        let rate   = ANALYSIS_SAMPLE_RATE as f32;
+        let period = rate * 60.0 / bpm;
+        let len    = (rate * seconds) as usize;
+        let click  = (rate * 0.005) as usize;
+        let mut samples = vec![0.0; len];
+        let mut start = rate * offset_ms / 1000.0;
+        while (start as usize) < len {
+            let first = start.round() as usize;
+            for (i, s) in samples[first..].iter_mut().take(click).enumerate() {
+                let t = i as f32 / rate;
+                *s = (2.0 * std::f32::consts::PI * 2_000.0 * t).sin() * (-t * 800.0).exp();
+            }
+            start += period;
+        }
+        samples
+    }
+
+    #[test]
+    fn click_track_tempo_and_grid() {
+        for bpm in [72.0, 96.0, 120.0, 128.0, 140.0, 174.0] {
+            let result = analyse_samples(&click_track(bpm, 60.0, 250.0));
+            assert!((result.bpm - bpm).abs() < bpm * 0.001, "{bpm} BPM estimated as {}", result.bpm);
+            assert!(result.confidence > 0.5, "{bpm} BPM confidence {}", result.confidence);
+
+            // Every beat lands on a click (one analysis hop is ~23 ms).
+            let period_ms = 60_000.0 / bpm;
+            for &beat in &result.beats_ms {
+                let phase = (beat as f32 - 250.0).rem_euclid(period_ms);
+                let error = phase.min(period_ms - phase);
+                assert!(error < 25.0, "{bpm} BPM beat at {beat} ms is {error} ms off");
+            }
+            let clicks = ((60_000.0 - 250.0) / period_ms).ceil() as usize;
+            assert!(result.beats_ms.len().abs_diff(clicks) <= 2);
+            assert!(result.onsets_ms.len().abs_diff(clicks) <= 2);
+        }
+    }
+
+    #[test]
+    fn result_event_fits_event_buffer() {
+        // An hour of dense material: far more beats and onsets than fit.
+        let analysis = TrackAnalysis {
+            bpm:         128.0,
+            confidence:  0.9,
+            duration_ms: 3_600_000,
+            beats_ms:    (0..7_680).map(|i| i * 469).collect(),
+            onsets_ms:   (0..30_000).map(|i| i * 120).collect(),
+        };
+        assert!(analysis.to_json().to_string().len() > EVENT_JSON_MAX_BYTES as usize);
+
+        let event = AudioEvent::AnalysisResult {
+            job:      1,
+            path:     "/music/long mix.flac".to_string(),
+            analysis: Ok(Arc::new(analysis)),
+        };
+        let json = event.to_json();
+        assert!(json.to_string().len() < 1024);
+        assert_eq!(json["analysis"]["beat_count"], 7_680);
+    }
+
+    /// `cargo test --release -- --ignored --nocapture analysis_speed`
+    #[test]
+    #[ignore]
+    fn analysis_speed() {
+        let seconds = 300.0;
+        let samples = click_track(124.0, seconds, 0.0);
+        let started = Instant::now();
+        let result  = analyse_samples(&samples);
+        let elapsed = started.elapsed().as_secs_f32();
+        println!(
+            "{seconds} s analysed in {:.1} ms: {:.0}x realtime ({:.2} BPM)",
+            elapsed * 1000.0,
+            seconds / elapsed,
+            result.bpm,
+        );
+    }
+}
@@ -0,0 +1,808 @@
+/// Audio capture: an input device recorded to WAV, with optional monitoring.
+///
+/// ```text
+/// cpal input callback ──► record ring  ──► writer thread ──► WAV file
+///                     └─► monitor ring ──► output callback (Effects chain)
+/// ```
+///
+/// The input callback only converts samples to `f32` and copies them into
+/// single-producer/single-consumer rings; it never locks or allocates.  A
+/// ring that is full drops the whole block and counts its frames, so a slow
+/// disk shows up as [`CaptureSession::dropped_frames`] instead of stalling
+/// the device.  The writer thread drains the record ring in batches of
+/// [`CAPTURE_WRITE_BATCH_FRAMES`], one sequential `write_all` per batch.
+///
+/// The monitor ring carries input already mixed to the output layout.  The
+/// output callback adds it ahead of the effect chains and skips any backlog
+/// beyond [`CAPTURE_MONITOR_MAX_LATENCY_MS`], so monitoring adds at most that
+/// much on top of the two device buffers.  Monitoring needs the input at the
+/// output sample rate, so the input is opened at that rate whenever the
+/// device accepts it.
+///
+/// 16-bit files are quantised with the output path's TPDF dither (see
+/// [`crate::sample_format`]) rather than truncated.  FLAC output would need
+/// an encoder dependency; captures are WAV only.
+
+use std::fs::File;
+use std::io::{self, BufWriter, Seek, SeekFrom, Write};
+use std::sync::atomic::{AtomicBool, AtomicU32, AtomicU64, AtomicUsize, Ordering};
+use std::sync::Arc;
+use std::thread::{self, JoinHandle};
+use std::time::Duration;
+
+use cpal::traits::{DeviceTrait, StreamTrait};
+use cpal::{BufferSize, Device, SampleFormat, Stream, StreamConfig, StreamError};
+use serde_json::json;
+
+use crate::device::DeviceManager;
+use crate::enums::{
+    CAPTURE_MONITOR_MAX_LATENCY_MS, CAPTURE_RING_SECONDS, CAPTURE_WRITE_BATCH_FRAMES,
+    CAPTURE_WRITER_IDLE_MS, OUTPUT_SCRATCH_SAMPLES,
+};
+use crate::error::AudioError;
+use crate::events::{AudioEvent, EventSender};
+use crate::mix_matrix::MixMatrix;
+use crate::sample_format::{Dither, InputSample, OutputSample};
+use crate::{debug, error, info, warn};
+
+/// Sample encoding of a capture file.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum CaptureFormat {
+    WavPcm16,
+    WavF32,
+}
+
+// ── SpscRing ──────────────────────────────────────────────────────────────────
+
+/// Single-producer, single-consumer ring of `f32` samples.
+///
+/// Samples are stored as `f32` bit patterns in `AtomicU32`s, so neither side
+/// needs `unsafe`; the indices publish whole slices with release/acquire.
+pub struct SpscRing {
+    buf:   Box<[AtomicU32]>,
+    mask:  usize,
+    /// Samples ever written.  Only the producer stores it.
+    write: AtomicUsize,
+    /// Samples ever read.  Only the consumer stores it.
+    read:  AtomicUsize,
+}
+
+impl SpscRing {
+    pub fn new(capacity: usize) -> Self {
+        let capacity = capacity.max(2).next_power_of_two();
+        Self {
+            buf:   (0..capacity).map(|_| AtomicU32::new(0)).collect(),
+            mask:  capacity - 1,
+            write: AtomicUsize::new(0),
+            read:  AtomicUsize::new(0),
+        }
+    }
+
+    pub fn capacity(&self) -> usize { self.buf.len() }
+
+    /// Samples queued between producer and consumer.
+    pub fn len(&self) -> usize {
+        self.write
+            .load(Ordering::Acquire)
+            .wrapping_sub(self.read.load(Ordering::Acquire))
+    }
+
+    /// Producer: append all of `samples`, or nothing if they do not fit.
+    #[inline]
+    pub fn push(&self, samples: &[f32]) -> bool {
+        let write = self.write.load(Ordering::Relaxed);
+        let used  = write.wrapping_sub(self.read.load(Ordering::Acquire));
+        if self.capacity() - used < samples.len() {
+            return false;
+        }
+        for (i, s) in samples.iter().enumerate() {
+            self.buf[write.wrapping_add(i) & self.mask].store(s.to_bits(), Ordering::Relaxed);
+        }
+        self.write.store(write.wrapping_add(samples.len()), Ordering::Release);
+        true
+    }
+
+    /// Consumer: move up to `out.len()` of the oldest samples into `out`.
+    /// Returns how many were moved.
+    #[inline]
+    pub fn pop(&self, out: &mut [f32]) -> usize {
+        let read  = self.read.load(Ordering::Relaxed);
+        let count = self.write.load(Ordering::Acquire).wrapping_sub(read).min(out.len());
+        for (i, o) in out[..count].iter_mut().enumerate() {
+            *o = f32::from_bits(self.buf[read.wrapping_add(i) & self.mask].load(Ordering::Relaxed));
+        }
+        self.read.store(read.wrapping_add(count), Ordering::Release);
+        count
+    }
+
+    /// Consumer: discard up to `count` of the oldest samples.
+    #[inline]
+    pub fn skip(&self, count: usize) {
+        let read  = self.read.load(Ordering::Relaxed);
+        let count = self.write.load(Ordering::Acquire).wrapping_sub(read).min(count);
+        self.read.store(read.wrapping_add(count), Ordering::Release);
+    }
+}
+
+// ── MonitorTap ────────────────────────────────────────────────────────────────
+
+/// Monitored input in the output layout, passed from the input callback to
+/// the output callback (see [`crate::player_state::SharedPlayback::monitor`]).
+pub struct MonitorTap {
+    ring:        SpscRing,
+    enabled:     AtomicBool,
+    channels:    usize,
+    /// Backlog (samples) the output keeps; older input is skipped.
+    max_backlog: usize,
+    sample_rate: u32,
+}
+
+impl MonitorTap {
+    fn new(out_channels: usize, sample_rate: u32) -> Self {
+        let max_backlog = (sample_rate as usize * CAPTURE_MONITOR_MAX_LATENCY_MS / 1000)
+            .max(1)
+            * out_channels;
+        Self {
+            ring:        SpscRing::new((max_backlog * 4).max(OUTPUT_SCRATCH_SAMPLES)),
+            enabled:     AtomicBool::new(false),
+            channels:    out_channels,
+            max_backlog,
+            sample_rate,
+        }
+    }
+
+    /// Output callback: fill `out` with monitored input, skipping backlog
+    /// beyond the latency bound and padding with silence when the input is
+    /// behind.  `out` holds whole output frames.
+    #[inline]
+    pub fn read_into(&self, out: &mut [f32]) {
+        let limit = self.max_backlog + out.len();
+        let queued = self.ring.len();
+        if queued > limit {
+            let excess = queued - limit;
+            self.ring.skip(excess - excess % self.channels);
+        }
+        let read = self.ring.pop(out);
+        out[read..].fill(0.0);
+    }
+
+    /// Monitored input waiting to be played, in milliseconds.
+    pub fn backlog_millis(&self) -> f64 {
+        let frames = self.ring.len() / self.channels.max(1);
+        frames as f64 * 1000.0 / self.sample_rate.max(1) as f64
+    }
+}
+
+// ── Shared state ──────────────────────────────────────────────────────────────
+
+struct CaptureShared {
+    record:          SpscRing,
+    /// Present when the input runs at the output rate.
+    monitor:         Option<Arc<MonitorTap>>,
+    captured_frames: AtomicU64,
+    dropped_frames:  AtomicU64,
+    /// Set once the input stream is gone; the writer drains and exits.
+    stop:            AtomicBool,
+}
+
+impl CaptureShared {
+    fn new(channels: usize, sample_rate: u32, monitor: Option<Arc<MonitorTap>>) -> Self {
+        Self {
+            record: SpscRing::new(sample_rate as usize * channels * CAPTURE_RING_SECONDS),
+            monitor,
+            captured_frames: AtomicU64::new(0),
+            dropped_frames:  AtomicU64::new(0),
+            stop:            AtomicBool::new(false),
+        }
+    }
+
+    /// Input callback: queue one converted block for the writer and, when
+    /// monitoring, for the output.
+    #[inline]
+    fn accept(&self, block: &[f32], channels: usize, mix: &MixMatrix, mixed: &mut Vec<f32>) {
+        let frames = (block.len() / channels) as u64;
+        if self.record.push(block) {
+            self.captured_frames.fetch_add(frames, Ordering::Relaxed);
+        } else {
+            self.dropped_frames.fetch_add(frames, Ordering::Relaxed);
+        }
+
+        let Some(tap) = self.monitor.as_deref() else { return; };
+        if !tap.enabled.load(Ordering::Relaxed) {
+            return;
+        }
+        // A full monitor ring means the output is not draining it; the
+        // block is simply not monitored.
+        if mix.is_identity() {
+            let _ = tap.ring.push(block);
+        } else {
+            mixed.clear();
+            for frame in block.chunks_exact(channels) {
+                mix.apply(frame, mixed);
+            }
+            let _ = tap.ring.push(mixed);
+        }
+    }
+}
+
+// ── WAV writer ────────────────────────────────────────────────────────────────
+
+pub(crate) struct WavWriter {
+    out:        BufWriter<File>,
+    format:     CaptureFormat,
+    data_bytes: u64,
+    /// Quantised and encoded batch, reused across writes.
+    pcm:        Vec<i16>,
+    bytes:      Vec<u8>,
+    dither:     Dither,
+}
+
+impl WavWriter {
+    const HEADER_BYTES: usize = 44;
+
+    pub(crate) fn create(path: &str, format: CaptureFormat, channels: u16, sample_rate: u32) -> io::Result<Self> {
+        let file = File::create(path)?;
+        let batch_bytes = CAPTURE_WRITE_BATCH_FRAMES * channels as usize * 4;
+        let mut out = BufWriter::with_capacity(batch_bytes, file);
+        out.write_all(&Self::header(format, channels, sample_rate, 0))?;
+        Ok(Self {
+            out,
+            format,
+            data_bytes: 0,
+            pcm:        Vec::new(),
+            bytes:      Vec::with_capacity(batch_bytes),
+            dither:     Dither::new(true),
+        })
+    }
+
+    fn header(format: CaptureFormat, channels: u16, sample_rate: u32, data_bytes: u32) -> [u8; 44] {
+        let (tag, bits): (u16, u16) = match format {
+            CaptureFormat::WavPcm16 => (1, 16),
+            CaptureFormat::WavF32   => (3, 32),
+        };
+        let block_align = channels * bits / 8;
+        let mut h = [0u8; Self::HEADER_BYTES];
+        h[0..4].copy_from_slice(b"RIFF");
+        h[4..8].copy_from_slice(&data_bytes.saturating_add(36).to_le_bytes());
+        h[8..12].copy_from_slice(b"WAVE");
+        h[12..16].copy_from_slice(b"fmt ");
+        h[16..20].copy_from_slice(&16u32.to_le_bytes());
+        h[20..22].copy_from_slice(&tag.to_le_bytes());
+        h[22..24].copy_from_slice(&channels.to_le_bytes());
+        h[24..28].copy_from_slice(&sample_rate.to_le_bytes());
+        h[28..32].copy_from_slice(&(sample_rate * block_align as u32).to_le_bytes());
+        h[32..34].copy_from_slice(&block_align.to_le_bytes());
+        h[34..36].copy_from_slice(&bits.to_le_bytes());
+        h[36..40].copy_from_slice(b"data");
+        h[40..44].copy_from_slice(&data_bytes.to_le_bytes());
+        h
+    }
+
+    pub(crate) fn write(&mut self, samples: &[f32]) -> io::Result<()> {
+        self.bytes.clear();
+        match self.format {
+            CaptureFormat::WavPcm16 => {
+                self.pcm.resize(samples.len(), 0);
+                i16::convert_block(samples, &mut self.pcm, &mut self.dither);
+                for v in &self.pcm {
+                    self.bytes.extend_from_slice(&v.to_le_bytes());
+                }
+            }
+            CaptureFormat::WavF32 => {
+                for s in samples {
+                    self.bytes.extend_from_slice(&s.to_le_bytes());
+                }
+            }
+        }
+        self.out.write_all(&self.bytes)?;
+        self.data_bytes += self.bytes.len() as u64;
+        Ok(())
+    }
+
+    /// Patch the chunk sizes into the header.  WAV sizes are 32-bit, so
+    /// files past 4 GiB keep a saturated size.
+    pub(crate) fn finish(mut self, channels: u16, sample_rate: u32) -> io::Result<()> {
+        let data_bytes = u32::try_from(self.data_bytes).unwrap_or(u32::MAX - 36);
+        self.out.flush()?;
+        let file = self.out.get_mut();
+        file.seek(SeekFrom::Start(0))?;
+        file.write_all(&Self::header(self.format, channels, sample_rate, data_bytes))?;
+        file.sync_data()
+    }
+}
+
+/// Writer thread: drain the record ring in batches until stopped.
+fn run_writer(
+    shared:      Arc<CaptureShared>,
+    mut wav:     WavWriter,
+    channels:    usize,
+    sample_rate: u32,
+) -> Result<(), String> {
+    let mut batch = vec![0.0f32; CAPTURE_WRITE_BATCH_FRAMES * channels];
+    loop {
+        let stopping = shared.stop.load(Ordering::Acquire);
+        if !stopping && shared.record.len() < batch.len() {
+            thread::sleep(Duration::from_millis(CAPTURE_WRITER_IDLE_MS));
+            continue;
+        }
+        let read = shared.record.pop(&mut batch);
+        if read > 0 {
+            wav.write(&batch[..read]).map_err(|e| AudioError::from(e).to_string())?;
+        }
+        if stopping && shared.record.len() == 0 {
+            break;
+        }
+    }
+    wav.finish(channels as u16, sample_rate).map_err(|e| AudioError::from(e).to_string())
+}
+
+// ── Input stream ──────────────────────────────────────────────────────────────
+
+/// What the input callback runs for each device buffer: convert to `f32`
+/// in bounded chunks and hand each one to [`CaptureShared::accept`].
+struct InputPath {
+    shared:   Arc<CaptureShared>,
+    mix:      MixMatrix,
+    channels: usize,
+    scratch:  Vec<f32>,
+    mixed:    Vec<f32>,
+}
+
+impl InputPath {
+    fn new(shared: Arc<CaptureShared>, mix: MixMatrix, channels: usize) -> Self {
+        let block_len = OUTPUT_SCRATCH_SAMPLES - OUTPUT_SCRATCH_SAMPLES % channels;
+        let mixed_len = block_len / channels * shared.monitor.as_ref().map_or(0, |tap| tap.channels);
+        Self {
+            shared,
+            mix,
+            channels,
+            scratch: vec![0.0; block_len],
+            mixed:   Vec::with_capacity(mixed_len),
+        }
+    }
+
+    #[inline]
+    fn deliver<T: InputSample>(&mut self, data: &[T]) {
+        for chunk in data.chunks(self.scratch.len()) {
+            let block = &mut self.scratch[..chunk.len()];
+            for (d, s) in block.iter_mut().zip(chunk) {
+                *d = s.to_f32();
+            }
+            self.shared.accept(block, self.channels, &self.mix, &mut self.mixed);
+        }
+    }
+}
+
+/// Everything an input callback needs, moved into the stream closure.
+struct InputContext {
+    shared:   Arc<CaptureShared>,
+    /// Input layout → output layout, for the monitor path.
+    mix:      MixMatrix,
+    channels: usize,
+    events:   EventSender,
+}
+
+fn build_input<T: InputSample>(
+    device: &Device,
+    config: &StreamConfig,
+    ctx:    InputContext,
+) -> Result<Stream, String> {
+    let InputContext { shared, mix, channels, events } = ctx;
+    let mut path = InputPath::new(shared, mix, channels);
+
+    device
+        .build_input_stream(
+            config,
+            move |data: &[T], _: &cpal::InputCallbackInfo| path.deliver(data),
+            move |err: StreamError| {
+                error!("Input stream error: {err}");
+                let _ = events.send(AudioEvent::Error(AudioError::Io(format!("Input stream: {err}"))));
+            },
+            None,
+        )
+        .map_err(|e| AudioError::from(e).to_string())
+}
+
+fn build_input_for_format(
+    device: &Device,
+    config: &StreamConfig,
+    format: SampleFormat,
+    ctx:    InputContext,
+) -> Result<Stream, String> {
+    match format {
+        SampleFormat::F32 => build_input::<f32>(device, config, ctx),
+        SampleFormat::F64 => build_input::<f64>(device, config, ctx),
+        SampleFormat::I8  => build_input::<i8>(device, config, ctx),
+        SampleFormat::I16 => build_input::<i16>(device, config, ctx),
+        SampleFormat::I24 => build_input::<cpal::I24>(device, config, ctx),
+        SampleFormat::I32 => build_input::<i32>(device, config, ctx),
+        SampleFormat::I64 => build_input::<i64>(device, config, ctx),
+        SampleFormat::U8  => build_input::<u8>(device, config, ctx),
+        SampleFormat::U16 => build_input::<u16>(device, config, ctx),
+        SampleFormat::U32 => build_input::<u32>(device, config, ctx),
+        SampleFormat::U64 => build_input::<u64>(device, config, ctx),
+        other => Err(AudioError::UnsupportedFormat(format!("{other:?} input")).to_string()),
+    }
+}
+
+// ── CaptureSession ────────────────────────────────────────────────────────────
+
+/// One running capture: the input stream, its writer thread and counters.
+/// Dropping it stops the input and finalises the file.
+pub struct CaptureSession {
+    stream:      Option<Stream>,
+    writer:      Option<JoinHandle<Result<(), String>>>,
+    shared:      Arc<CaptureShared>,
+    path:        String,
+    channels:    usize,
+    sample_rate: u32,
+}
+
+impl CaptureSession {
+    /// Open `device_name` (or the default input) and record it to `path`.
+    /// `out_channels`/`out_rate` describe the output, for monitoring.
+    pub fn start(
+        path:         &str,
+        device_name:  Option<&str>,
+        format:       CaptureFormat,
+        out_channels: usize,
+        out_rate:     u32,
+        events:       EventSender,
+    ) -> Result<Self, String> {
+        let device  = DeviceManager::new().resolve_input(device_name).map_err(|e| e.to_string())?;
+        let default = device
+            .default_input_config()
+            .map_err(|e| AudioError::from(e).to_string())?;
+        let channels      = default.channels().max(1) as usize;
+        let sample_format = default.sample_format();
+
+        // The output rate first, so the input can be monitored.
+        let mut rates = vec![out_rate];
+        if default.sample_rate() != out_rate {
+            rates.push(default.sample_rate());
+        }
+
+        let mut last_error = String::new();
+        for rate in rates {
+            let monitor = (rate == out_rate).then(|| Arc::new(MonitorTap::new(out_channels, rate)));
+            let shared  = Arc::new(CaptureShared::new(channels, rate, monitor));
+            let config  = StreamConfig {
+                channels:    channels as u16,
+                sample_rate: rate,
+                buffer_size: BufferSize::Default,
+            };
+            let ctx = InputContext {
+                shared:   Arc::clone(&shared),
+                mix:      MixMatrix::new(0, channels, out_channels),
+                channels,
+                events:   events.clone(),
+            };
+            let stream = match build_input_for_format(&device, &config, sample_format, ctx) {
+                Ok(stream) => stream,
+                Err(e) => {
+                    debug!("Input at {rate} Hz unavailable: {e}");
+                    last_error = e;
+                    continue;
+                }
+            };
+
+            let wav = WavWriter::create(path, format, channels as u16, rate)
+                .map_err(|e| AudioError::from(e).to_string())?;
+            let writer = {
+                let shared = Arc::clone(&shared);
+                thread::Builder::new()
+                    .name("audiopc-capture".into())
+                    .spawn(move || run_writer(shared, wav, channels, rate))
+                    .map_err(|e| e.to_string())?
+            };
+            let mut session = Self {
+                stream: Some(stream),
+                writer: Some(writer),
+                shared,
+                path: path.to_string(),
+                channels,
+                sample_rate: rate,
+            };
+            if let Err(e) = session.stream.as_ref().map_or(Ok(()), |s| s.play()) {
+                let _ = session.shutdown();
+                return Err(AudioError::from(e).to_string());
+            }
+            info!("Capturing {channels} ch at {rate} Hz to {path}");
+            return Ok(session);
+        }
+        Err(last_error)
+    }
+
+    /// The monitor tap, if the input runs at the output rate.
+    pub fn monitor_tap(&self) -> Option<&Arc<MonitorTap>> {
+        self.shared.monitor.as_ref()
+    }
+
+    pub fn set_monitoring(&self, enabled: bool) -> Result<(), String> {
+        let tap = self.monitor_tap().ok_or_else(|| {
+            format!("Input runs at {} Hz, not the output rate; it cannot be monitored", self.sample_rate)
+        })?;
+        tap.enabled.store(enabled, Ordering::Relaxed);
+        Ok(())
+    }
+
+    /// Input frames lost because the writer fell behind.
+    pub fn dropped_frames(&self) -> u64 {
+        self.shared.dropped_frames.load(Ordering::Relaxed)
+    }
+
+    /// Capture state as JSON for the FFI layer.
+    pub fn stats_json(&self) -> String {
+        let rate = self.sample_rate.max(1) as f64;
+        let tap  = self.shared.monitor.as_deref();
+        json!({
+            "path":               self.path,
+            "sample_rate":        self.sample_rate,
+            "channels":           self.channels,
+            "captured_frames":    self.shared.captured_frames.load(Ordering::Relaxed),
+            "dropped_frames":     self.dropped_frames(),
+            "record_backlog_ms":  (self.shared.record.len() / self.channels) as f64 * 1000.0 / rate,
+            "monitoring":         tap.is_some_and(|t| t.enabled.load(Ordering::Relaxed)),
+            "monitor_backlog_ms": tap.map(|t| t.backlog_millis()),
+        })
+        .to_string()
+    }
+
+    /// Stop the input, drain the ring and finalise the file.
+    pub fn finish(mut self) -> Result<(), String> {
+        self.shutdown()
+    }
+
+    fn shutdown(&mut self) -> Result<(), String> {
+        if let Some(tap) = self.shared.monitor.as_deref() {
+            tap.enabled.store(false, Ordering::Relaxed);
+        }
+        // No input callback runs after the stream is dropped, so the writer
+        // sees every captured frame before `stop`.
+        drop(self.stream.take());
+        self.shared.stop.store(true, Ordering::Release);
+        let Some(writer) = self.writer.take() else { return Ok(()); };
+        let result = writer
+            .join()
+            .unwrap_or_else(|_| Err("Capture writer thread panicked".to_string()));
+        let dropped = self.dropped_frames();
+        if dropped > 0 {
+            warn!("Capture to {} dropped {dropped} frames", self.path);
+        }
+        result
+    }
+}
+
+impl Drop for CaptureSession {
+    fn drop(&mut self) {
+        if let Err(e) = self.shutdown() {
+            error!("{e}");
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::time::Instant;
+
+    const RATE:     u32   = 48_000;
+    const CHANNELS: usize = 2;
+    const BLOCK:    usize = 256;
+
+    fn shared(monitor: bool) -> Arc<CaptureShared> {
+        let tap = monitor.then(|| {
+            let tap = Arc::new(MonitorTap::new(CHANNELS, RATE));
+            tap.enabled.store(true, Ordering::Relaxed);
+            tap
+        });
+        Arc::new(CaptureShared::new(CHANNELS, RATE, tap))
+    }
+
+    fn input_path(shared: &Arc<CaptureShared>) -> InputPath {
+        InputPath::new(Arc::clone(shared), MixMatrix::new(0, CHANNELS, CHANNELS), CHANNELS)
+    }
+
+    /// Read back the data chunk of a WAV written by [`WavWriter`].
+    fn wav_data(path: &std::path::Path) -> (Vec<u8>, Vec<u8>) {
+        let bytes = std::fs::read(path).unwrap();
+        let (header, data) = bytes.split_at(WavWriter::HEADER_BYTES);
+        let size = u32::from_le_bytes(header[40..44].try_into().unwrap()) as usize;
+        assert_eq!(size, data.len());
+        assert_eq!(u32::from_le_bytes(header[4..8].try_into().unwrap()) as usize, size + 36);
+        (header.to_vec(), data.to_vec())
+    }
+
+    #[test]
+    fn ring_wraps_and_pushes_all_or_nothing() {
+        let ring = SpscRing::new(6);
+        assert_eq!(ring.capacity(), 8);
+        let mut out = [0.0; 8];
+        for round in 0..5 {
+            let base = round as f32 * 10.0;
+            assert!(ring.push(&[base, base + 1.0, base + 2.0, base + 3.0, base + 4.0]));
+            assert!(!ring.push(&[0.0; 4]));
+            ring.skip(1);
+            assert_eq!(ring.pop(&mut out[..3]), 3);
+            assert_eq!(out[..3], [base + 1.0, base + 2.0, base + 3.0]);
+            assert_eq!(ring.pop(&mut out), 1);
+            assert_eq!(ring.len(), 0);
+        }
+    }
+
+    #[test]
+    fn ring_keeps_order_across_threads() {
+        let ring = Arc::new(SpscRing::new(1_024));
+        let producer = {
+            let ring = Arc::clone(&ring);
+            thread::spawn(move || {
+                let mut next = 0u32;
+                while next < 1_000_000 {
+                    let block: Vec<f32> = (next..next + 100).map(|n| n as f32).collect();
+                    if ring.push(&block) {
+                        next += 100;
+                    }
+                }
+            })
+        };
+        let mut expected = 0u32;
+        let mut out = [0.0; 256];
+        while expected < 1_000_000 {
+            let count = ring.pop(&mut out);
+            for &s in &out[..count] {
+                assert_eq!(s, expected as f32);
+                expected += 1;
+            }
+        }
+        producer.join().unwrap();
+    }
+
+    #[test]
+    fn full_record_ring_counts_dropped_frames() {
+        let shared = shared(false);
+        let mut input = input_path(&shared);
+        let fits = shared.record.capacity() / (BLOCK * CHANNELS);
+        for _ in 0..fits + 10 {
+            input.deliver(&[0i16; BLOCK * CHANNELS]);
+        }
+        assert_eq!(shared.captured_frames.load(Ordering::Relaxed), (fits * BLOCK) as u64);
+        assert_eq!(shared.dropped_frames.load(Ordering::Relaxed), (10 * BLOCK) as u64);
+    }
+
+    #[test]
+    fn monitor_mixes_to_the_output_layout_and_bounds_backlog() {
+        // Mono input monitored on a stereo output.
+        let tap = Arc::new(MonitorTap::new(2, RATE));
+        tap.enabled.store(true, Ordering::Relaxed);
+        let shared = Arc::new(CaptureShared::new(1, RATE, Some(Arc::clone(&tap))));
+        let mut input = InputPath::new(Arc::clone(&shared), MixMatrix::new(0, 1, 2), 1);
+        let samples: Vec<f32> = (0..RATE as usize / 10).map(|n| n as f32 / 65_536.0).collect();
+        input.deliver(&samples);
+
+        // 100 ms queued; the output keeps only the latency bound.
+        let mut out = vec![0.0; 2 * BLOCK];
+        tap.read_into(&mut out);
+        let first = samples.len() - tap.max_backlog / 2 - BLOCK;
+        let mix = MixMatrix::new(0, 1, 2);
+        let mut expected = Vec::new();
+        for frame in &samples[first..first + BLOCK] {
+            mix.apply(std::slice::from_ref(frame), &mut expected);
+        }
+        assert_eq!(out, expected);
+        assert!(tap.backlog_millis() <= CAPTURE_MONITOR_MAX_LATENCY_MS as f64);
+
+        // Drained: silence, never stale input.
+        tap.read_into(&mut vec![0.0; tap.max_backlog]);
+        tap.read_into(&mut out);
+        assert!(out.iter().all(|&s| s == 0.0));
+    }
+
+    #[test]
+    fn pcm16_is_dithered_not_truncated() {
+        let file = tempfile::NamedTempFile::new().unwrap();
+        let path = file.path().to_str().unwrap();
+        let mut wav = WavWriter::create(path, CaptureFormat::WavPcm16, 1, RATE).unwrap();
+        // A 1 kHz tone at 0.4 LSB: plain rounding turns it into silence.
+        let quiet: Vec<f32> = (0..RATE as usize)
+            .map(|n| (n as f32 * 2.0 * std::f32::consts::PI * 1_000.0 / RATE as f32).sin() * 0.4 / 32_767.0)
+            .collect();
+        wav.write(&quiet).unwrap();
+        wav.finish(1, RATE).unwrap();
+
+        let (header, data) = wav_data(file.path());
+        assert_eq!(u16::from_le_bytes([header[20], header[21]]), 1);
+        assert_eq!(u16::from_le_bytes([header[34], header[35]]), 16);
+        let pcm: Vec<i16> = data.chunks_exact(2).map(|b| i16::from_le_bytes([b[0], b[1]])).collect();
+        assert_eq!(pcm.len(), quiet.len());
+
+        let mut correlation = 0.0f64;
+        let mut mean_error  = 0.0f64;
+        for (&x, &y) in quiet.iter().zip(&pcm) {
+            let error = y as f64 - x as f64 * 32_767.0;
+            assert!(error.abs() <= 1.5, "{x} -> {y}");
+            correlation += x as f64 * y as f64;
+            mean_error  += error;
+        }
+        assert!(pcm.iter().any(|&y| y != 0));
+        assert!(correlation > 0.0, "the tone must survive as signal, not noise");
+        assert!((mean_error / pcm.len() as f64).abs() < 0.02);
+    }
+
+    /// A synthetic input device feeding the real input path at real-time
+    /// pace, with the writer thread recording to disk and a synthetic output
+    /// device reading the monitor tap.  Measures dropped frames and the
+    /// input-to-output monitoring latency.
+    #[test]
+    fn synthetic_device_records_everything_and_monitors_promptly() {
+        const BLOCKS: usize = 200;
+        const MARK_EVERY: usize = 30;
+        let period = Duration::from_secs_f64(BLOCK as f64 / RATE as f64);
+
+        let file   = tempfile::NamedTempFile::new().unwrap();
+        let shared = shared(true);
+        let tap    = Arc::clone(shared.monitor.as_ref().unwrap());
+        let wav    = WavWriter::create(file.path().to_str().unwrap(), CaptureFormat::WavF32, CHANNELS as u16, RATE)
+            .unwrap();
+        let writer = {
+            let shared = Arc::clone(&shared);
+            thread::spawn(move || run_writer(shared, wav, CHANNELS, RATE))
+        };
+
+        // Input block `b` carries a marker on its first frame when
+        // `b % MARK_EVERY == 0`; every other sample encodes its position.
+        let sample = |frame: usize, channel: usize| {
+            if frame % (BLOCK * MARK_EVERY) == 0 { 1.0 } else { ((frame * CHANNELS + channel) % 1_000) as f32 / 4_000.0 }
+        };
+        let start = Instant::now() + Duration::from_millis(20);
+        let input = {
+            let shared = Arc::clone(&shared);
+            thread::spawn(move || {
+                let mut path = input_path(&shared);
+                let mut block = vec![0.0f32; BLOCK * CHANNELS];
+                // A device hands over each buffer once it has been filled.
+                for b in 0..BLOCKS {
+                    thread::sleep((start + period * (b as u32 + 1)).saturating_duration_since(Instant::now()));
+                    for (i, s) in block.iter_mut().enumerate() {
+                        *s = sample(b * BLOCK + i / CHANNELS, i % CHANNELS);
+                    }
+                    path.deliver(&block);
+                }
+            })
+        };
+
+        // The output device runs at the same rate, half a block out of
+        // phase; a buffer read at `t` starts playing at `t`.  Latency is
+        // when a marker plays minus when it was captured.
+        let mut latencies = Vec::new();
+        let mut out = vec![0.0f32; BLOCK * CHANNELS];
+        for b in 0..BLOCKS + 4 {
+            let due = start + period * b as u32 + period / 2;
+            thread::sleep(due.saturating_duration_since(Instant::now()));
+            let read_at = start.elapsed().as_secs_f64() * 1_000.0;
+            tap.read_into(&mut out);
+            for (frame, pair) in out.chunks_exact(CHANNELS).enumerate() {
+                if pair[0] == 1.0 {
+                    let marked = latencies.len() * BLOCK * MARK_EVERY;
+                    latencies.push(read_at + (frame as f64 - marked as f64) * 1_000.0 / RATE as f64);
+                }
+            }
+        }
+        input.join().unwrap();
+        shared.stop.store(true, Ordering::Release);
+        writer.join().unwrap().unwrap();
+
+        // Nothing dropped, and the file holds exactly what was captured.
+        assert_eq!(shared.dropped_frames.load(Ordering::Relaxed), 0);
+        assert_eq!(shared.captured_frames.load(Ordering::Relaxed), (BLOCKS * BLOCK) as u64);
+        let (_, data) = wav_data(file.path());
+        for (i, bytes) in data.chunks_exact(4).enumerate() {
+            let s = f32::from_le_bytes(bytes.try_into().unwrap());
+            assert_eq!(s, sample(i / CHANNELS, i % CHANNELS), "sample {i}");
+        }
+
+        assert_eq!(latencies.len(), BLOCKS.div_ceil(MARK_EVERY));
+        let worst = latencies.iter().cloned().fold(0.0, f64::max);
+        let bound = CAPTURE_MONITOR_MAX_LATENCY_MS as f64 + 2.0 * BLOCK as f64 * 1_000.0 / RATE as f64;
+        assert!(worst <= bound, "worst monitor latency {worst:.2} ms > {bound:.2} ms");
+    }
+}
@@ -0,0 +1,162 @@
+/// Shared, bounded pool of decode workers with deadline-first scheduling.
+///
+/// Every player submits its decoder as a [`PoolJob`] instead of owning a
+/// thread.  A job runs for at most one slice ([`DECODE_POOL_SLICE_MS`]) and
+/// then reports when its queue will run dry; idle workers always pick the
+/// runnable job with the earliest such deadline, so the player closest to an
+/// underrun is decoded first and a long file never starves a freshly seeked
+/// one (a job that has not produced anything yet is due immediately).
+///
+/// A job whose queue is full is parked for [`DECODE_BACKPRESSURE_SLEEP_MS`]
+/// rather than polled.  Stopping is the job's business: a stopped job
+/// returns [`Slice::Done`] from its next slice and is dropped.
+///
+/// Jobs must not block on I/O for long — a stalled job holds a worker.
+/// Network-bound sources therefore keep a dedicated thread and drive the
+/// same job with [`run_dedicated`].
+
+use std::sync::{Condvar, Mutex};
+use std::thread;
+use std::time::{Duration, Instant};
+
+use once_cell::sync::Lazy;
+
+use crate::enums::{DECODE_BACKPRESSURE_SLEEP_MS, DECODE_POOL_MAX_THREADS};
+use crate::error;
+use crate::thread_priority::{PriorityHint, ThreadRole};
+
+/// Outcome of one [`PoolJob::run_slice`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Slice {
+    /// Made progress; schedule again by deadline.
+    Progress,
+    /// The consumer's queue is full; retry after a back-off.
+    Blocked,
+    /// Finished, failed or stopped; drop the job.
+    Done,
+}
+
+/// A resumable unit of decode work.
+pub trait PoolJob: Send {
+    /// Do a bounded amount of work.  `waited` is how long the job was
+    /// runnable before a pool worker picked it up (`None` on a dedicated
+    /// thread).
+    fn run_slice(&mut self, waited: Option<Duration>) -> Slice;
+
+    /// When the consumer is expected to run out of decoded audio.
+    fn deadline(&self) -> Instant;
+}
+
+// ── Scheduler ─────────────────────────────────────────────────────────────────
+
+struct Entry {
+    job:      Box<dyn PoolJob>,
+    deadline: Instant,
+    /// Not runnable before this instant (back-off after [`Slice::Blocked`]).
+    ready_at: Instant,
+}
+
+struct DecodePool {
+    entries: Mutex<Vec<Entry>>,
+    wakeup:  Condvar,
+}
+
+static POOL: Lazy<DecodePool> = Lazy::new(|| {
+    let pool = DecodePool { entries: Mutex::new(Vec::new()), wakeup: Condvar::new() };
+    for index in 0..worker_count() {
+        let spawned = thread::Builder::new()
+            .name(format!("audiopc-decode-{index}"))
+            .spawn(run_worker);
+        if let Err(e) = spawned {
+            error!("Failed to spawn decode worker {index}: {e}");
+        }
+    }
+    pool
+});
+
+/// One fewer than the available cores (the audio callback needs one),
+/// clamped to `1..=DECODE_POOL_MAX_THREADS`.
+fn worker_count() -> usize {
+    thread::available_parallelism()
+        .map(|n| n.get().saturating_sub(1))
+        .unwrap_or(1)
+        .clamp(1, DECODE_POOL_MAX_THREADS)
+}
+
+/// Queue `job` on the shared pool, starting the workers on first use.
+pub fn submit(job: Box<dyn PoolJob>) {
+    let now = Instant::now();
+    let entry = Entry { deadline: job.deadline(), ready_at: now, job };
+    if let Ok(mut entries) = POOL.entries.lock() {
+        entries.push(entry);
+    }
+    POOL.wakeup.notify_one();
+}
+
+/// Index of the runnable entry with the earliest deadline, or the instant
+/// the next parked entry becomes runnable.
+fn pick(entries: &[Entry], now: Instant) -> Result<usize, Option<Instant>> {
+    let mut best: Option<usize> = None;
+    let mut next_ready: Option<Instant> = None;
+    for (i, entry) in entries.iter().enumerate() {
+        if entry.ready_at > now {
+            next_ready = Some(next_ready.map_or(entry.ready_at, |t| t.min(entry.ready_at)));
+        } else if best.is_none_or(|b| entry.deadline < entries[b].deadline) {
+            best = Some(i);
+        }
+    }
+    best.ok_or(next_ready)
+}
+
+fn run_worker() {
+    let pool = Lazy::force(&POOL);
+    let mut hint = PriorityHint::new(ThreadRole::Decode);
+    loop {
+        hint.refresh();
+        let Some(mut entry) = next_entry(pool) else { return };
+
+        let now = Instant::now();
+        let outcome = entry.job.run_slice(Some(now.saturating_duration_since(entry.ready_at)));
+        let now = Instant::now();
+        match outcome {
+            Slice::Done => continue,
+            Slice::Progress => entry.ready_at = now,
+            Slice::Blocked  => entry.ready_at = now + Duration::from_millis(DECODE_BACKPRESSURE_SLEEP_MS),
+        }
+        entry.deadline = entry.job.deadline();
+        match pool.entries.lock() {
+            Ok(mut entries) => entries.push(entry),
+            Err(_) => return,
+        }
+        // Another worker may be sleeping until a later back-off expires.
+        pool.wakeup.notify_one();
+    }
+}
+
+/// Block until an entry is runnable and take it out of the queue, so no
+/// other worker runs it concurrently.  `None` if the pool lock is poisoned.
+fn next_entry(pool: &DecodePool) -> Option<Entry> {
+    let mut entries = pool.entries.lock().ok()?;
+    loop {
+        let now = Instant::now();
+        entries = match pick(&entries, now) {
+            Ok(i) => return Some(entries.swap_remove(i)),
+            Err(Some(ready_at)) => pool.wakeup.wait_timeout(entries, ready_at - now).ok()?.0,
+            Err(None) => pool.wakeup.wait(entries).ok()?,
+        };
+    }
+}
+
+/// Drive `job` to completion on the calling thread, sleeping through
+/// back-pressure.  Used for sources whose reads may block.
+pub fn run_dedicated(mut job: Box<dyn PoolJob>) {
+    let mut hint = PriorityHint::new(ThreadRole::Decode);
+    loop {
+        hint.refresh();
+        match job.run_slice(None) {
+            Slice::Done     => return,
+            Slice::Progress => {}
+            Slice::Blocked  => thread::sleep(Duration::from_millis(DECODE_BACKPRESSURE_SLEEP_MS)),
+        }
+    }
+}
@@ -12,8 +12,8 @@
 /// the engine thread and communicate via the event channel.
 
 use std::sync::{
-    atomic::{AtomicBool, Ordering},
-    Arc,
+    atomic::{AtomicBool, AtomicUsize, Ordering},
+    Arc, Mutex,
 };
 use std::thread;
 use std::time::Duration;
@@ -156,6 +156,63 @@ impl DeviceManager {
     }
 }
 
+// ── Cached default output format ──────────────────────────────────────────────
+
+/// Format of the default output device.
+#[derive(Debug, Clone, Copy)]
+pub struct OutputFormat {
+    pub sample_rate:   u32,
+    pub channels:      u16,
+    pub sample_format: cpal::SampleFormat,
+}
+
+/// Process-wide cache of the default output format, so engine creation, the
+/// first `play()` and the `default_output_*` queries don't each re-query the
+/// host.  Invalidated by the device watcher when the default device changes.
+static DEFAULT_OUTPUT_FORMAT: Mutex<Option<OutputFormat>> = Mutex::new(None);
+
+/// Cached output device count; `usize::MAX` = not yet enumerated.
+static OUTPUT_DEVICE_COUNT: AtomicUsize = AtomicUsize::new(usize::MAX);
+
+/// Return the default output device's format, querying the host only on the
+/// first call after start-up or after [`invalidate_device_cache`].
+pub fn cached_default_output_format() -> Result<OutputFormat, AudioError> {
+    if let Some(format) = DEFAULT_OUTPUT_FORMAT.lock().ok().and_then(|f| *f) {
+        return Ok(format);
+    }
+
+    let device = DeviceManager::new().resolve_output(None)?;
+    let config = device.default_output_config().map_err(AudioError::from)?;
+    let format = OutputFormat {
+        sample_rate:   config.sample_rate(),
+        channels:      config.channels(),
+        sample_format: config.sample_format(),
+    };
+    if let Ok(mut cached) = DEFAULT_OUTPUT_FORMAT.lock() {
+        *cached = Some(format);
+    }
+    Ok(format)
+}
+
+/// Number of output devices, enumerated once and then kept current by the
+/// device watcher.
+pub fn cached_output_device_count() -> usize {
+    let count = OUTPUT_DEVICE_COUNT.load(Ordering::Relaxed);
+    if count != usize::MAX {
+        return count;
+    }
+    let count = DeviceManager::new().output_devices().len();
+    OUTPUT_DEVICE_COUNT.store(count, Ordering::Relaxed);
+    count
+}
+
+/// Drop the cached default format so the next query goes to the host.
+pub fn invalidate_device_cache() {
+    if let Ok(mut cached) = DEFAULT_OUTPUT_FORMAT.lock() {
+        *cached = None;
+    }
+}
+
 /// Starts a background thread that polls for device changes and emits
 /// [`AudioEvent::DeviceAdded`] / [`AudioEvent::DeviceRemoved`] /
 /// [`AudioEvent::DefaultDeviceChanged`] events.
@@ -185,6 +242,7 @@ pub fn start_device_watcher(event_tx: EventSender) -> Arc<AtomicBool> {
 
             let current_devices = manager.output_devices();
             let current_count   = current_devices.len();
+            OUTPUT_DEVICE_COUNT.store(current_count, Ordering::Relaxed);
             let current_default = manager
                 .resolve_output(None)
                 .ok()
@@ -207,6 +265,7 @@ pub fn start_device_watcher(event_tx: EventSender) -> Arc<AtomicBool> {
 
             // Default device changed.
             if current_default != last_default_name {
+                invalidate_device_cache();
                 let info = DeviceInfo { name: current_default.clone(), is_default: true };
                 let _ = event_tx.send(AudioEvent::DefaultDeviceChanged(info));
                 debug!("Default device changed to '{current_default}'");
@@ -16,6 +16,17 @@
 ///    `Effects::chain` vector using [`Effects::push`].
 ///
 /// No changes to the engine or FFI layer are needed.
+///
+/// # Live updates
+///
+/// Chains are never edited in place while audio is running.  The engine
+/// builds a replacement chain off the audio thread and publishes it through
+/// [`crate::chain_exchange::ChainExchange`]; the callback then calls
+/// [`AudioProcessor::inherit`] on each new processor with its same-named
+/// predecessor so running state (filter history, coefficients) carries over
+/// and parameter changes glide instead of clicking.  Filters that appear or
+/// disappear are covered by the callback crossfading from the old chain to
+/// the new one.
 pub trait AudioProcessor: Send + 'static {
     /// Process a single sample in-place.
     ///
@@ -33,47 +44,158 @@ pub trait AudioProcessor: Send + 'static {
 
     /// Human-readable name, useful for debugging and serialisation.
     fn name(&self) -> &'static str;
+
+    /// Called once at the start of every callback block, before any
+    /// `process_sample`.  Use it for per-block parameter smoothing.
+    #[allow(unused_variables)]
+    fn begin_block(&mut self, frames: usize) {}
+
+    /// Take over running state from `previous`, the processor with the same
+    /// name in the chain being replaced.  Called on the audio thread, so it
+    /// must not allocate.
+    #[allow(unused_variables)]
+    fn inherit(&mut self, previous: &dyn AudioProcessor) {}
+
+    /// Expose biquad coefficients and history so a replacement filter can
+    /// continue from them.  `None` for non-biquad processors.
+    fn biquad_state(&self) -> Option<BiquadState> { None }
 }
 
 // ── Built-in biquad processors ────────────────────────────────────────────────
 
-use biquad::{Biquad, Coefficients, DirectForm1, ToHertz, Type as BiquadType};
+use biquad::{Coefficients, ToHertz, Type as BiquadType};
+
+use crate::enums::FILTER_GLIDE_MILLIS;
+
+/// Coefficients plus Direct Form I history (`x1, x2, y1, y2`) of a biquad,
+/// used to hand running state from one filter instance to its replacement.
+#[derive(Clone, Copy, Debug)]
+pub struct BiquadState {
+    pub coeffs:  Coefficients<f32>,
+    pub history: [f32; 4],
+}
+
+/// Pass-through biquad coefficients (`y = x`).
+const IDENTITY_COEFFS: Coefficients<f32> = Coefficients {
+    a1: 0.0, a2: 0.0, b0: 1.0, b1: 0.0, b2: 0.0,
+};
 
 /// A single biquad filter with one coefficient set.
 ///
 /// Used as the building block for `LowPass`, `HighPass`, `Peak`, etc.
+///
+/// Coefficient changes are not applied instantly: a filter built with
+/// [`BiquadFilter::with_glide`] starts from its predecessor's coefficients
+/// (or pass-through) and interpolates towards its target once per callback
+/// block, which removes zipper noise and clicks while a slider is dragged.
 pub struct BiquadFilter {
-    filter: Option<DirectForm1<f32>>,
-    coeffs: Coefficients<f32>,
-    label:  &'static str,
+    /// Coefficients currently in use.
+    current: Coefficients<f32>,
+    /// Coefficients the glide started from.
+    start:   Coefficients<f32>,
+    /// Coefficients requested by the caller.
+    target:  Coefficients<f32>,
+    /// Glide length in frames; `0` = no glide.
+    glide_frames: usize,
+    /// Frames elapsed since the glide started.
+    glide_pos:    usize,
+    x1: f32,
+    x2: f32,
+    y1: f32,
+    y2: f32,
+    label: &'static str,
 }
 
 impl BiquadFilter {
+    /// Create a filter that uses `coeffs` immediately.
     pub fn new(coeffs: Coefficients<f32>, label: &'static str) -> Self {
         Self {
-            filter: Some(DirectForm1::new(coeffs)),
-            coeffs,
+            current: coeffs,
+            start:   coeffs,
+            target:  coeffs,
+            glide_frames: 0,
+            glide_pos:    0,
+            x1: 0.0, x2: 0.0, y1: 0.0, y2: 0.0,
             label,
         }
     }
+
+    /// Fade the filter in from pass-through (or from the filter it replaces,
+    /// see [`AudioProcessor::inherit`]) over `glide_frames` frames.
+    pub fn with_glide(mut self, glide_frames: usize) -> Self {
+        self.glide_frames = glide_frames;
+        self.glide_pos    = 0;
+        if glide_frames > 0 {
+            self.start   = IDENTITY_COEFFS;
+            self.current = IDENTITY_COEFFS;
+        }
+        self
+    }
+}
+
+#[inline]
+fn lerp_coeffs(a: &Coefficients<f32>, b: &Coefficients<f32>, t: f32) -> Coefficients<f32> {
+    Coefficients {
+        a1: a.a1 + (b.a1 - a.a1) * t,
+        a2: a.a2 + (b.a2 - a.a2) * t,
+        b0: a.b0 + (b.b0 - a.b0) * t,
+        b1: a.b1 + (b.b1 - a.b1) * t,
+        b2: a.b2 + (b.b2 - a.b2) * t,
+    }
 }
 
 impl AudioProcessor for BiquadFilter {
     #[inline]
     fn process_sample(&mut self, sample: f32, _channel: usize) -> f32 {
-        if let Some(f) = &mut self.filter {
-            f.run(sample)
-        } else {
-            sample
-        }
+        let c = &self.current;
+        let out = c.b0 * sample + c.b1 * self.x1 + c.b2 * self.x2
+            - c.a1 * self.y1
+            - c.a2 * self.y2;
+        self.x2 = self.x1;
+        self.x1 = sample;
+        self.y2 = self.y1;
+        self.y1 = out;
+        out
     }
 
     fn reset(&mut self, _sample_rate: u32, _channels: u16) {
         // Re-initialise state; keep same coefficients.
-        self.filter = Some(DirectForm1::new(self.coeffs));
+        self.current = self.target;
+        self.glide_pos = self.glide_frames;
+        self.x1 = 0.0;
+        self.x2 = 0.0;
+        self.y1 = 0.0;
+        self.y2 = 0.0;
     }
 
     fn name(&self) -> &'static str { self.label }
+
+    #[inline]
+    fn begin_block(&mut self, frames: usize) {
+        if self.glide_pos >= self.glide_frames {
+            return;
+        }
+        self.glide_pos = (self.glide_pos + frames).min(self.glide_frames);
+        let t = self.glide_pos as f32 / self.glide_frames as f32;
+        self.current = lerp_coeffs(&self.start, &self.target, t);
+    }
+
+    fn inherit(&mut self, previous: &dyn AudioProcessor) {
+        let Some(state) = previous.biquad_state() else { return };
+        [self.x1, self.x2, self.y1, self.y2] = state.history;
+        if self.glide_frames > 0 {
+            self.start   = state.coeffs;
+            self.current = state.coeffs;
+            self.glide_pos = 0;
+        }
+    }
+
+    fn biquad_state(&self) -> Option<BiquadState> {
+        Some(BiquadState {
+            coeffs:  self.current,
+            history: [self.x1, self.x2, self.y1, self.y2],
+        })
+    }
 }
 
 /// A linear gain / volume node.
@@ -163,10 +285,102 @@ impl Effects {
             p.reset(sample_rate, channels);
         }
     }
+
+    /// Notify every processor that a new callback block of `frames` frames
+    /// is about to be processed.
+    #[inline]
+    pub fn begin_block(&mut self, frames: usize) {
+        for p in &mut self.chain {
+            p.begin_block(frames);
+        }
+    }
+
+    /// Carry running state over from `previous` (the chain this one
+    /// replaces), matching processors by name.  Allocation-free.
+    pub fn inherit_from(&mut self, previous: &Effects) {
+        for p in &mut self.chain {
+            let name = p.name();
+            if let Some(old) = previous.chain.iter().find(|o| o.name() == name) {
+                p.inherit(old.as_ref());
+            }
+        }
+    }
 }
 
 impl Default for Effects { fn default() -> Self { Self::new() } }
 
+// ── Filter specs ──────────────────────────────────────────────────────────────
+
+/// User-facing description of one filter in the chain.
+///
+/// The engine keeps the list of specs as the source of truth and rebuilds
+/// concrete processors from it whenever the chain changes, so specs can be
+/// re-instantiated for any sample rate or channel count.
+#[derive(Clone, Debug, PartialEq)]
+pub enum FilterSpec {
+    Peak      { center_hz: f32, gain_db: f32, q: f32 },
+    LowShelf  { cutoff_hz: f32, gain_db: f32, q: f32 },
+    HighShelf { cutoff_hz: f32, gain_db: f32, q: f32 },
+    BandPass  { center_hz: f32, q: f32 },
+    LowPass   { cutoff_hz: f32, q: f32 },
+    HighPass  { cutoff_hz: f32, q: f32 },
+    Notch     { center_hz: f32, q: f32 },
+}
+
+impl FilterSpec {
+    /// Processor name this spec produces; at most one filter per label is
+    /// kept in a chain.
+    pub fn label(&self) -> &'static str {
+        match self {
+            Self::Peak { .. }      => "PeakEQ",
+            Self::LowShelf { .. }  => "LowShelf",
+            Self::HighShelf { .. } => "HighShelf",
+            Self::BandPass { .. }  => "BandPass",
+            Self::LowPass { .. }   => "LowPass",
+            Self::HighPass { .. }  => "HighPass",
+            Self::Notch { .. }     => "Notch",
+        }
+    }
+
+    /// Build the processor for `sample_rate`, or `None` if the parameters
+    /// do not produce valid coefficients.
+    pub fn build(&self, sample_rate: u32) -> Option<BiquadFilter> {
+        let filter = match *self {
+            Self::Peak { center_hz, gain_db, q } =>
+                peak_filter(sample_rate, center_hz, gain_db, q),
+            Self::LowShelf { cutoff_hz, gain_db, q } =>
+                low_shelf_filter(sample_rate, cutoff_hz, gain_db, q),
+            Self::HighShelf { cutoff_hz, gain_db, q } =>
+                high_shelf_filter(sample_rate, cutoff_hz, gain_db, q),
+            Self::BandPass { center_hz, q } => band_pass_filter(sample_rate, center_hz, q),
+            Self::LowPass { cutoff_hz, q }  => lowpass_filter(sample_rate, cutoff_hz, q),
+            Self::HighPass { cutoff_hz, q } => highpass_filter(sample_rate, cutoff_hz, q),
+            Self::Notch { center_hz, q }    => notch_filter(sample_rate, center_hz, q),
+        }?;
+        let glide_frames = (sample_rate as u64 * FILTER_GLIDE_MILLIS / 1000) as usize;
+        Some(filter.with_glide(glide_frames))
+    }
+}
+
+/// Build one [`Effects`] chain per output channel from `specs`.
+///
+/// Runs on the control thread; the result is published to the callback via
+/// [`crate::chain_exchange::ChainExchange::publish`].  The convolver is not
+/// part of these chains (see [`crate::chain_exchange`]).
+pub fn build_channel_chains(specs: &[FilterSpec], sample_rate: u32, channels: usize) -> Vec<Effects> {
+    (0..channels.max(1))
+        .map(|_| {
+            let mut effects = Effects::new();
+            for spec in specs {
+                if let Some(f) = spec.build(sample_rate) {
+                    effects.push(f);
+                }
+            }
+            effects
+        })
+        .collect()
+}
+
 // ── Convenience constructors for the most common biquad types ─────────────────
 
 /// Helper: build a biquad filter and box it, or return `None` on error.
@@ -4,18 +4,19 @@
 ///
 /// * The **device** layer ([`crate::device::DeviceManager`]) — enumerates and
 ///   selects the cpal output device.
-/// * The **decode thread** — pulls packets from a [`crate::source::AudioSource`],
-///   resamples them to the device rate, and pushes interleaved `f32` samples
-///   into the shared queue.
+/// * The **decoder** — a [`DecodeJob`] on the shared
+///   [`crate::decode_pool`] (or a dedicated thread for network sources) pulls
+///   packets from a [`crate::source::AudioSource`], resamples them to the
+///   device rate, and pushes interleaved `f32` samples into the shared queue.
 /// * The **cpal callback** — drains the queue on the audio thread, applies
 ///   per-channel DSP effects, and writes to the hardware buffer.
-/// * The **event channel** — broadcasts [`crate::events::AudioEvent`] to any
-///   number of subscribers (UI, logging, test harness …).
+/// * The **event bus** — a bounded queue of [`crate::events::AudioEvent`]s
+///   (see [`crate::event_bus`]) drained by the FFI layer's event wait.
 ///
 /// # Design contracts
 ///
 /// * The cpal callback is **never blocked**.  All heavy work (disk I/O,
-///   network, decoding) happens on a separate thread feeding a `VecDeque<f32>`
+///   network, decoding) happens off the audio thread, feeding a `VecDeque<f32>`
 ///   with backpressure via [`crate::enums::DECODE_BACKPRESSURE_SLEEP_MS`].
 /// * `AudioEngine` is `Send + Sync` (the cpal `Stream` is kept alive but not
 ///   moved after construction).
@@ -23,20 +24,19 @@
 ///   `AudioEvent::Error`.
 
 use std::fs::File;
-use std::io::{Seek, SeekFrom, Write};
+use std::io::{self, Seek, SeekFrom, Write};
 use std::sync::atomic::{AtomicBool, Ordering};
 use std::sync::{Arc, Mutex};
 use std::thread;
-use std::thread::JoinHandle;
-use std::time::Duration;
+use std::time::{Duration, Instant};
 
 use cpal::traits::{DeviceTrait, StreamTrait};
-use cpal::{BufferSize, SampleFormat, Stream, StreamConfig, StreamError};
+use cpal::{BufferSize, Device, SampleFormat, Stream, StreamConfig, StreamError};
 
 use symphonia::core::audio::{AudioBufferRef, SampleBuffer};
-use symphonia::core::codecs::{DecoderOptions, CODEC_TYPE_NULL};
+use symphonia::core::codecs::{CodecParameters, Decoder, DecoderOptions, CODEC_TYPE_NULL};
 use symphonia::core::errors::Error as SymphoniaError;
-use symphonia::core::formats::FormatOptions;
+use symphonia::core::formats::{FormatOptions, FormatReader, Track};
 use symphonia::core::io::{MediaSourceStream, MediaSourceStreamOptions};
 use symphonia::core::meta::MetadataOptions;
 use symphonia::core::probe::Hint;
@@ -44,20 +44,33 @@ use symphonia::core::probe::Hint;
 use tempfile::tempfile;
 
 use crate::debug;
-use crate::device::DeviceManager;
-use crate::effects::{
-    band_pass_filter, high_shelf_filter, highpass_filter, low_shelf_filter,
-    lowpass_filter, notch_filter, peak_filter,
-};
+use crate::device::{self as devices, DeviceManager};
+use crate::analysis::AnalysisBatch;
+use crate::capture::{CaptureFormat, CaptureSession, MonitorTap};
+use crate::chain_exchange::{ChainExchange, ChainRuntime, ChannelChains, ChannelConvolvers};
+use crate::convolver::{ConvolutionSpec, Convolver};
+use crate::decode_pool::{self, PoolJob, Slice};
+use crate::effects::{build_channel_chains, FilterSpec};
 use crate::enums::{
-    DECODE_BACKPRESSURE_SLEEP_MS, DEFAULT_VISUALIZER_BAR_COUNT, MAX_RATE, MIN_RATE,
+    DECODE_POOL_SLICE_MS, DEFAULT_SAMPLE_BANK_BUDGET_BYTES, DEFAULT_VISUALIZER_BAR_COUNT,
+    EVENT_POSITION_INTERVAL_MS, MAX_RATE, MIN_RATE, OUTPUT_SCRATCH_SAMPLES, VISUALIZER_FFT_SIZE,
 };
 use crate::error::AudioError;
-use crate::events::{event_channel};
+use crate::events::{event_channel, AudioEvent, EventReceiver, EventSender};
 use crate::http_stream::HttpStream;
-use crate::player_state::{PlaybackStatus, PlayerState, ResampleState, SharedPlayback};
+use crate::live_stream::{LiveOptions, LiveStream};
+use crate::metrics::EngineMetrics;
+use crate::mix_matrix::MixMatrix;
+use crate::player_state::{
+    LoadState, PlaybackStatus, PlayerState, ResampleState, SharedPlayback, SourceLoad, StagedSeek,
+};
 use crate::processor::VisualizerProcessor;
+use crate::sample_bank::{SampleBank, SampleVoice};
+use crate::sample_format::{Dither, OutputSample};
+use crate::sample_queue::{QueueStorage, SampleQueue};
+use crate::schedule::{self, Due, FrameClock, ScheduledCommand};
 use crate::source::AudioSource;
+use crate::thread_priority::{PriorityHint, ThreadRole};
 use crate::{error, info, warn};
 
 // ── Internal type aliases ─────────────────────────────────────────────────────
@@ -87,20 +100,69 @@ pub struct AudioEngine {
     // ── Source ────────────────────────────────────────────────────────────
     source: Option<AudioSource>,
 
-    // ── Decode thread ─────────────────────────────────────────────────────
-    decode_thread: Option<JoinHandle<()>>,
+    // ── Decoder ───────────────────────────────────────────────────────────
+    /// Whether a decode job has been started for the current source.
+    decode_active: bool,
+    /// Stop flag of the running decode job.  Each job gets its own flag so a
+    /// stopped job can be abandoned instead of waited for.
     decode_stop:   Arc<AtomicBool>,
 
     // ── Seek / timing ──────────────────────────────────────────────────────
-    source_duration_millis: i32,
-    decode_start_millis:    i32,
+    /// Background probe result (duration) for the current source.
+    source_load:         Arc<Mutex<SourceLoad>>,
+    decode_start_millis: i32,
+    /// Output clock anchor, published by the callback once per block.
+    clock:               Arc<FrameClock>,
 
     // ── Visualizer ────────────────────────────────────────────────────────
     visualizer_processor: VisualizerProcessor,
+    /// Latest FFT window copied out of the ring for the spectrum.  Reused
+    /// so polling the spectrum does not allocate.
+    visualizer_window:    Vec<f32>,
+
+    // ── DSP ───────────────────────────────────────────────────────────────
+    /// User-configured filters, in chain order.  Source of truth for the
+    /// chains published to the callback.
+    filters: Vec<FilterSpec>,
+    /// Impulse response convolved after the filters, if any.  Unlike the
+    /// filters it survives `set_source` / `stop` (room correction and
+    /// reverb are output settings, not per-track ones).
+    convolution: Option<ConvolutionSpec>,
+    /// Lock-free hand-off of rebuilt filter chains to the callback.
+    chain_exchange: Arc<ChainExchange<ChannelChains>>,
+    /// Lock-free hand-off of convolvers; republished only when the impulse
+    /// response changes.
+    convolver_exchange: Arc<ChainExchange<ChannelConvolvers>>,
+    /// Whether integer output formats get TPDF dither.  Read by the callback
+    /// once per block.
+    output_dither: Arc<AtomicBool>,
+
+    // ── Sample bank ───────────────────────────────────────────────────────
+    /// Decoded short sounds, triggered as voices mixed by the callback.
+    sample_bank: SampleBank,
+
+    // ── Capture ───────────────────────────────────────────────────────────
+    /// The running input capture, if any.
+    capture: Option<CaptureSession>,
+
+    // ── Track analysis ─────────────────────────────────────────────────────
+    /// Batch analyses started through the engine; finished ones are pruned
+    /// when the next starts.  Dropping a batch cancels it.
+    analyses:          Vec<AnalysisBatch>,
+    next_analysis_job: u64,
 
     // ── Device watcher ─────────────────────────────────────────────────────
     /// Set to `true` to stop the device watcher thread.
     device_watcher_stop: Arc<AtomicBool>,
+
+    // ── Events ─────────────────────────────────────────────────────────────
+    event_tx: EventSender,
+    /// Kept so the bus has a consumer side; handed out by [`Self::events`].
+    event_rx: EventReceiver,
+
+    // ── Telemetry ──────────────────────────────────────────────────────────
+    /// Lock-free counters shared with the callback and decode job.
+    metrics: Arc<EngineMetrics>,
 }
 
 impl AudioEngine {
@@ -115,23 +177,27 @@ impl AudioEngine {
     /// If `device_name` is `None`, or the named device is not found, the
     /// system default is used.
     pub fn with_device(device_name: Option<String>) -> Result<Self, String> {
-        let manager = DeviceManager::new();
-        let device  = manager
-            .resolve_output(device_name.as_deref())
-            .or_else(|_| manager.resolve_output(None))
-            .map_err(|e| e.to_string())?;
-
-        let config = device
-            .default_output_config()
-            .map_err(|e| AudioError::from(e).to_string())?;
-
-        let out_channels    = config.channels() as usize;
-        // cpal 0.17: SupportedStreamConfig::sample_rate() returns u32.
-        let out_sample_rate: u32 = config.sample_rate();
+        let (out_channels, out_sample_rate) = match device_name.as_deref() {
+            None => {
+                let format = devices::cached_default_output_format()
+                    .map_err(|e| e.to_string())?;
+                (format.channels as usize, format.sample_rate)
+            }
+            Some(name) => {
+                let manager = DeviceManager::new();
+                let device  = manager
+                    .resolve_output(Some(name))
+                    .or_else(|_| manager.resolve_output(None))
+                    .map_err(|e| e.to_string())?;
+                let config = device
+                    .default_output_config()
+                    .map_err(|e| AudioError::from(e).to_string())?;
+                // cpal 0.17: SupportedStreamConfig::sample_rate() returns u32.
+                (config.channels() as usize, config.sample_rate())
+            }
+        };
 
-        let (event_tx, _event_rx) = event_channel();
-        // Note: the initial receiver is not used by the engine. Consumers can
-        // call `event_sender().subscribe()` to get their own receiver stream.
+        let (event_tx, event_rx) = event_channel();
 
         // Start the device watcher in the background.
         let device_watcher_stop =
@@ -148,12 +214,26 @@ impl AudioEngine {
             out_sample_rate,
             preferred_device:        device_name,
             source:                  None,
-            decode_thread:           None,
+            decode_active:           false,
             decode_stop:             Arc::new(AtomicBool::new(false)),
-            source_duration_millis:  -1,
+            source_load:             Arc::new(Mutex::new(SourceLoad::new())),
             decode_start_millis:     0,
+            clock:                   Arc::new(FrameClock::new()),
             visualizer_processor:    VisualizerProcessor::new(DEFAULT_VISUALIZER_BAR_COUNT),
+            visualizer_window:       vec![0.0; VISUALIZER_FFT_SIZE * out_channels.max(1)],
+            filters:                 Vec::new(),
+            convolution:             None,
+            chain_exchange:          Arc::new(ChainExchange::new()),
+            convolver_exchange:      Arc::new(ChainExchange::new()),
+            output_dither:           Arc::new(AtomicBool::new(true)),
+            sample_bank:             SampleBank::new(DEFAULT_SAMPLE_BANK_BUDGET_BYTES),
+            capture:                 None,
+            analyses:                Vec::new(),
+            next_analysis_job:       1,
             device_watcher_stop,
+            event_tx,
+            event_rx,
+            metrics:                 Arc::new(EngineMetrics::new()),
         })
     }
 
@@ -175,20 +255,40 @@ impl AudioEngine {
             .or_else(|_| manager.resolve_output(None))
             .map_err(|e| e.to_string())?;
 
-        let output_config = device
-            .default_output_config()
-            .map_err(|e| AudioError::from(e).to_string())?;
+        // The default device's format is cached process-wide; only a named
+        // device is queried here.
+        let format = match self.preferred_device {
+            None => devices::cached_default_output_format().map_err(|e| e.to_string())?,
+            Some(_) => {
+                let config = device
+                    .default_output_config()
+                    .map_err(|e| AudioError::from(e).to_string())?;
+                // cpal 0.17: SupportedStreamConfig::sample_rate() returns u32 directly.
+                devices::OutputFormat {
+                    sample_rate:   config.sample_rate(),
+                    channels:      config.channels(),
+                    sample_format: config.sample_format(),
+                }
+            }
+        };
 
-        let sample_format = output_config.sample_format();
-        // cpal 0.17: SupportedStreamConfig::sample_rate() returns u32 directly.
+        let sample_format = format.sample_format;
         let stream_config = StreamConfig {
-            channels:    output_config.channels(),
-            sample_rate: output_config.sample_rate(),
+            channels:    format.channels,
+            sample_rate: format.sample_rate,
             buffer_size: BufferSize::Default,
         };
 
-        let shared   = Arc::clone(&self.shared);
-        let channels = self.out_channels;
+        let output = OutputContext {
+            shared:   Arc::clone(&self.shared),
+            metrics:  Arc::clone(&self.metrics),
+            exchange: Arc::clone(&self.chain_exchange),
+            convolver_exchange: Arc::clone(&self.convolver_exchange),
+            dither:   Arc::clone(&self.output_dither),
+            clock:    Arc::clone(&self.clock),
+            events:   self.event_tx.clone(),
+            channels: self.out_channels,
+        };
 
         let err_fn = {
             move |err: StreamError| {
@@ -200,48 +300,25 @@ impl AudioEngine {
             }
         };
 
+        debug!("Output sample format: {sample_format:?}");
+        let config = &stream_config;
         let stream = match sample_format {
-            SampleFormat::F32 =>
-                device.build_output_stream(
-                    &stream_config,
-                    {
-                        let shared = Arc::clone(&shared);
-                        move |data: &mut [f32], _: &cpal::OutputCallbackInfo| {
-                            write_output_f32(data, channels, &shared);
-                        }
-                    },
-                    err_fn,
-                    None,
-                ).map_err(|e| AudioError::from(e).to_string())?,
-
-            SampleFormat::I16 =>
-                device.build_output_stream(
-                    &stream_config,
-                    {
-                        let shared = Arc::clone(&shared);
-                        move |data: &mut [i16], _: &cpal::OutputCallbackInfo| {
-                            write_output_i16(data, channels, &shared);
-                        }
-                    },
-                    err_fn,
-                    None,
-                ).map_err(|e| AudioError::from(e).to_string())?,
-
-            SampleFormat::U16 =>
-                device.build_output_stream(
-                    &stream_config,
-                    {
-                        let shared = Arc::clone(&shared);
-                        move |data: &mut [u16], _: &cpal::OutputCallbackInfo| {
-                            write_output_u16(data, channels, &shared);
-                        }
-                    },
-                    err_fn,
-                    None,
-                ).map_err(|e| AudioError::from(e).to_string())?,
-
-            _ => return Err("Unsupported sample format".to_string()),
+            SampleFormat::F32 => build_output::<f32, _>(&device, config, output, err_fn),
+            SampleFormat::F64 => build_output::<f64, _>(&device, config, output, err_fn),
+            SampleFormat::I8  => build_output::<i8, _>(&device, config, output, err_fn),
+            SampleFormat::I16 => build_output::<i16, _>(&device, config, output, err_fn),
+            SampleFormat::I24 => build_output::<cpal::I24, _>(&device, config, output, err_fn),
+            SampleFormat::I32 => build_output::<i32, _>(&device, config, output, err_fn),
+            SampleFormat::I64 => build_output::<i64, _>(&device, config, output, err_fn),
+            SampleFormat::U8  => build_output::<u8, _>(&device, config, output, err_fn),
+            SampleFormat::U16 => build_output::<u16, _>(&device, config, output, err_fn),
+            SampleFormat::U32 => build_output::<u32, _>(&device, config, output, err_fn),
+            SampleFormat::U64 => build_output::<u64, _>(&device, config, output, err_fn),
+            _ => Err("Unsupported sample format".to_string()),
         };
+        // A stale cached format is the likeliest cause of a build failure;
+        // make the retry (from `revise_stream`) query the host again.
+        let stream = stream.inspect_err(|_| devices::invalidate_device_cache())?;
 
         stream
             .play()
@@ -249,6 +326,9 @@ impl AudioEngine {
 
         self.audio_stream  = Some(stream);
         self.stream_started = true;
+        // The new callback starts with bypass chains; hand it the current set.
+        self.publish_effects();
+        self.publish_convolution();
         Ok(())
     }
 
@@ -256,7 +336,7 @@ impl AudioEngine {
     /// unrecoverable stream error (device disconnected, etc.).
     pub fn reset_stream(&mut self) -> Result<(), String> {
         self.stream_started = false;
-        self.stop_decode_thread();
+        self.stop_decoder();
         if let Ok(mut s) = self.shared.lock() {
             s.stream_finished = false;
             s.playing         = false;
@@ -264,7 +344,7 @@ impl AudioEngine {
             s.visualizer_ring.clear();
         }
         self.ensure_stream()?;
-        self.start_decode_thread_if_needed()?;
+        self.start_decoder_if_needed()?;
         self.set_playing(true);
         Ok(())
     }
@@ -272,42 +352,61 @@ impl AudioEngine {
     // ── Source management ─────────────────────────────────────────────────
 
     /// Load a new audio source, stopping any currently playing source.
+    ///
+    /// Returns immediately: the source is opened, probed and pre-buffered on
+    /// the decode thread, so a slow URL never blocks the caller.  The
+    /// duration becomes available once [`AudioEvent::SourceLoaded`] is sent
+    /// (see also [`Self::source_load_state`]).
     pub fn set_source(&mut self, source: AudioSource) {
+        let started = Instant::now();
         info!("Set source: {}", source.description());
-        self.source_duration_millis =
-            estimate_duration_millis(&source, self.out_channels as u32);
+        if let Ok(mut load) = self.source_load.lock() {
+            load.begin();
+        }
         self.decode_start_millis = 0;
-        self.source              = Some(source.clone());
-        self.stop_decode_thread();
+        self.source              = Some(source);
+        self.stop_decoder();
         if let Ok(mut s) = self.shared.lock() {
             s.clear_audio_state();
             s.stream_finished = false;
             s.status          = PlaybackStatus::Idle;
         }
+        self.clear_filters();
         self.visualizer_processor.reset();
+
+        if let Err(e) = self.start_decoder() {
+            error!("{e}");
+        }
+        self.metrics.set_source_us.record_micros(started.elapsed());
     }
 
     // ── Playback control ──────────────────────────────────────────────────
 
     pub fn set_playing(&mut self, playing: bool) {
-        if let Ok(mut s) = self.shared.lock() {
-            if playing {
-                s.stream_finished = false;
-                s.status          = PlaybackStatus::Playing;
-            } else {
-                s.status = PlaybackStatus::Paused;
-            }
-            s.playing = playing;
+        if let Some(event) = self.apply_playing(playing) {
+            let _ = self.event_tx.send(event);
+        }
+    }
+
+    /// Update the playing flag and status; returns the lifecycle event the
+    /// transition implies, if any.
+    fn apply_playing(&mut self, playing: bool) -> Option<AudioEvent> {
+        let mut s = self.shared.lock().ok()?;
+        if playing && !s.playing {
+            self.metrics.mark_startup();
         }
+        s.set_playing(playing)
     }
 
     pub fn stop(&mut self) {
-        self.set_playing(false);
-        self.stop_decode_thread();
+        let _ = self.apply_playing(false);
+        self.stop_decoder();
         if let Ok(mut s) = self.shared.lock() {
             s.clear_audio_state();
             s.status = PlaybackStatus::Idle;
         }
+        let _ = self.event_tx.send(AudioEvent::PlaybackStopped);
+        self.clear_filters();
         self.visualizer_processor.reset();
     }
 
@@ -317,28 +416,50 @@ impl AudioEngine {
         }
     }
 
+    /// Enable or disable TPDF dither on integer output formats.  Takes
+    /// effect from the next callback block.
+    pub fn set_output_dither(&mut self, enabled: bool) {
+        self.output_dither.store(enabled, Ordering::Relaxed);
+    }
+
     pub fn set_max_queue_seconds(&mut self, seconds: usize) {
         if let Ok(mut s) = self.shared.lock() {
             s.set_max_queue_seconds(self.out_channels, seconds);
         }
     }
 
+    /// Store queued samples as `f32` or a compact 16-bit format.  Samples
+    /// already buffered are converted in place.
+    pub fn set_queue_storage(&mut self, storage: QueueStorage) {
+        if let Ok(mut s) = self.shared.lock() {
+            s.set_queue_storage(storage);
+        }
+    }
+
     // ── Seek ──────────────────────────────────────────────────────────────
 
     pub fn seek(&mut self, millis: i32) {
+        let duration = self.duration_millis();
         let mut target = millis.max(0);
-        if self.source_duration_millis > 0 {
-            target = target.min(self.source_duration_millis);
+        if duration > 0 {
+            target = target.min(duration);
         }
 
-        if !matches!(self.source, Some(_)) {
-            warn!("Seek called with no source");
-            return;
+        match &self.source {
+            None => {
+                warn!("Seek called with no source");
+                return;
+            }
+            Some(source) if source.is_live() => {
+                warn!("Live streams cannot seek");
+                return;
+            }
+            Some(_) => {}
         }
 
         let was_playing = self.is_playing() == 1;
 
-        self.stop_decode_thread();
+        self.stop_decoder();
         self.decode_start_millis = target;
 
         let target_samples = ((target as u64)
@@ -356,11 +477,16 @@ impl AudioEngine {
         }
         self.visualizer_processor.reset();
 
-        let can_play = self.source.is_some() && millis < self.source_duration_millis;
+        // Resume unless the source failed to load.  Not compared with the
+        // duration: it stays unknown until the background probe finishes,
+        // and the outcome must not depend on load timing.  A target past the
+        // end simply finishes.
+        let can_play = self.source_load_state() != LoadState::Failed;
 
         if was_playing || can_play {
-            let _ = self.start_decode_thread_if_needed();
+            let _ = self.start_decoder_if_needed();
             self.set_playing(true);
+            self.metrics.mark_seek();
         }
     }
 
@@ -375,7 +501,7 @@ impl AudioEngine {
             s.playback_rate = rate;
         }
 
-        self.stop_decode_thread();
+        self.stop_decoder();
         self.decode_start_millis = current_pos;
 
         let target_samples = ((current_pos as u64)
@@ -394,7 +520,7 @@ impl AudioEngine {
         self.visualizer_processor.reset();
 
         if self.source.is_some() {
-            let _ = self.start_decode_thread_if_needed();
+            let _ = self.start_decoder_if_needed();
             if was_playing {
                 self.set_playing(true);
             }
@@ -405,6 +531,121 @@ impl AudioEngine {
         self.shared.lock().map(|s| s.playback_rate).unwrap_or(1.0)
     }
 
+    // ── Scheduling ────────────────────────────────────────────────────────
+
+    /// Run `command` when output frame `due` is heard (see
+    /// [`crate::schedule`]) and return its id.  Starts the stream so the
+    /// clock runs, and for a scheduled play the decoder, so audio is
+    /// buffered by the time it is due.
+    pub fn schedule(&mut self, command: ScheduledCommand, due: Due) -> Result<u32, String> {
+        self.ensure_stream()?;
+        match command {
+            ScheduledCommand::Seek(millis) => return self.schedule_seek(millis, due),
+            ScheduledCommand::Play => self.start_decoder_if_needed()?,
+            ScheduledCommand::Pause | ScheduledCommand::Volume(_) => {}
+        }
+        let mut s = self.shared.lock().map_err(|_| AudioError::Poisoned.to_string())?;
+        s.schedule.push(command, due)
+    }
+
+    /// Start decoding the seek target into a staged queue now, so the jump
+    /// at `due` is only a buffer swap.  The current job keeps feeding
+    /// playback until then.
+    fn schedule_seek(&mut self, millis: i32, due: Due) -> Result<u32, String> {
+        let source = match &self.source {
+            None => return Err("No source loaded. Call set_source first.".to_string()),
+            Some(source) if source.is_live() => return Err("Live streams cannot seek".to_string()),
+            Some(source) => source.clone(),
+        };
+        let duration = self.duration_millis();
+        let target   = if duration > 0 { millis.min(duration) } else { millis };
+        let position_samples = ((target as u64)
+            .saturating_mul(self.out_sample_rate as u64)
+            .saturating_mul(self.out_channels as u64)
+            / 1000) as f64;
+
+        // Allocate the staged queue before taking the lock the callback needs.
+        let (storage, max_samples) = self
+            .shared
+            .lock()
+            .map(|s| (s.queue.storage(), s.max_samples))
+            .map_err(|_| AudioError::Poisoned.to_string())?;
+        let queue = SampleQueue::new(storage, max_samples);
+
+        let (id, retired) = {
+            let mut s = self.shared.lock().map_err(|_| AudioError::Poisoned.to_string())?;
+            if s.staged.as_ref().is_some_and(|seek| !seek.swapped) {
+                return Err("A scheduled seek is already pending".to_string());
+            }
+            let id = s.schedule.push(ScheduledCommand::Seek(target), due)?;
+            let replaced_stop = std::mem::replace(&mut self.decode_stop, Arc::new(AtomicBool::new(false)));
+            let retired = s.staged.replace(StagedSeek {
+                id,
+                queue,
+                position_samples,
+                finished: false,
+                replaced_stop,
+                swapped:  false,
+            });
+            (id, retired)
+        };
+        drop(retired);
+
+        if let Err(e) = self.spawn_decode_job(source, target, Some(id)) {
+            let _ = self.cancel_scheduled(id);
+            return Err(e);
+        }
+        Ok(id)
+    }
+
+    /// Drop scheduled command `id`.  Cancelling a seek stops its staged
+    /// decode; playback carries on from the live queue.
+    pub fn cancel_scheduled(&mut self, id: u32) -> Result<(), String> {
+        let staged = {
+            let mut s = self.shared.lock().map_err(|_| AudioError::Poisoned.to_string())?;
+            if s.schedule.cancel(id).is_none() {
+                return Err(format!("No scheduled command {id}"));
+            }
+            s.unstage(Some(id))
+        };
+        if let Some(seek) = staged {
+            self.restore_replaced(seek);
+        }
+        Ok(())
+    }
+
+    /// Drop every scheduled command.
+    pub fn clear_schedule(&mut self) -> Result<(), String> {
+        let staged = {
+            let mut s = self.shared.lock().map_err(|_| AudioError::Poisoned.to_string())?;
+            s.schedule.clear();
+            s.unstage(None)
+        };
+        if let Some(seek) = staged {
+            self.restore_replaced(seek);
+        }
+        Ok(())
+    }
+
+    /// Stop the job of a seek that never fired and hand `decode_stop` back
+    /// to the job it would have replaced.
+    fn restore_replaced(&mut self, seek: StagedSeek) {
+        self.decode_stop.store(true, Ordering::SeqCst);
+        self.decode_stop = seek.replaced_stop;
+    }
+
+    /// Output frame heard at host time `host_ns`, or `None` until the
+    /// first callback has run.
+    pub fn clock_frame_at(&self, host_ns: u64) -> Option<i64> {
+        self.clock.anchor().map(|anchor| anchor.frame_at(host_ns))
+    }
+
+    /// Host time at which output frame `frame` is heard, or `None` until
+    /// the first callback has run.
+    pub fn clock_host_ns_at(&self, frame: i64) -> Option<i64> {
+        self.clock.anchor().map(|anchor| anchor.host_ns_at(frame))
+    }
+
     // ── Position / duration ───────────────────────────────────────────────
 
     pub fn position_millis(&self) -> i32 {
@@ -415,13 +656,23 @@ impl AudioEngine {
     }
 
     pub fn duration_millis(&self) -> i32 {
-        self.source_duration_millis
+        self.source_load.lock().map(|l| l.duration_millis).unwrap_or(-1)
+    }
+
+    /// Progress of the background load started by the last `set_source`.
+    pub fn source_load_state(&self) -> LoadState {
+        self.source_load.lock().map(|l| l.state).unwrap_or(LoadState::Idle)
     }
 
     pub fn max_queue_seconds(&self) -> i32 {
         self.shared.lock().map(|s| s.max_queue_seconds as i32).unwrap_or(-1)
     }
 
+    /// Bytes allocated for the decoded sample queue.
+    pub fn queue_bytes(&self) -> i64 {
+        self.shared.lock().map(|s| s.queue.allocated_bytes() as i64).unwrap_or(-1)
+    }
+
     pub fn buffered_samples(&self) -> i32 {
         self.shared.lock().map(|s| s.queue.len() as i32).unwrap_or(-1)
     }
@@ -458,11 +709,28 @@ impl AudioEngine {
     /// Replace the effect chain of every output channel with a fresh, empty
     /// chain.
     pub fn clear_filters(&mut self) {
-        if let Ok(mut s) = self.shared.lock() {
-            for e in &mut s.effects {
-                e.clear();
-            }
-        }
+        self.filters.clear();
+        self.publish_effects();
+    }
+
+    /// Rebuild the per-channel chains from `self.filters` and hand them to
+    /// the callback.  All allocation happens here, on the calling thread;
+    /// the callback only swaps a pointer.
+    fn publish_effects(&self) {
+        let chains = build_channel_chains(&self.filters, self.out_sample_rate, self.out_channels);
+        self.chain_exchange.publish(chains);
+    }
+
+    /// Build one convolver per output channel for the current impulse
+    /// response (none when it is cleared) and hand them to the callback.
+    /// Only called when the IR changes, so filter edits never touch the
+    /// convolvers' delay lines.
+    fn publish_convolution(&self) {
+        let convolvers = match &self.convolution {
+            Some(spec) => (0..self.out_channels.max(1)).map(|c| Convolver::new(spec, c)).collect(),
+            None => Vec::new(),
+        };
+        self.convolver_exchange.publish(convolvers);
     }
 
     /// Validate that filter parameters are sensible before creating
@@ -470,10 +738,7 @@ impl AudioEngine {
     /// and logs a warning (but still returns `0`) if the filter should be
     /// disabled by the caller.
     pub fn filter_check(&self, cutoff_hz: f32, q: f32) -> i8 {
-        let fs = match self.shared.lock() {
-            Ok(g) => g.sample_rate as f32,
-            Err(_) => { error!("Failed to acquire lock for filter check"); return -1; }
-        };
+        let fs = self.out_sample_rate as f32;
         if q <= 0.0 {
             error!("Invalid filter Q: {q}. Must be > 0.");
             return -1;
@@ -492,59 +757,249 @@ impl AudioEngine {
 
     // ── Generic helper: replace the named filter in every channel's chain ──
 
-    /// Remove any existing filter with `old_name` from every channel's chain,
-    /// then push `new_filter` (if `Some`) to the end.
+    /// Remove any existing filter with the same label as `spec`, then append
+    /// `spec` (if it produces valid coefficients) and republish the chain.
     ///
     /// This provides an idempotent "set" semantic: calling with the same
-    /// parameters twice does not double-apply the effect.
-    fn set_filter_named<F>(&mut self, old_name: &'static str, make: F)
-    where
-        F: Fn(u32) -> Option<crate::effects::BiquadFilter>,
-    {
-        if let Ok(mut s) = self.shared.lock() {
-            let sample_rate = s.sample_rate;
-            for effect in &mut s.effects {
-                effect.remove_named(old_name);
-                if let Some(f) = make(sample_rate) {
-                    effect.push(f);
-                }
-            }
+    /// parameters twice does not double-apply the effect.  The replacement
+    /// inherits the old filter's state and glides to the new coefficients.
+    fn set_filter(&mut self, spec: FilterSpec) {
+        let label = spec.label();
+        self.filters.retain(|f| f.label() != label);
+        if spec.build(self.out_sample_rate).is_some() {
+            self.filters.push(spec);
         }
+        self.publish_effects();
     }
 
-    pub fn set_peak_filter(&mut self, cutoff_hz: f32, gain_db: f32, q: f32) {
-        if self.filter_check(cutoff_hz, q) != 0 { return; }
-        self.set_filter_named("PeakEQ", move |sr| peak_filter(sr, cutoff_hz, gain_db, q));
+    pub fn set_peak_filter(&mut self, center_hz: f32, gain_db: f32, q: f32) {
+        if self.filter_check(center_hz, q) != 0 { return; }
+        self.set_filter(FilterSpec::Peak { center_hz, gain_db, q });
     }
 
     pub fn set_low_shelf_filter(&mut self, cutoff_hz: f32, gain_db: f32, q: f32) {
         if self.filter_check(cutoff_hz, q) != 0 { return; }
-        self.set_filter_named("LowShelf", move |sr| low_shelf_filter(sr, cutoff_hz, gain_db, q));
+        self.set_filter(FilterSpec::LowShelf { cutoff_hz, gain_db, q });
     }
 
     pub fn set_high_shelf_filter(&mut self, cutoff_hz: f32, gain_db: f32, q: f32) {
         if self.filter_check(cutoff_hz, q) != 0 { return; }
-        self.set_filter_named("HighShelf", move |sr| high_shelf_filter(sr, cutoff_hz, gain_db, q));
+        self.set_filter(FilterSpec::HighShelf { cutoff_hz, gain_db, q });
     }
 
     pub fn set_band_pass_filter(&mut self, center_hz: f32, q: f32) {
         if self.filter_check(center_hz, q) != 0 { return; }
-        self.set_filter_named("BandPass", move |sr| band_pass_filter(sr, center_hz, q));
+        self.set_filter(FilterSpec::BandPass { center_hz, q });
     }
 
     pub fn set_lowpass_filter(&mut self, cutoff_hz: f32, q: f32) {
         if self.filter_check(cutoff_hz, q) != 0 { return; }
-        self.set_filter_named("LowPass", move |sr| lowpass_filter(sr, cutoff_hz, q));
+        self.set_filter(FilterSpec::LowPass { cutoff_hz, q });
     }
 
     pub fn set_high_pass_filter(&mut self, cutoff_hz: f32, q: f32) {
         if self.filter_check(cutoff_hz, q) != 0 { return; }
-        self.set_filter_named("HighPass", move |sr| highpass_filter(sr, cutoff_hz, q));
+        self.set_filter(FilterSpec::HighPass { cutoff_hz, q });
     }
 
-    pub fn set_notch_filter(&mut self, cutoff_hz: f32, q: f32) {
-        if self.filter_check(cutoff_hz, q) != 0 { return; }
-        self.set_filter_named("Notch", move |sr| notch_filter(sr, cutoff_hz, q));
+    pub fn set_notch_filter(&mut self, center_hz: f32, q: f32) {
+        if self.filter_check(center_hz, q) != 0 { return; }
+        self.set_filter(FilterSpec::Notch { center_hz, q });
+    }
+
+    // ── Convolution ───────────────────────────────────────────────────────
+
+    /// Convolve the output with a prepared impulse response.  The IR must be
+    /// built for the output format (see [`Self::output_format`]).
+    pub fn set_convolution(&mut self, spec: ConvolutionSpec) {
+        info!(
+            "Convolution IR: {} taps × {} channels",
+            spec.ir.len_frames(),
+            spec.ir.channels()
+        );
+        self.convolution = Some(spec);
+        self.publish_convolution();
+    }
+
+    /// Change the wet/dry mix of the current impulse response without
+    /// reloading or rebuilding it.  The callback picks the new gains up on
+    /// its next block.
+    pub fn set_convolution_mix(&mut self, wet: f32, dry: f32) -> Result<(), String> {
+        let spec = self
+            .convolution
+            .as_ref()
+            .ok_or_else(|| "No impulse response loaded".to_string())?;
+        spec.mix.set(wet, dry);
+        Ok(())
+    }
+
+    pub fn clear_convolution(&mut self) {
+        self.convolution = None;
+        self.publish_convolution();
+    }
+
+    // ── Sample bank ───────────────────────────────────────────────────────
+
+    /// Output `(channels, sample_rate)`; sounds must be decoded to this
+    /// format before [`Self::insert_sample`].
+    pub fn output_format(&self) -> (usize, u32) {
+        (self.out_channels, self.out_sample_rate)
+    }
+
+    /// Largest decoded sound (in samples) the bank can hold.
+    pub fn sample_bank_max_samples(&self) -> usize {
+        self.sample_bank.max_samples()
+    }
+
+    /// Cache a sound decoded by [`decode_source_to_output`] under `key`.
+    pub fn insert_sample(&mut self, key: String, pcm: Vec<f32>) -> Result<(), String> {
+        self.sample_bank.insert(key, pcm)
+    }
+
+    /// Play the sound cached under `key` on top of the current source.
+    /// Starts the output stream if needed; audible from the next callback.
+    pub fn play_sample(&mut self, key: &str, gain: f32) -> Result<(), String> {
+        let pcm = self
+            .sample_bank
+            .get(key)
+            .ok_or_else(|| format!("No sample cached under '{key}'"))?;
+        self.ensure_stream()?;
+        let voice = SampleVoice::new(pcm, gain.clamp(0.0, 4.0));
+        self.shared
+            .lock()
+            .map(|mut s| s.trigger_voice(voice))
+            .map_err(|_| AudioError::Poisoned.to_string())
+    }
+
+    pub fn unload_sample(&mut self, key: &str) -> bool {
+        self.sample_bank.remove(key)
+    }
+
+    pub fn clear_sample_bank(&mut self) {
+        self.sample_bank.clear();
+    }
+
+    pub fn set_sample_bank_budget(&mut self, bytes: usize) {
+        self.sample_bank.set_budget(bytes);
+    }
+
+    pub fn sample_bank_bytes(&self) -> usize {
+        self.sample_bank.used_bytes()
+    }
+
+    // ── Capture ───────────────────────────────────────────────────────────
+
+    /// Record `device_name` (or the default input) to a WAV file at `path`,
+    /// replacing any running capture.  With `monitor`, the input is also
+    /// played through the effect chains.
+    pub fn start_capture(
+        &mut self,
+        path:        &str,
+        device_name: Option<&str>,
+        format:      CaptureFormat,
+        monitor:     bool,
+    ) -> Result<(), String> {
+        self.stop_capture()?;
+        let session = CaptureSession::start(
+            path,
+            device_name,
+            format,
+            self.out_channels,
+            self.out_sample_rate,
+            self.event_tx.clone(),
+        )?;
+        self.capture = Some(session);
+        if monitor {
+            self.set_capture_monitor(true)?;
+        }
+        Ok(())
+    }
+
+    /// Stop the running capture and finalise its file.  A no-op when
+    /// nothing is being captured.
+    pub fn stop_capture(&mut self) -> Result<(), String> {
+        let Some(session) = self.capture.take() else { return Ok(()); };
+        if let Ok(mut s) = self.shared.lock() {
+            s.monitor = None;
+        }
+        session.finish()
+    }
+
+    /// Start or stop playing the captured input through the output.
+    pub fn set_capture_monitor(&mut self, enabled: bool) -> Result<(), String> {
+        let session = self.capture.as_ref().ok_or("No capture is running")?;
+        session.set_monitoring(enabled)?;
+        let tap = session.monitor_tap().filter(|_| enabled).cloned();
+        if let Ok(mut s) = self.shared.lock() {
+            s.monitor = tap;
+        }
+        if enabled {
+            self.ensure_stream()?;
+        }
+        Ok(())
+    }
+
+    /// Input frames the running capture has dropped, or -1 when idle.
+    pub fn capture_dropped_frames(&self) -> i64 {
+        self.capture.as_ref().map_or(-1, |c| c.dropped_frames() as i64)
+    }
+
+    pub fn capture_stats_json(&self) -> Option<String> {
+        self.capture.as_ref().map(CaptureSession::stats_json)
+    }
+
+    // ── Track analysis ────────────────────────────────────────────────────
+
+    /// Analyse `paths` in the background on up to `threads` threads (0 = one
+    /// per core).  Progress and results arrive as `Analysis*` events tagged
+    /// with the returned job id.
+    pub fn start_analysis(&mut self, paths: Vec<String>, threads: usize) -> Result<u64, String> {
+        self.analyses.retain(|batch| !batch.is_finished());
+        let job = self.next_analysis_job;
+        let batch = AnalysisBatch::start(job, paths, threads, self.event_tx.clone())?;
+        self.next_analysis_job += 1;
+        self.analyses.push(batch);
+        Ok(job)
+    }
+
+    /// Cancel a batch.  Tracks being analysed end with an error result.
+    pub fn cancel_analysis(&mut self, job: u64) -> Result<(), String> {
+        let index = self
+            .analyses
+            .iter()
+            .position(|batch| batch.job == job)
+            .ok_or_else(|| format!("No analysis job {job}"))?;
+        // Dropping the batch cancels it; its finished event still follows.
+        self.analyses.swap_remove(index);
+        Ok(())
+    }
+
+    // ── Events ────────────────────────────────────────────────────────────
+
+    /// A consumer handle on the engine's event bus.  Receivers share one
+    /// stream: each event goes to whichever receiver takes it first.
+    pub fn events(&self) -> EventReceiver {
+        self.event_rx.clone()
+    }
+
+    // ── Telemetry ─────────────────────────────────────────────────────────
+
+    /// Render the current metrics snapshot as JSON.
+    pub fn metrics_json(&self) -> String {
+        self.metrics.snapshot_json(self.underrun_count().max(0) as u32)
+    }
+
+    /// Export the recent callback history as a Chrome trace-event file.
+    pub fn write_metrics_trace(&self, path: &str) -> Result<(), String> {
+        self.metrics.write_trace(path)
+    }
+
+    pub fn reset_metrics(&self) {
+        self.metrics.reset();
+    }
+
+    pub fn underrun_count(&self) -> i32 {
+        self.shared.lock().map(|s| s.underrun_count as i32).unwrap_or(-1)
     }
 
     // ── Visualizer ────────────────────────────────────────────────────────
@@ -563,16 +1018,21 @@ impl AudioEngine {
             .unwrap_or(-1)
     }
 
+    /// Only the last FFT window of the ring is copied; the processor
+    /// ignores anything older.
     pub fn copy_visualizer_spectrum(&mut self, out: &mut [f32]) -> i32 {
-        let (snapshot, playing) = match self.shared.lock() {
-            Ok(s) => (
-                s.visualizer_ring.iter().copied().collect::<Vec<f32>>(),
-                s.playing,
-            ),
+        self.visualizer_window.resize(VISUALIZER_FFT_SIZE * self.out_channels.max(1), 0.0);
+        let (copied, playing) = match self.shared.lock() {
+            Ok(s) => (s.copy_latest_visualizer_samples(&mut self.visualizer_window), s.playing),
             Err(_) => return -1,
         };
-        self.visualizer_processor
-            .compute(&snapshot, self.out_channels, self.out_sample_rate, out, playing)
+        self.visualizer_processor.compute(
+            &self.visualizer_window[..copied],
+            self.out_channels,
+            self.out_sample_rate,
+            out,
+            playing,
+        )
     }
 
     // ── Metadata / thumbnail ──────────────────────────────────────────────
@@ -639,78 +1099,123 @@ impl AudioEngine {
         Ok(Vec::new())
     }
 
-    // ── Decode thread management ──────────────────────────────────────────
+    // ── Decoder management ────────────────────────────────────────────────
 
-    /// Start the decode thread unless one is already running.
-    pub fn start_decode_thread_if_needed(&mut self) -> Result<(), String> {
-        if self.decode_thread.is_some() {
+    /// Start decoding the current source unless a job is already running.
+    pub fn start_decoder_if_needed(&mut self) -> Result<(), String> {
+        if self.decode_active {
             return Ok(());
         }
+        self.start_decoder()
+    }
 
+    /// Submit a decode job for the current source.
+    ///
+    /// Local and in-memory sources go to the shared decode pool.  Network
+    /// sources can block inside a read for seconds, so they get a dedicated
+    /// thread instead of tying up a pool worker.
+    fn start_decoder(&mut self) -> Result<(), String> {
         let source = self
             .source
             .clone()
             .ok_or_else(|| "No source loaded. Call set_source first.".to_string())?;
 
-        self.decode_stop.store(false, Ordering::SeqCst);
-        let stop_flag       = Arc::clone(&self.decode_stop);
-        let shared          = Arc::clone(&self.shared);
-        let out_channels    = self.out_channels;
-        let out_sample_rate = self.out_sample_rate;
-        let start_millis    = self.decode_start_millis;
+        self.decode_stop = Arc::new(AtomicBool::new(false));
+        // A live stream reconnects at its live point; there is nothing to skip.
+        let start_millis = if source.is_live() { 0 } else { self.decode_start_millis };
 
         if let Ok(mut s) = self.shared.lock() {
             s.stream_finished = false;
         }
+        self.spawn_decode_job(source, start_millis, None)
+    }
 
-        let handle = thread::spawn(move || {
-            if let Err(err) = decode_and_feed(
-                source,
-                stop_flag,
-                shared,
-                out_channels,
-                out_sample_rate,
-                start_millis,
-            ) {
-                error!("Decode thread ended with error: {err}");
-            }
-        });
-
-        self.decode_thread = Some(handle);
+    /// Run a job decoding `source` from `start_millis` under the current
+    /// `decode_stop` flag, into the queue of staged seek `staged` or, when
+    /// `None`, the live queue.  While the source is still loading the job
+    /// also reports its probed format.
+    fn spawn_decode_job(
+        &mut self,
+        source:       AudioSource,
+        start_millis: i32,
+        staged:       Option<u32>,
+    ) -> Result<(), String> {
+        let dedicated = source.is_remote();
+        let job = Box::new(DecodeJob::new(
+            source,
+            Arc::clone(&self.decode_stop),
+            Arc::clone(&self.shared),
+            Arc::clone(&self.metrics),
+            self.event_tx.clone(),
+            self.pending_load_report(),
+            self.out_channels,
+            self.out_sample_rate,
+            start_millis,
+            staged,
+        ));
+
+        if dedicated {
+            thread::Builder::new()
+                .name("audiopc-decode-net".into())
+                .spawn(move || decode_pool::run_dedicated(job))
+                .map_err(|e| format!("Failed to spawn decode thread: {e}"))?;
+        } else {
+            decode_pool::submit(job);
+        }
+        self.decode_active = true;
         Ok(())
     }
 
-    /// Signal the decode thread to stop and block until it exits.
-    pub fn stop_decode_thread(&mut self) {
+    /// A report for the current source while it is still loading.
+    ///
+    /// A job stopped before it opened the source (by a seek or rate change
+    /// right after `set_source`) never resolves its report, so every job
+    /// started during the load carries one; [`SourceLoad::resolve`] lets
+    /// only the first to open the source publish it.
+    fn pending_load_report(&self) -> Option<LoadReport> {
+        let load = self.source_load.lock().ok()?;
+        (load.state == LoadState::Loading).then(|| LoadReport {
+            generation: load.generation,
+            load:       Arc::clone(&self.source_load),
+            events:     self.event_tx.clone(),
+            requested:  load.requested,
+        })
+    }
+
+    /// Signal the decode job to stop without waiting for it.
+    ///
+    /// The job may be blocked opening a slow URL, so waiting here would
+    /// stall the caller.  A stopped job checks its own flag under the
+    /// `SharedPlayback` lock before every write, so once signalled it never
+    /// touches the queue again, even if it outlives a newly started job.
+    ///
+    /// A pending scheduled seek is dropped too: its staged job runs under
+    /// `decode_stop`, and the job it was going to replace under its own flag.
+    pub fn stop_decoder(&mut self) {
         self.decode_stop.store(true, Ordering::SeqCst);
-        if let Some(handle) = self.decode_thread.take() {
-            let _ = handle.join();
+        self.decode_active = false;
+        let staged = self.shared.lock().ok().map(|mut s| (s.unstage(None), s.take_retired()));
+        if let Some((Some(seek), _)) = &staged {
+            seek.replaced_stop.store(true, Ordering::SeqCst);
         }
-        self.decode_stop.store(false, Ordering::SeqCst);
     }
 
     // ── Device info forwarding ────────────────────────────────────────────
 
     pub fn default_output_sample_rate() -> i32 {
-        use cpal::traits::HostTrait;
-        cpal::default_host()
-            .default_output_device()
-            .and_then(|d: cpal::Device| d.default_output_config().ok())
-            .map(|c: cpal::SupportedStreamConfig| c.sample_rate() as i32)
+        devices::cached_default_output_format()
+            .map(|f| f.sample_rate as i32)
             .unwrap_or(-1)
     }
 
     pub fn default_output_channels() -> i32 {
-        use cpal::traits::HostTrait;
-        cpal::default_host()
-            .default_output_device()
-            .and_then(|d: cpal::Device| d.default_output_config().ok())
-            .map(|c: cpal::SupportedStreamConfig| i32::from(c.channels()))
+        devices::cached_default_output_format()
+            .map(|f| i32::from(f.channels))
             .unwrap_or(-1)
     }
 
     pub fn output_device_count() -> i32 {
-        DeviceManager::new().output_devices().len() as i32
+        devices::cached_output_device_count() as i32
     }
 }
 
@@ -736,7 +1241,13 @@ fn open_media_source(path: &str) -> Result<BoxedMediaSource, String> {
 }
 
 /// Build a `BoxedMediaSource` from an owned [`AudioSource`].
-fn media_source_from_owned(source: AudioSource) -> Result<BoxedMediaSource, String> {
+///
+/// Live sources need `live` (the decode thread's event sender and stop
+/// flag); they cannot be opened for one-shot decoding.
+fn media_source_from_owned(
+    source: AudioSource,
+    live:   Option<LiveOptions>,
+) -> Result<BoxedMediaSource, String> {
     match source {
         AudioSource::Path(p) => {
             let f = File::open(&p)
@@ -747,28 +1258,12 @@ fn media_source_from_owned(source: AudioSource) -> Result<BoxedMediaSource, Stri
             let s = HttpStream::new(&u)?;
             Ok(Box::new(s))
         }
-        AudioSource::Memory(data) => {
-            let f = write_bytes_to_temp_file(&data, "memory")?;
-            Ok(Box::new(f))
-        }
-    }
-}
-
-/// Build a `BoxedMediaSource` from a reference, avoiding cloning large
-/// in-memory payloads (re-opens the file / connection instead).
-fn media_source_from_ref(source: &AudioSource) -> Result<BoxedMediaSource, String> {
-    match source {
-        AudioSource::Path(p) => {
-            let f = File::open(p)
-                .map_err(|e| format!("Failed to open source for duration: {e}"))?;
-            Ok(Box::new(f))
-        }
-        AudioSource::Url(u) => {
-            let s = HttpStream::new(u)?;
-            Ok(Box::new(s))
+        AudioSource::Live(u) => {
+            let options = live.ok_or("Live streams can only be played, not preloaded")?;
+            Ok(Box::new(LiveStream::open(&u, options)?))
         }
         AudioSource::Memory(data) => {
-            let f = write_bytes_to_temp_file(data, "duration_memory")?;
+            let f = write_bytes_to_temp_file(&data, "memory")?;
             Ok(Box::new(f))
         }
     }
@@ -785,57 +1280,64 @@ fn write_bytes_to_temp_file(bytes: &[u8], tag: &str) -> Result<File, String> {
     Ok(file)
 }
 
-/// Probe a source for duration without decoding.
-/// Returns `-1` if the duration cannot be determined.
-fn estimate_duration_millis(source: &AudioSource, _out_channels: u32) -> i32 {
-    let media = match media_source_from_ref(source) {
-        Ok(m) => m,
-        Err(e) => { error!("{e}"); return -1; }
-    };
+// ── Source loading ────────────────────────────────────────────────────────────
 
-    let mss    = MediaSourceStream::new(media, MediaSourceStreamOptions::default());
-    let probed = match symphonia::default::get_probe()
-        .format(&Hint::new(), mss, &FormatOptions::default(), &MetadataOptions::default())
-    {
-        Ok(p) => p,
-        Err(e) => { error!("Failed to probe source for duration: {e}"); return -1; }
-    };
+/// Where the decode thread publishes the probed format of a source passed to
+/// `set_source`.
+struct LoadReport {
+    generation: u64,
+    load:       Arc<Mutex<SourceLoad>>,
+    events:     EventSender,
+    requested:  Instant,
+}
 
-    let track = probed
-        .format
-        .tracks()
-        .iter()
-        .find(|t| t.codec_params.codec != CODEC_TYPE_NULL);
+impl LoadReport {
+    /// Publish the format of the opened track, unless the source has been
+    /// replaced in the meantime.
+    fn ready(self, params: &CodecParameters, metrics: &EngineMetrics) {
+        let duration = match (params.n_frames, params.sample_rate) {
+            (Some(nf), Some(sr)) if sr > 0 => Some(Duration::from_secs_f64(nf as f64 / sr as f64)),
+            _ => None,
+        };
+        let millis = duration.map(|d| d.as_millis() as i32).unwrap_or(-1);
+        if !self.resolve(LoadState::Ready, millis) {
+            return;
+        }
+        metrics.source_load_us.record_micros(self.requested.elapsed());
+        let _ = self.events.send(AudioEvent::SourceLoaded {
+            duration,
+            sample_rate: params.sample_rate,
+            channels:    params.channels.map(|c| c.count()),
+        });
+    }
 
-    let Some(track) = track else { return -1 };
-    let cp = &track.codec_params;
-    if let (Some(nf), Some(sr)) = (cp.n_frames, cp.sample_rate) {
-        ((nf as f64 / sr as f64) * 1000.0) as i32
-    } else {
-        -1
+    /// Mark the load as failed.  The error event is sent by the decode
+    /// thread's caller.
+    fn failed(self) {
+        self.resolve(LoadState::Failed, -1);
+    }
+
+    fn resolve(&self, state: LoadState, millis: i32) -> bool {
+        self.load
+            .lock()
+            .map(|mut l| l.resolve(self.generation, state, millis))
+            .unwrap_or(false)
     }
 }
 
-/// Decode packets from `source`, resample/remix to the output format, and
-/// push interleaved `f32` chunks into `shared.queue`.
-///
-/// Runs on a dedicated background thread; terminates when `stop_flag` is set,
-/// the source is exhausted, or an unrecoverable error occurs.
-fn decode_and_feed(
-    source:          AudioSource,
-    stop_flag:       Arc<AtomicBool>,
-    shared:          Arc<Mutex<SharedPlayback>>,
-    out_channels:    usize,
-    out_sample_rate: u32,
-    start_millis:    i32,
-) -> Result<(), String> {
-    let media  = media_source_from_owned(source)?;
+/// Open `source`, probe its container and build a decoder for the first
+/// decodable track.
+fn open_decoder(
+    source: AudioSource,
+    live:   Option<LiveOptions>,
+) -> Result<(Box<dyn FormatReader>, Track, Box<dyn Decoder>), String> {
+    let media  = media_source_from_owned(source, live)?;
     let mss    = MediaSourceStream::new(media, MediaSourceStreamOptions::default());
     let probed = symphonia::default::get_probe()
         .format(&Hint::new(), mss, &FormatOptions::default(), &MetadataOptions::default())
         .map_err(|e| format!("Failed to probe audio format: {e}"))?;
 
-    let mut format = probed.format;
+    let format = probed.format;
     let track = format
         .tracks()
         .iter()
@@ -843,100 +1345,343 @@ fn decode_and_feed(
         .ok_or("No decodable audio track found")?
         .clone();
 
-    let mut decoder = symphonia::default::get_codecs()
+    let decoder = symphonia::default::get_codecs()
         .make(&track.codec_params, &DecoderOptions::default())
         .map_err(|e| format!("Failed to create decoder: {e}"))?;
 
-    let initial_playback_rate = shared
-        .lock()
-        .map(|s| s.playback_rate.clamp(MIN_RATE, MAX_RATE))
-        .unwrap_or(1.0);
-
-    let mut resample_state = ResampleState::new();
-    let mut skip_output_samples = source_millis_to_output_samples(
-        start_millis,
-        out_sample_rate,
-        out_channels,
-        initial_playback_rate,
-    );
-
-    let decode_result = loop {
-        if stop_flag.load(Ordering::SeqCst) { break Ok(()); }
-
-        let packet = match format.next_packet() {
-            Ok(p) => p,
-            Err(SymphoniaError::ResetRequired) =>
-                break Err("Decoder reset required and not supported".to_string()),
-            Err(SymphoniaError::IoError(_)) => break Ok(()),
-            Err(e) => break Err(format!("Failed to read next packet: {e}")),
+    Ok((format, track, decoder))
+}
+
+/// Pull-style decoder that converts a whole source to a given format one
+/// packet at a time, for work that does not feed the playback queue
+/// (sample bank, impulse responses, track analysis).
+pub struct BlockDecoder {
+    format:          Box<dyn FormatReader>,
+    decoder:         Box<dyn Decoder>,
+    resample_state:  ResampleState,
+    out_channels:    usize,
+    out_sample_rate: u32,
+    /// Length of the track, when the container declares it.
+    pub duration:    Option<Duration>,
+}
+
+impl BlockDecoder {
+    pub fn open(source: AudioSource, out_channels: usize, out_sample_rate: u32) -> Result<Self, String> {
+        let (format, track, decoder) = open_decoder(source, None)?;
+        let duration = match (track.codec_params.n_frames, track.codec_params.sample_rate) {
+            (Some(nf), Some(sr)) if sr > 0 => Some(Duration::from_secs_f64(nf as f64 / sr as f64)),
+            _ => None,
         };
+        Ok(Self {
+            format,
+            decoder,
+            resample_state: ResampleState::new(),
+            out_channels,
+            out_sample_rate,
+            duration,
+        })
+    }
 
-        let decoded = match decoder.decode(&packet) {
-            Ok(b) => b,
-            Err(SymphoniaError::DecodeError(e)) => {
-                warn!("Decode error: {e}. Skipping packet.");
-                continue;
+    /// The next non-empty block of interleaved output, or `None` at the end
+    /// of the stream.
+    pub fn next_block(&mut self) -> Result<Option<Vec<f32>>, String> {
+        loop {
+            let packet = match self.format.next_packet() {
+                Ok(p) => p,
+                Err(SymphoniaError::IoError(_)) => return Ok(None),
+                Err(e) => return Err(format!("Failed to read next packet: {e}")),
+            };
+            let decoded = match self.decoder.decode(&packet) {
+                Ok(b) => b,
+                Err(SymphoniaError::DecodeError(e)) => {
+                    warn!("Decode error: {e}. Skipping packet.");
+                    continue;
+                }
+                Err(SymphoniaError::IoError(_)) => return Ok(None),
+                Err(e) => return Err(format!("Failed to decode packet: {e}")),
+            };
+
+            let (src_ch, src_layout, src_rate, interleaved) = decoded_to_interleaved_f32(decoded);
+            if interleaved.is_empty() || src_ch == 0 || src_rate == 0 { continue; }
+
+            let out = convert_to_output(
+                &interleaved,
+                src_ch,
+                src_layout,
+                src_rate,
+                self.out_channels,
+                self.out_sample_rate,
+                &mut self.resample_state,
+            );
+            if !out.is_empty() {
+                return Ok(Some(out));
             }
-            Err(SymphoniaError::IoError(_)) => break Ok(()),
-            Err(e) => break Err(format!("Failed to decode packet: {e}")),
-        };
+        }
+    }
+}
 
-        let (src_ch, src_rate, interleaved) = decoded_to_interleaved_f32(decoded);
-        if interleaved.is_empty() || src_ch == 0 || src_rate == 0 { continue; }
+/// Decode all of `source` into interleaved `f32` at the output format.
+///
+/// Used to fill the sample bank.  Fails once the result would exceed
+/// `max_samples`, so an oversized file is rejected without decoding it all.
+pub fn decode_source_to_output(
+    source:          AudioSource,
+    out_channels:    usize,
+    out_sample_rate: u32,
+    max_samples:     usize,
+) -> Result<Vec<f32>, String> {
+    let mut blocks = BlockDecoder::open(source, out_channels, out_sample_rate)?;
+    let mut pcm = Vec::new();
+
+    while let Some(block) = blocks.next_block()? {
+        pcm.extend_from_slice(&block);
+        if pcm.len() > max_samples {
+            return Err(format!("Decoded sound exceeds {max_samples} samples"));
+        }
+    }
 
-        if stop_flag.load(Ordering::SeqCst) { break Ok(()); }
+    pcm.shrink_to_fit();
+    Ok(pcm)
+}
 
-        let playback_rate = shared
-            .lock()
-            .map(|s| s.playback_rate.clamp(MIN_RATE, MAX_RATE))
-            .unwrap_or(1.0);
+// ── Decode job ────────────────────────────────────────────────────────────────
+
+/// Decode packets from a source, resample/remix them to the output format,
+/// and push interleaved `f32` into `shared.queue`, one slice at a time.
+///
+/// Opening and probing happen in the first slice, off the caller's thread.
+/// Output that does not fit in the queue is kept in `pending` and pushed by
+/// a later slice, so a job never sleeps on back-pressure itself.  The job
+/// ends when `stop_flag` is set, the source is exhausted, or an
+/// unrecoverable error occurs; a read error other than end of stream is
+/// reported as an error rather than treated as the end of the track.
+struct DecodeJob {
+    source:          Option<AudioSource>,
+    report:          Option<LoadReport>,
+    reader:          Option<(Box<dyn FormatReader>, Box<dyn Decoder>)>,
+    stop_flag:       Arc<AtomicBool>,
+    shared:          Arc<Mutex<SharedPlayback>>,
+    metrics:         Arc<EngineMetrics>,
+    events:          EventSender,
+    out_channels:    usize,
+    out_sample_rate: u32,
+    start_millis:    i32,
+    resample_state:  ResampleState,
+    skip_output_samples: usize,
+    /// Converted output not yet accepted by the queue, from `pending_offset`.
+    pending:         Vec<f32>,
+    pending_offset:  usize,
+    /// When the queue is expected to run dry, from its length at the last
+    /// push.  A job that has pushed nothing yet is due immediately.
+    deadline:        Instant,
+    /// Scheduled seek this job decodes ahead for; `None` once it feeds the
+    /// live queue.
+    staged:          Option<u32>,
+}
 
-        // Scale the target rate to implement speed without pitch shift.
-        let effective_out_rate = ((out_sample_rate as f32) / playback_rate).max(1.0) as u32;
+/// Why a job stopped decoding packets.
+enum Step {
+    /// Output is pending or the slice is used up; yield.
+    Yield(Slice),
+    /// End of job, with the error to report if it failed.
+    End(Result<(), String>),
+}
 
-        let out = convert_to_output(
-            &interleaved,
-            src_ch,
-            src_rate,
+impl DecodeJob {
+    #[allow(clippy::too_many_arguments)]
+    fn new(
+        source:          AudioSource,
+        stop_flag:       Arc<AtomicBool>,
+        shared:          Arc<Mutex<SharedPlayback>>,
+        metrics:         Arc<EngineMetrics>,
+        events:          EventSender,
+        report:          Option<LoadReport>,
+        out_channels:    usize,
+        out_sample_rate: u32,
+        start_millis:    i32,
+        staged:          Option<u32>,
+    ) -> Self {
+        Self {
+            source: Some(source),
+            report,
+            reader: None,
+            stop_flag,
+            shared,
+            metrics,
+            events,
             out_channels,
-            effective_out_rate,
-            &mut resample_state,
-        );
+            out_sample_rate,
+            start_millis,
+            resample_state: ResampleState::new(),
+            skip_output_samples: 0,
+            pending: Vec::new(),
+            pending_offset: 0,
+            deadline: Instant::now(),
+            staged,
+        }
+    }
 
-        if out.is_empty() { continue; }
+    fn stopped(&self) -> bool {
+        self.stop_flag.load(Ordering::SeqCst)
+    }
 
-        let mut start = 0usize;
-        if skip_output_samples > 0 {
-            let consumed = skip_output_samples.min(out.len());
-            skip_output_samples -= consumed;
-            start = consumed;
+    /// Open the source and publish its format.
+    fn open(&mut self) -> Result<(), String> {
+        let Some(source) = self.source.take() else { return Ok(()) };
+        let live = source.is_live().then(|| LiveOptions {
+            events: self.events.clone(),
+            stop:   Arc::clone(&self.stop_flag),
+        });
+        let (format, track, decoder) = match open_decoder(source, live) {
+            Ok(opened) => opened,
+            Err(e) => {
+                if let Some(report) = self.report.take() { report.failed(); }
+                return Err(e);
+            }
+        };
+        if let Some(report) = self.report.take() {
+            report.ready(&track.codec_params, &self.metrics);
         }
-        if start >= out.len() { continue; }
 
-        let out_slice = &out[start..];
-        let mut offset = 0;
+        let initial_playback_rate = self.playback_rate();
+        self.skip_output_samples = source_millis_to_output_samples(
+            self.start_millis,
+            self.out_sample_rate,
+            self.out_channels,
+            initial_playback_rate,
+        );
+        self.reader = Some((format, decoder));
+        Ok(())
+    }
+
+    fn playback_rate(&self) -> f32 {
+        self.shared
+            .lock()
+            .map(|s| s.playback_rate.clamp(MIN_RATE, MAX_RATE))
+            .unwrap_or(1.0)
+    }
 
-        while offset < out_slice.len() {
-            if stop_flag.load(Ordering::SeqCst) { break; }
+    /// Push as much pending output as the queue accepts.  Returns `false`
+    /// while output is still pending.
+    fn flush_pending(&mut self) -> bool {
+        if self.pending_offset >= self.pending.len() {
+            return true;
+        }
+        let lock_started = Instant::now();
+        let (pushed, queued, retired) = self
+            .shared
+            .lock()
+            .map(|mut s| {
+                self.metrics.decode_lock_wait_us.record_micros(lock_started.elapsed());
+                // Checked under the lock: an abandoned job must not push once
+                // it has been stopped.
+                if self.stop_flag.load(Ordering::SeqCst) { return (0, 0, None); }
+                let (pushed, queued) = s.push_decoded(&mut self.staged, &self.pending[self.pending_offset..]);
+                (pushed, queued, s.take_retired())
+            })
+            .unwrap_or((0, 0, None));
+        // The queue a fired seek replaced is freed here, off the audio thread.
+        drop(retired);
 
-            let pushed = shared
-                .lock()
-                .map(|mut s| s.push_samples_bounded(&out_slice[offset..]))
-                .unwrap_or(0);
+        if pushed > 0 {
+            let per_second = self.out_sample_rate as f64 * self.out_channels.max(1) as f64;
+            self.deadline = Instant::now() + Duration::from_secs_f64(queued as f64 / per_second.max(1.0));
+        }
+        self.pending_offset += pushed;
+        self.pending_offset >= self.pending.len()
+    }
 
-            if pushed == 0 {
-                thread::sleep(Duration::from_millis(DECODE_BACKPRESSURE_SLEEP_MS));
-            } else {
-                offset += pushed;
+    /// Decode packets until output is pending, the slice ends or the job does.
+    fn decode(&mut self, slice_ends: Instant) -> Step {
+        loop {
+            if self.stopped() { return Step::End(Ok(())); }
+            if !self.flush_pending() { return Step::Yield(Slice::Blocked); }
+            if Instant::now() >= slice_ends { return Step::Yield(Slice::Progress); }
+
+            let Some((format, decoder)) = self.reader.as_mut() else { return Step::End(Ok(())) };
+            let packet = match format.next_packet() {
+                Ok(p) => p,
+                Err(SymphoniaError::ResetRequired) =>
+                    return Step::End(Err("Decoder reset required and not supported".to_string())),
+                Err(SymphoniaError::IoError(e)) if e.kind() == io::ErrorKind::UnexpectedEof =>
+                    return Step::End(Ok(())),
+                Err(SymphoniaError::IoError(e)) => return Step::End(Err(format!("Failed to read stream: {e}"))),
+                Err(e) => return Step::End(Err(format!("Failed to read next packet: {e}"))),
+            };
+
+            let packet_started = Instant::now();
+            let decoded = match decoder.decode(&packet) {
+                Ok(b) => b,
+                Err(SymphoniaError::DecodeError(e)) => {
+                    warn!("Decode error: {e}. Skipping packet.");
+                    continue;
+                }
+                Err(SymphoniaError::IoError(_)) => return Step::End(Ok(())),
+                Err(e) => return Step::End(Err(format!("Failed to decode packet: {e}"))),
+            };
+
+            let (src_ch, src_layout, src_rate, interleaved) = decoded_to_interleaved_f32(decoded);
+            if interleaved.is_empty() || src_ch == 0 || src_rate == 0 { continue; }
+
+            if self.stopped() { return Step::End(Ok(())); }
+
+            // Scale the target rate to implement speed without pitch shift.
+            let playback_rate = self.playback_rate();
+            let effective_out_rate = ((self.out_sample_rate as f32) / playback_rate).max(1.0) as u32;
+
+            let out = convert_to_output(
+                &interleaved,
+                src_ch,
+                src_layout,
+                src_rate,
+                self.out_channels,
+                effective_out_rate,
+                &mut self.resample_state,
+            );
+            self.metrics.decode_packet_us.record_micros(packet_started.elapsed());
+
+            let skipped = self.skip_output_samples.min(out.len());
+            self.skip_output_samples -= skipped;
+            self.pending        = out;
+            self.pending_offset = skipped;
+        }
+    }
+
+    /// Mark the stream finished (unless stopped) and report a failure.
+    fn finish(&mut self, result: Result<(), String>) -> Slice {
+        if let Ok(mut s) = self.shared.lock() {
+            if !self.stop_flag.load(Ordering::SeqCst) {
+                s.finish_decoding(self.staged);
             }
         }
-    };
+        if let Err(err) = result {
+            error!("Decoder ended with error: {err}");
+            let _ = self.events.send(AudioEvent::Error(AudioError::DecodeError(err)));
+        }
+        Slice::Done
+    }
+}
 
-    if let Ok(mut s) = shared.lock() {
-        s.stream_finished = true;
+impl PoolJob for DecodeJob {
+    fn run_slice(&mut self, waited: Option<Duration>) -> Slice {
+        if let Some(waited) = waited {
+            self.metrics.decode_wait_us.record_micros(waited);
+        }
+        if self.stopped() {
+            return self.finish(Ok(()));
+        }
+        if let Err(e) = self.open() {
+            return self.finish(Err(e));
+        }
+        match self.decode(Instant::now() + Duration::from_millis(DECODE_POOL_SLICE_MS)) {
+            Step::Yield(slice) => slice,
+            Step::End(result)  => self.finish(result),
+        }
     }
 
-    decode_result
+    fn deadline(&self) -> Instant {
+        self.deadline
+    }
 }
 
 /// Convert a source-time offset into the number of output samples to skip.
@@ -957,51 +1702,31 @@ fn source_millis_to_output_samples(
 // ── Sample format conversion helpers ─────────────────────────────────────────
 
 /// Convert a Symphonia decoded buffer to interleaved `f32`.
-fn decoded_to_interleaved_f32(decoded: AudioBufferRef<'_>) -> (usize, u32, Vec<f32>) {
+///
+/// Returns `(channels, channel mask, sample rate, samples)`.
+fn decoded_to_interleaved_f32(decoded: AudioBufferRef<'_>) -> (usize, u32, u32, Vec<f32>) {
     let spec     = *decoded.spec();
     let channels = spec.channels.count();
     let rate     = spec.rate;
     let mut buf  = SampleBuffer::<f32>::new(decoded.capacity() as u64, spec);
     buf.copy_interleaved_ref(decoded);
-    (channels, rate, buf.samples().to_vec())
-}
-
-/// Select the correct source sample for a given output channel.
-///
-/// Handles mono→stereo up-mix, stereo→mono down-mix, and channel remapping.
-#[inline(always)]
-fn source_frame_sample(
-    frames:       &[f32],
-    src_channels: usize,
-    frame:        usize,
-    out_channel:  usize,
-    out_channels: usize,
-) -> f32 {
-    if src_channels == 0 { return 0.0; }
-    let base = frame * src_channels;
-
-    // Stereo → mono.
-    if out_channels == 1 && src_channels > 1 {
-        let acc: f32 = (0..src_channels).map(|c| frames[base + c]).sum();
-        return acc / src_channels as f32;
-    }
-
-    // Mono → any.
-    if src_channels == 1 { return frames[base]; }
-
-    // Channel clip.
-    let idx = out_channel.min(src_channels - 1);
-    frames[base + idx]
+    (channels, spec.channels.bits(), rate, buf.samples().to_vec())
 }
 
 /// Resample `src_interleaved` from `src_rate` to `out_rate` using linear
-/// interpolation, remapping from `src_channels` to `out_channels`.
+/// interpolation, mixing from the source layout (`src_channels` channels,
+/// Symphonia channel mask `src_layout`) to `out_channels`.
 ///
-/// Fractional position and boundary carry samples are threaded through
-/// `state` across calls so there are no inter-packet discontinuities.
+/// Fractional position, boundary carry samples and the cached
+/// [`MixMatrix`] are threaded through `state` across calls so there are no
+/// inter-packet discontinuities.  Mixing commutes with linear
+/// interpolation, so each source frame is mixed once up front (or copied
+/// when the matrix is the identity) and interpolation only ever runs over
+/// the output channels — a 5.1 downmix interpolates two channels, not six.
 fn convert_to_output(
     src_interleaved: &[f32],
     src_channels:    usize,
+    src_layout:      u32,
     src_rate:        u32,
     out_channels:    usize,
     out_rate:        u32,
@@ -1011,14 +1736,30 @@ fn convert_to_output(
         return Vec::new();
     }
 
-    // Prepend the carry frame from the previous packet.
-    let mut frames = Vec::with_capacity(state.carry.len() + src_interleaved.len());
+    if !state.mix.matches(src_layout, src_channels, out_channels) {
+        state.mix = MixMatrix::new(src_layout, src_channels, out_channels);
+    }
+    // The carry frame is already mixed, so only a change of output channel
+    // count invalidates it.
+    if state.carry.len() != out_channels {
+        state.carry.clear();
+    }
+
+    // Mix the packet after the carry frame from the previous one.
+    let frames = &mut state.mixed;
+    frames.clear();
     frames.extend_from_slice(&state.carry);
-    frames.extend_from_slice(src_interleaved);
+    if state.mix.is_identity() {
+        frames.extend_from_slice(src_interleaved);
+    } else {
+        let start = frames.len();
+        frames.resize(start + src_interleaved.len() / src_channels * out_channels, 0.0);
+        state.mix.apply_block(src_interleaved, &mut frames[start..]);
+    }
 
-    let total_frames = frames.len() / src_channels;
+    let total_frames = frames.len() / out_channels;
     if total_frames < 2 {
-        state.carry = frames;
+        state.carry.clone_from(frames);
         return Vec::new();
     }
 
@@ -1030,23 +1771,21 @@ fn convert_to_output(
     let mut out = Vec::with_capacity(estimated.saturating_mul(out_channels));
 
     while pos + 1.0 < total_frames as f64 {
-        let i0   = pos.floor() as usize;
+        // `pos` is never negative, so truncating is `floor` without the
+        // libm call.
+        let i0   = pos as usize;
         let frac = (pos - i0 as f64) as f32;
-
-        for ch in 0..out_channels {
-            let s0 = source_frame_sample(&frames, src_channels, i0,     ch, out_channels);
-            let s1 = source_frame_sample(&frames, src_channels, i0 + 1, ch, out_channels);
-            out.push(s0 + (s1 - s0) * frac);
-        }
-
+        let a    = &frames[i0 * out_channels..(i0 + 1) * out_channels];
+        let b    = &frames[(i0 + 1) * out_channels..(i0 + 2) * out_channels];
+        out.extend(a.iter().zip(b).map(|(s0, s1)| s0 + (s1 - s0) * frac));
         pos += step;
     }
 
-    // Keep the last source frame as the left neighbour for the next packet.
+    // Keep the last frame as the left neighbour for the next packet.
     let keep_frame = total_frames - 1;
-    let keep_base  = keep_frame * src_channels;
+    let keep_base  = keep_frame * out_channels;
     state.carry.clear();
-    state.carry.extend_from_slice(&frames[keep_base..keep_base + src_channels]);
+    state.carry.extend_from_slice(&frames[keep_base..keep_base + out_channels]);
     state.pos = pos - keep_frame as f64;
 
     out
@@ -1054,38 +1793,184 @@ fn convert_to_output(
 
 // ── cpal output callbacks ─────────────────────────────────────────────────────
 
-fn write_output_f32(data: &mut [f32], channels: usize, shared: &Arc<Mutex<SharedPlayback>>) {
+/// Everything an output callback needs, moved into the stream closure.
+struct OutputContext {
+    shared:   Arc<Mutex<SharedPlayback>>,
+    metrics:  Arc<EngineMetrics>,
+    exchange: Arc<ChainExchange<ChannelChains>>,
+    convolver_exchange: Arc<ChainExchange<ChannelConvolvers>>,
+    dither:   Arc<AtomicBool>,
+    clock:    Arc<FrameClock>,
+    events:   EventSender,
+    channels: usize,
+}
+
+/// Build an output stream writing samples of type `T`.
+///
+/// The callback renders an `f32` block (straight into the device buffer for
+/// `f32` devices, into a preallocated scratch buffer otherwise) and converts
+/// it in one pass; see [`crate::sample_format`].  Device buffers longer than
+/// the scratch buffer are rendered in frame-aligned chunks, each with its
+/// own heard-at time.
+fn build_output<T, E>(
+    device: &Device,
+    config: &StreamConfig,
+    ctx:    OutputContext,
+    err_fn: E,
+) -> Result<Stream, String>
+where
+    T: OutputSample,
+    E: FnMut(StreamError) + Send + 'static,
+{
+    let OutputContext { shared, metrics, exchange, convolver_exchange, dither, clock, events, channels } = ctx;
+    let mut chains  = ChainRuntime::new(exchange, convolver_exchange, channels, config.sample_rate);
+    let mut scratch = vec![0.0f32; OUTPUT_SCRATCH_SAMPLES - OUTPUT_SCRATCH_SAMPLES % channels.max(1)];
+    let mut monitor = vec![0.0f32; OUTPUT_SCRATCH_SAMPLES - OUTPUT_SCRATCH_SAMPLES % channels.max(1)];
+    let mut noise   = Dither::new(dither.load(Ordering::Relaxed));
+    let mut priority = PriorityHint::new(ThreadRole::Callback);
+    let ns_per_frame = 1e9 / config.sample_rate.max(1) as f64;
+
+    device
+        .build_output_stream(
+            config,
+            move |data: &mut [T], info: &cpal::OutputCallbackInfo| {
+                priority.refresh();
+                let heard_ns = heard_at_ns(info);
+                noise.set_enabled(dither.load(Ordering::Relaxed));
+                T::write_block(data, &mut scratch, &mut noise, |block, offset| {
+                    let heard_ns = heard_ns + ((offset / channels.max(1)) as f64 * ns_per_frame) as u64;
+                    render_output(
+                        block, channels, heard_ns, &shared, &metrics, &clock, &events, &mut chains, &mut monitor,
+                    );
+                });
+            },
+            err_fn,
+            None,
+        )
+        .map_err(|e| AudioError::from(e).to_string())
+}
+
+/// Host time at which the first frame of this callback's buffer is heard:
+/// now plus the device latency cpal reports.
+fn heard_at_ns(info: &cpal::OutputCallbackInfo) -> u64 {
+    let timestamp = info.timestamp();
+    let latency = timestamp.playback.duration_since(&timestamp.callback).unwrap_or_default();
+    schedule::host_now_ns().saturating_add(latency.as_nanos() as u64)
+}
+
+/// Drain `data.len()` samples from the shared queue through the effect
+/// chains.  Shared by all sample formats so the telemetry and events are
+/// recorded identically.
+///
+/// The block is rendered in spans split at the frames scheduled commands
+/// are due at, and each command runs between its two neighbouring samples.
+/// `heard_ns` is the host time at which the block's first frame is heard.
+#[inline]
+#[allow(clippy::too_many_arguments)]
+fn render_output(
+    data:     &mut [f32],
+    channels: usize,
+    heard_ns: u64,
+    shared:   &Arc<Mutex<SharedPlayback>>,
+    metrics:  &EngineMetrics,
+    clock:    &FrameClock,
+    events:   &EventSender,
+    chains:   &mut ChainRuntime,
+    monitor:  &mut [f32],
+) {
+    let probe = metrics.begin_callback();
+    chains.refresh(data.len() / channels.max(1));
+
     let mut g = match shared.lock() {
         Ok(g) => g,
         Err(_) => { debug!("Lock failed; filling silence"); data.fill(0.0); return; }
     };
-    for frame in data.chunks_mut(channels) {
-        for out in frame.iter_mut() {
-            *out = g.next_sample();
+    probe.lock_acquired();
+
+    let queued         = g.queue.len();
+    let emitted_from   = g.emitted_samples;
+    let underruns_from = g.underrun_count;
+    let was_finished   = matches!(g.status, PlaybackStatus::Finished);
+
+    let frame  = channels.max(1);
+    let frames = data.len() / frame;
+    let first  = g.frames;
+    let anchor = schedule::ClockAnchor { frame: first, host_ns: heard_ns, sample_rate: g.sample_rate };
+    clock.publish(&anchor);
+    g.schedule.resolve(&anchor);
+
+    let tap = g.monitor.clone();
+    let mut done = 0;
+    loop {
+        let due   = g.schedule.next_before(first + frames as u64);
+        let until = due.map_or(frames, |at| (at.saturating_sub(first) as usize).max(done));
+        // The last span also takes any trailing partial frame.
+        let end = if until == frames { data.len() } else { until * frame };
+        render_span(&mut g, chains, &mut data[done * frame..end], frame, tap.as_deref(), monitor);
+        done = until;
+        if due.is_none() {
+            break;
+        }
+        let now = first + done as u64;
+        while let Some(entry) = g.schedule.pop_due(now) {
+            if let Some(event) = g.fire(&entry) {
+                events.post(event);
+            }
+            let due_frame = match entry.due { Due::Frame(at) => at, Due::HostNs(_) => now };
+            events.post(AudioEvent::ScheduleFired {
+                id:          entry.id,
+                command:     entry.command.code(),
+                frame:       now,
+                late_frames: now - due_frame.min(now),
+            });
         }
     }
-}
+    g.frames = first + frames as u64;
+    g.mix_voices(data, |triggered| metrics.sample_trigger_us.record_micros(triggered.elapsed()));
 
-fn write_output_i16(data: &mut [i16], channels: usize, shared: &Arc<Mutex<SharedPlayback>>) {
-    let mut g = match shared.lock() {
-        Ok(g) => g,
-        Err(_) => { data.fill(0); return; }
-    };
-    for frame in data.chunks_mut(channels) {
-        for out in frame.iter_mut() {
-            *out = (g.next_sample() * i16::MAX as f32) as i16;
-        }
+    // Events are posted without a wake-up: no syscalls on this thread.
+    let interval = (g.sample_rate as u64 * channels as u64 * EVENT_POSITION_INTERVAL_MS / 1000).max(1);
+    if g.emitted_samples / interval != emitted_from / interval {
+        events.post(AudioEvent::Position { current: g.position(channels), total: None });
     }
+    if g.underrun_count != underruns_from {
+        events.post(AudioEvent::Underrun { count: g.underrun_count });
+    }
+    if !was_finished && matches!(g.status, PlaybackStatus::Finished) {
+        events.post(AudioEvent::PlaybackFinished);
+    }
+
+    let emitted = g.emitted_samples != emitted_from;
+    probe.finish(data.len() / channels.max(1), g.sample_rate, queued, g.max_samples, emitted);
 }
 
-fn write_output_u16(data: &mut [u16], channels: usize, shared: &Arc<Mutex<SharedPlayback>>) {
-    let mut g = match shared.lock() {
-        Ok(g) => g,
-        Err(_) => { data.fill(u16::MAX / 2); return; }
-    };
-    for frame in data.chunks_mut(channels) {
-        for out in frame.iter_mut() {
-            *out = (((g.next_sample() * 0.5) + 0.5) * u16::MAX as f32) as u16;
+/// Render whole frames of the main source (plus monitored input) into
+/// `span` through the effect chains.
+#[inline]
+fn render_span(
+    g:       &mut SharedPlayback,
+    chains:  &mut ChainRuntime,
+    span:    &mut [f32],
+    frame:   usize,
+    tap:     Option<&MonitorTap>,
+    monitor: &mut [f32],
+) {
+    match tap {
+        None => {
+            for (i, out) in span.iter_mut().enumerate() {
+                *out = g.next_sample(chains, i % frame, 0.0);
+            }
+        }
+        // Spans start on a frame and `monitor` is frame-aligned, so the
+        // channel index restarts at 0 in every chunk.
+        Some(tap) => {
+            for chunk in span.chunks_mut(monitor.len()) {
+                let input = &mut monitor[..chunk.len()];
+                tap.read_into(input);
+                for (i, (out, &input)) in chunk.iter_mut().zip(input.iter()).enumerate() {
+                    *out = g.next_sample(chains, i % frame, input);
+                }
+            }
         }
     }
 }
@@ -1094,4 +1979,309 @@ fn write_output_u16(data: &mut [u16], channels: usize, shared: &Arc<Mutex<Shared
 
 pub fn default_output_sample_rate() -> i32 { AudioEngine::default_output_sample_rate() }
 pub fn default_output_channels()    -> i32 { AudioEngine::default_output_channels() }
-pub fn output_device_count()        -> i32 { AudioEngine::output_device_count() }
\ No newline at end of file
+pub fn output_device_count()        -> i32 { AudioEngine::output_device_count() }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::schedule::ClockAnchor;
+
+    const RATE:     u32   = 48_000;
+    const CHANNELS: usize = 2;
+    const BLOCK:    usize = 256;
+
+    /// Drives `render_output` with a simulated output clock: block `k`
+    /// starts at frame `k · BLOCK` and is heard at a fixed latency after a
+    /// host time that advances exactly with the frames.
+    struct SimulatedOutput {
+        shared:  Arc<Mutex<SharedPlayback>>,
+        metrics: EngineMetrics,
+        clock:   FrameClock,
+        events:  EventSender,
+        inbox:   EventReceiver,
+        chains:  ChainRuntime,
+        epoch:   ClockAnchor,
+    }
+
+    impl SimulatedOutput {
+        /// A playing source whose `n`-th sample is `(n + 1) / 2^20`.
+        fn new() -> Self {
+            let mut playback = SharedPlayback::new(CHANNELS, RATE);
+            playback.stream_finished = false;
+            let source: Vec<f32> = (0..RATE as usize).map(|n| (n + 1) as f32 / 1_048_576.0).collect();
+            playback.push_samples_bounded(&source);
+            playback.set_playing(true);
+            let (events, inbox) = event_channel();
+            Self {
+                shared:  Arc::new(Mutex::new(playback)),
+                metrics: EngineMetrics::new(),
+                clock:   FrameClock::new(),
+                events,
+                inbox,
+                chains:  ChainRuntime::new(Default::default(), Default::default(), CHANNELS, RATE),
+                epoch:   ClockAnchor { frame: 0, host_ns: 3_000_000_000, sample_rate: RATE },
+            }
+        }
+
+        fn render(&mut self, block: usize) -> Vec<f32> {
+            let mut data = vec![0.0; BLOCK * CHANNELS];
+            let heard_ns = self.epoch.host_ns_at((block * BLOCK) as i64) as u64;
+            render_output(
+                &mut data, CHANNELS, heard_ns, &self.shared, &self.metrics, &self.clock, &self.events,
+                &mut self.chains, &mut [],
+            );
+            data
+        }
+
+        fn schedule(&self, command: ScheduledCommand, due: Due) -> u32 {
+            self.shared.lock().unwrap().schedule.push(command, due).unwrap()
+        }
+
+        /// `(id, frame, late_frames)` of every fired entry so far.
+        fn fired(&self) -> Vec<(u32, u64, u64)> {
+            std::iter::from_fn(|| self.inbox.try_recv())
+                .filter_map(|event| match event {
+                    AudioEvent::ScheduleFired { id, frame, late_frames, .. } => Some((id, frame, late_frames)),
+                    _ => None,
+                })
+                .collect()
+        }
+    }
+
+    #[test]
+    fn scheduled_commands_split_blocks_sample_exactly() {
+        let mut sim = SimulatedOutput::new();
+        let volume = sim.schedule(ScheduledCommand::Volume(0.5), Due::Frame(1_000));
+        let pause  = sim.schedule(ScheduledCommand::Pause, Due::HostNs(sim.epoch.host_ns_at(1_300) as u64));
+        let play   = sim.schedule(ScheduledCommand::Play, Due::Frame(1_700));
+        let edge   = sim.schedule(ScheduledCommand::Volume(0.25), Due::Frame(2_048));
+
+        let mut output = Vec::new();
+        for block in 0..6 {
+            output.extend(sim.render(block));
+        }
+        // Due in the past once block 6 (frames 1536..1792) starts: fires on
+        // its first frame, 36 frames late.
+        let late = sim.schedule(ScheduledCommand::Volume(1.0), Due::Frame(1_500));
+        for block in 6..10 {
+            output.extend(sim.render(block));
+        }
+
+        assert_eq!(
+            sim.fired(),
+            [(volume, 1_000, 0), (pause, 1_300, 0), (late, 1_536, 36), (play, 1_700, 0), (edge, 2_048, 0)],
+        );
+
+        // Expected output, frame by frame: the source advances only while
+        // playing, and each command takes effect exactly on its frame.
+        let mut next = 0usize;
+        for (frame, samples) in output.chunks_exact(CHANNELS).enumerate() {
+            let (playing, gain) = match frame {
+                0..1_000     => (true, 1.0),
+                1_000..1_300 => (true, 0.5),
+                1_300..1_700 => (false, 0.0),
+                1_700..2_048 => (true, 1.0),
+                _            => (true, 0.25),
+            };
+            for &sample in samples {
+                let expected = if playing {
+                    next += 1;
+                    next as f32 / 1_048_576.0 * gain
+                } else {
+                    0.0
+                };
+                assert_eq!(sample, expected, "frame {frame}");
+            }
+        }
+
+        let clock = sim.clock.anchor().unwrap();
+        assert_eq!(clock.frame, 9 * BLOCK as u64);
+        assert_eq!(clock.host_ns, sim.epoch.host_ns_at(9 * BLOCK as i64) as u64);
+        assert_eq!(sim.shared.lock().unwrap().frames, 10 * BLOCK as u64);
+    }
+
+    /// The resampler before [`MixMatrix`]: the source channel for each
+    /// output sample was chosen per sample (and 5.1 lost its centre and
+    /// surrounds).  Kept only as the benchmark baseline.
+    fn convert_per_sample(
+        src_interleaved: &[f32],
+        src_channels:    usize,
+        src_rate:        u32,
+        out_channels:    usize,
+        out_rate:        u32,
+        (pos, carry):    (&mut f64, &mut Vec<f32>),
+    ) -> Vec<f32> {
+        let sample = |frames: &[f32], frame: usize, channel: usize| {
+            let base = frame * src_channels;
+            if out_channels == 1 && src_channels > 1 {
+                return frames[base..base + src_channels].iter().sum::<f32>() / src_channels as f32;
+            }
+            if src_channels == 1 {
+                return frames[base];
+            }
+            frames[base + channel.min(src_channels - 1)]
+        };
+
+        let mut frames = Vec::with_capacity(carry.len() + src_interleaved.len());
+        frames.extend_from_slice(carry);
+        frames.extend_from_slice(src_interleaved);
+        let total_frames = frames.len() / src_channels;
+        let step = src_rate as f64 / out_rate as f64;
+        let mut out = Vec::with_capacity(((total_frames as f64 / step) as usize + 1) * out_channels);
+        while *pos + 1.0 < total_frames as f64 {
+            let i0   = pos.floor() as usize;
+            let frac = (*pos - i0 as f64) as f32;
+            for ch in 0..out_channels {
+                let s0 = sample(&frames, i0, ch);
+                let s1 = sample(&frames, i0 + 1, ch);
+                out.push(s0 + (s1 - s0) * frac);
+            }
+            *pos += step;
+        }
+        let keep = total_frames - 1;
+        carry.clear();
+        carry.extend_from_slice(&frames[keep * src_channels..(keep + 1) * src_channels]);
+        *pos -= keep as f64;
+        out
+    }
+
+    /// `cargo test --release -- --ignored --nocapture mix_matrix_resample`
+    ///
+    /// Resampling 44.1 → 48 kHz packets of mono, stereo, 5.1 and 7.1
+    /// sources onto stereo and 7.1 outputs through the cached matrix,
+    /// against the per-sample channel choice it replaced.
+    #[test]
+    #[ignore]
+    fn mix_matrix_resample() {
+        const PACKET:  usize = 1_152;
+        const PACKETS: usize = 500;
+
+        let cases = [
+            (1, 2, "mono → stereo"),
+            (2, 2, "stereo → stereo"),
+            (6, 2, "5.1 → stereo"),
+            (8, 2, "7.1 → stereo"),
+            (1, 8, "mono → 7.1"),
+            (2, 8, "stereo → 7.1"),
+            (6, 8, "5.1 → 7.1"),
+            (8, 8, "7.1 → 7.1"),
+            (6, 6, "5.1 → 5.1"),
+        ];
+        for (src_channels, out_channels, label) in cases {
+            let packet: Vec<f32> =
+                (0..PACKET * src_channels).map(|n| (n as f32 * 0.013).sin() * 0.5).collect();
+
+            // Best of several runs: ns per output frame.
+            let best = |run: &mut dyn FnMut() -> usize| {
+                (0..7)
+                    .map(|_| {
+                        let started = Instant::now();
+                        let frames = (0..PACKETS).map(|_| run()).sum::<usize>() / out_channels;
+                        started.elapsed().as_nanos() as f64 / frames as f64
+                    })
+                    .fold(f64::INFINITY, f64::min)
+            };
+
+            let mut state = ResampleState::new();
+            let matrix = best(&mut || {
+                let out = convert_to_output(&packet, src_channels, 0, 44_100, out_channels, RATE, &mut state);
+                std::hint::black_box(out).len()
+            });
+            let (mut pos, mut carry) = (0.0, Vec::new());
+            let per_sample = best(&mut || {
+                let out = convert_per_sample(&packet, src_channels, 44_100, out_channels, RATE, (&mut pos, &mut carry));
+                std::hint::black_box(out).len()
+            });
+
+            // Where the old mapping was right, both paths agree exactly.
+            // It copied the last source channel into any extra outputs, so
+            // upmixes to 7.1 differ by design.
+            if src_channels == out_channels || out_channels == 2 && src_channels < 2 {
+                let mut state = ResampleState::new();
+                let (mut pos, mut carry) = (0.0, Vec::new());
+                assert_eq!(
+                    convert_to_output(&packet, src_channels, 0, 44_100, out_channels, RATE, &mut state),
+                    convert_per_sample(&packet, src_channels, 44_100, out_channels, RATE, (&mut pos, &mut carry)),
+                );
+            }
+            println!("{label:>15}: matrix {matrix:.1} ns/frame, per-sample {per_sample:.1} ns/frame");
+        }
+    }
+
+    /// `cargo test --release -- --ignored --nocapture sample_bank_vs_set_source`
+    ///
+    /// Trigger to audible block for one short 44.1 kHz sound: decoding it
+    /// with a fresh `DecodeJob` as `set_source` + `play` do, against a
+    /// voice on the copy already in the sample bank.
+    #[test]
+    #[ignore]
+    fn sample_bank_vs_set_source() {
+        use crate::capture::WavWriter;
+
+        const TRIGGERS: usize = 200;
+
+        let file = tempfile::Builder::new().suffix(".wav").tempfile().unwrap();
+        let path = file.path().to_str().unwrap().to_string();
+        let mut wav = WavWriter::create(&path, CaptureFormat::WavPcm16, CHANNELS as u16, 44_100).unwrap();
+        let tone: Vec<f32> = (0..44_100 * CHANNELS / 8).map(|n| ((n / CHANNELS) as f32 * 0.06).sin() * 0.5).collect();
+        wav.write(&tone).unwrap();
+        wav.finish(CHANNELS as u16, 44_100).unwrap();
+
+        let mut sim = SimulatedOutput::new();
+        *sim.shared.lock().unwrap() = SharedPlayback::new(CHANNELS, RATE);
+        let audible = |block: &[f32]| block.iter().any(|&s| s != 0.0);
+        let median = |mut micros: Vec<f64>| {
+            micros.sort_by(f64::total_cmp);
+            micros[micros.len() / 2]
+        };
+
+        let metrics = Arc::new(EngineMetrics::new());
+        let mut decoded = Vec::with_capacity(TRIGGERS);
+        for _ in 0..TRIGGERS {
+            let started = Instant::now();
+            {
+                let mut s = sim.shared.lock().unwrap();
+                s.clear_audio_state();
+                s.stream_finished = false;
+                s.set_playing(true);
+            }
+            let mut job = DecodeJob::new(
+                AudioSource::Path(path.clone()), Arc::new(AtomicBool::new(false)), Arc::clone(&sim.shared),
+                Arc::clone(&metrics), sim.events.clone(), None, CHANNELS, RATE, 0, None,
+            );
+            while sim.shared.lock().unwrap().queue.len() < BLOCK * CHANNELS {
+                if matches!(job.run_slice(None), Slice::Done) { break; }
+            }
+            assert!(audible(&sim.render(0)));
+            decoded.push(started.elapsed().as_secs_f64() * 1e6);
+        }
+        sim.shared.lock().unwrap().clear_audio_state();
+
+        let preload_started = Instant::now();
+        let mut bank = SampleBank::new(DEFAULT_SAMPLE_BANK_BUDGET_BYTES);
+        let pcm = decode_source_to_output(AudioSource::Path(path), CHANNELS, RATE, bank.max_samples()).unwrap();
+        let blocks = pcm.len().div_ceil(BLOCK * CHANNELS);
+        bank.insert("tone".into(), pcm).unwrap();
+        let preload = preload_started.elapsed().as_secs_f64() * 1e6;
+
+        let mut cached = Vec::with_capacity(TRIGGERS);
+        for _ in 0..TRIGGERS {
+            let started = Instant::now();
+            let voice = SampleVoice::new(bank.get("tone").unwrap(), 1.0);
+            sim.shared.lock().unwrap().trigger_voice(voice);
+            assert!(audible(&sim.render(0)));
+            cached.push(started.elapsed().as_secs_f64() * 1e6);
+            // Let the voice finish so every trigger mixes alone.
+            for _ in 1..blocks { sim.render(0); }
+        }
+
+        let (decoded, cached) = (median(decoded), median(cached));
+        let period = BLOCK as f64 * 1e6 / RATE as f64;
+        println!(
+            "trigger to audible block: set_source + play {decoded:.0} µs, sample bank {cached:.1} µs \
+             (one-time preload {preload:.0} µs; callback period {period:.0} µs)"
+        );
+        assert!(cached < decoded, "sample bank {cached:.1} µs, decode path {decoded:.1} µs");
+        assert!(cached < period, "sample bank trigger {cached:.1} µs exceeds a callback period");
+    }
+}
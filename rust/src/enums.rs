@@ -11,12 +11,27 @@ pub const MIN_MAX_QUEUE_SECONDS: usize = 1;
 /// Maximum allowed value for `max_queue_seconds`.
 pub const MAX_MAX_QUEUE_SECONDS: usize = 120;
 
-// ── Decode thread back-pressure ───────────────────────────────────────────────
+/// `audiopc_set_queue_storage`: queue decoded samples as `f32` (default).
+pub const QUEUE_STORAGE_F32: i32 = 0;
+/// `audiopc_set_queue_storage`: queue as 16-bit integers (half the memory;
+/// peaks above full scale are clipped).
+pub const QUEUE_STORAGE_I16: i32 = 1;
+/// `audiopc_set_queue_storage`: queue as IEEE half floats (half the memory;
+/// keeps headroom at ~11-bit precision).
+pub const QUEUE_STORAGE_F16: i32 = 2;
 
-/// How long (ms) the decode thread sleeps when the queue is full, before
-/// retrying.  Keeping this short keeps latency low while still yielding to
-/// the scheduler.
+// ── Decode scheduling ─────────────────────────────────────────────────────────
+
+/// How long (ms) a decoder whose queue is full waits before retrying.
+/// Keeping this short keeps latency low while still yielding to the
+/// scheduler.
 pub const DECODE_BACKPRESSURE_SLEEP_MS: u64 = 2;
+/// Upper bound on the worker threads of the shared decode pool.  The pool
+/// uses one fewer than the available cores, clamped to `1..=` this.
+pub const DECODE_POOL_MAX_THREADS: usize = 4;
+/// Longest (ms) a pool worker keeps decoding one source before returning to
+/// the scheduler, so the source closest to running dry is served next.
+pub const DECODE_POOL_SLICE_MS: u64 = 4;
 
 // ── Visualizer ────────────────────────────────────────────────────────────────
 
@@ -40,4 +55,246 @@ pub const MAX_RATE: f32 = 2.0;
 
 /// How frequently (ms) the device watcher thread polls for device changes.
 /// This value is a trade-off between responsiveness and CPU usage.
-pub const DEVICE_POLL_INTERVAL_MS: u64 = 2_000;
\ No newline at end of file
+pub const DEVICE_POLL_INTERVAL_MS: u64 = 2_000;
+
+// ── Metrics ───────────────────────────────────────────────────────────────────
+
+/// Number of buckets in each log-linear metrics histogram.  Covers values up
+/// to ~2^33 (µs) with ~12 % relative precision.
+pub const METRICS_HISTOGRAM_BUCKETS: usize = 256;
+/// Number of recent callbacks kept for trace export.
+pub const METRICS_TRACE_CAPACITY: usize = 4096;
+
+// ── Effect chain updates ──────────────────────────────────────────────────────
+
+/// How long (ms) a filter takes to glide from its previous coefficients to
+/// new ones after a parameter change.
+pub const FILTER_GLIDE_MILLIS: u64 = 30;
+/// How long (ms) the callback crossfades from a replaced filter chain or
+/// convolver to its replacement, and how long a wet/dry mix change takes.
+pub const CHAIN_CROSSFADE_MILLIS: u64 = 30;
+/// Number of replaced effect chains the audio callback can hand back for
+/// reclamation before it defers picking up further updates.
+pub const CHAIN_RETIRE_SLOTS: usize = 4;
+
+// ── Output conversion ─────────────────────────────────────────────────────────
+
+/// Samples preallocated for the `f32` render buffer of non-`f32` output
+/// streams.  Covers an 8-channel, 2048-frame device buffer in one pass;
+/// larger device buffers are rendered in chunks of this size.
+pub const OUTPUT_SCRATCH_SAMPLES: usize = 16_384;
+
+// ── Source loading ────────────────────────────────────────────────────────────
+
+/// `audiopc_source_load_state`: no source set.
+pub const SOURCE_LOAD_IDLE: i32 = 0;
+/// `audiopc_source_load_state`: the source is being opened and probed.
+pub const SOURCE_LOAD_LOADING: i32 = 1;
+/// `audiopc_source_load_state`: the source is ready; duration is final.
+pub const SOURCE_LOAD_READY: i32 = 2;
+/// `audiopc_source_load_state`: opening or probing the source failed.
+pub const SOURCE_LOAD_FAILED: i32 = 3;
+
+// ── Sample bank ───────────────────────────────────────────────────────────────
+
+/// Default memory budget (bytes) for decoded sounds in the sample bank.
+pub const DEFAULT_SAMPLE_BANK_BUDGET_BYTES: usize = 64 * 1024 * 1024;
+/// Maximum number of cached sounds that can play at the same time.
+pub const MAX_SAMPLE_VOICES: usize = 32;
+
+// ── Convolution ───────────────────────────────────────────────────────────────
+
+/// Partition size (frames) of the FFT convolver.  Also its latency.
+pub const CONVOLVER_BLOCK_FRAMES: usize = 512;
+/// Longest impulse response (seconds) accepted by the convolver.
+pub const CONVOLVER_MAX_IR_SECONDS: usize = 10;
+
+// ── Live streaming ────────────────────────────────────────────────────────────
+
+/// Capacity (bytes) of the jitter buffer between a live stream's network
+/// thread and the decoder.
+pub const LIVE_JITTER_BUFFER_BYTES: usize = 4 * 1024 * 1024;
+/// Bytes a live stream buffers before playback starts, and again after an
+/// underrun.
+pub const LIVE_PREBUFFER_BYTES: usize = 64 * 1024;
+/// Size (bytes) of each network read on a live stream.
+pub const LIVE_READ_CHUNK_BYTES: usize = 16 * 1024;
+/// Connect timeout and longest stall (ms) before a live connection is
+/// considered dropped.
+pub const LIVE_HTTP_TIMEOUT_MS: u64 = 10_000;
+/// Delay (ms) before the first reconnect attempt; doubles per attempt.
+pub const LIVE_RECONNECT_BASE_MS: u64 = 500;
+/// Longest delay (ms) between reconnect attempts.
+pub const LIVE_RECONNECT_MAX_MS: u64 = 10_000;
+/// Consecutive failed reconnect attempts before a live stream gives up.
+pub const LIVE_MAX_RECONNECT_ATTEMPTS: u32 = 8;
+/// Number of HLS segments downloaded in parallel.
+pub const LIVE_HLS_PREFETCH_SEGMENTS: usize = 3;
+/// How many segments behind the live edge an HLS live playlist starts.
+pub const LIVE_HLS_LIVE_EDGE_SEGMENTS: usize = 3;
+/// Times a static HTTP source re-requests from its current offset after a
+/// failed read before giving up.
+pub const HTTP_READ_RETRIES: u32 = 3;
+/// Delay (ms) before the first re-request of a static HTTP source; grows by
+/// the same amount per attempt.
+pub const HTTP_RETRY_BASE_MS: u64 = 250;
+
+// ── Events ────────────────────────────────────────────────────────────────────
+
+/// Discrete events the event bus holds before new ones are dropped.
+/// Position, buffering, underrun and queue-length updates are coalesced and
+/// do not count against it.
+pub const EVENT_QUEUE_CAPACITY: usize = 256;
+/// Slots of [`EVENT_QUEUE_CAPACITY`] kept for events that must not be lost.
+/// Kinds superseded by the next event of their kind (analysis progress,
+/// decoder warnings, stream metadata, reconnect attempts) are dropped once
+/// only these are free.
+pub const EVENT_QUEUE_RESERVED: usize = 64;
+/// Longest a blocked event consumer sleeps before re-checking the bus for
+/// events published without a wake-up (from the audio callback).
+pub const EVENT_WAIT_SLICE_MS: u64 = 10;
+/// Interval (ms of played audio) between position events.
+pub const EVENT_POSITION_INTERVAL_MS: u64 = 100;
+/// Buffer size (bytes) `audiopc_wait_event` callers should provide.
+pub const EVENT_JSON_MAX_BYTES: i32 = 8192;
+
+/// Event `kind`: playback started.
+pub const EVENT_PLAYBACK_STARTED: i32 = 1;
+/// Event `kind`: playback paused at `position_ms`.
+pub const EVENT_PLAYBACK_PAUSED: i32 = 2;
+/// Event `kind`: playback resumed at `position_ms`.
+pub const EVENT_PLAYBACK_RESUMED: i32 = 3;
+/// Event `kind`: the source played to its end.
+pub const EVENT_PLAYBACK_FINISHED: i32 = 4;
+/// Event `kind`: playback was stopped by the caller.
+pub const EVENT_PLAYBACK_STOPPED: i32 = 5;
+/// Event `kind`: a new track became active (`title`, `artist`, …).
+pub const EVENT_TRACK_CHANGED: i32 = 6;
+/// Event `kind`: the source finished loading (`duration_ms`,
+/// `sample_rate`, `channels`).
+pub const EVENT_SOURCE_LOADED: i32 = 7;
+/// Event `kind`: the playback queue is exhausted.
+pub const EVENT_QUEUE_EXHAUSTED: i32 = 8;
+/// Event `kind`: the queue length changed (`len`).  Coalesced.
+pub const EVENT_QUEUE_UPDATED: i32 = 9;
+/// Event `kind`: an error occurred (`message`).
+pub const EVENT_ERROR: i32 = 10;
+/// Event `kind`: the output ran dry (`count`, cumulative).  Coalesced.
+pub const EVENT_UNDERRUN: i32 = 11;
+/// Event `kind`: the decoder reported a warning (`message`).
+pub const EVENT_DECODER_WARNING: i32 = 12;
+/// Event `kind`: a stream is buffering (`percent`).  Coalesced.
+pub const EVENT_BUFFERING: i32 = 13;
+/// Event `kind`: buffering finished.
+pub const EVENT_BUFFERING_COMPLETE: i32 = 14;
+/// Event `kind`: a live stream is reconnecting (`attempt`).
+pub const EVENT_RECONNECTING: i32 = 15;
+/// Event `kind`: live stream metadata arrived (`tags`).
+pub const EVENT_STREAM_METADATA: i32 = 16;
+/// Event `kind`: an output device appeared (`name`, `is_default`).
+pub const EVENT_DEVICE_ADDED: i32 = 17;
+/// Event `kind`: an output device disappeared (`name`, `is_default`).
+pub const EVENT_DEVICE_REMOVED: i32 = 18;
+/// Event `kind`: the default output device changed (`name`, `is_default`).
+pub const EVENT_DEFAULT_DEVICE_CHANGED: i32 = 19;
+/// Event `kind`: playback position (`current_ms`, `total_ms`).  Coalesced.
+pub const EVENT_POSITION: i32 = 20;
+/// Event `kind`: a batch analysis made progress on a track (`job`, `path`,
+/// `percent`, `bpm` estimated so far).
+pub const EVENT_ANALYSIS_PROGRESS: i32 = 21;
+/// Event `kind`: a track of a batch analysis finished (`job`, `path`, and
+/// `analysis` or `message`).  `analysis` is a summary (`bpm`, `confidence`,
+/// `duration_ms`, `beat_count`, `onset_count`); `audiopc_analyze_track`
+/// returns the beats and onsets from the cache.
+pub const EVENT_ANALYSIS_RESULT: i32 = 22;
+/// Event `kind`: every track of a batch analysis is done (`job`).
+pub const EVENT_ANALYSIS_FINISHED: i32 = 23;
+/// Event `kind`: a scheduled command ran (`id`, `command`, `frame` it ran
+/// at, `late_frames` after its due frame).
+pub const EVENT_SCHEDULE_FIRED: i32 = 24;
+
+// ── Capture ───────────────────────────────────────────────────────────────────
+
+/// `audiopc_start_capture`: record 16-bit PCM WAV.
+pub const CAPTURE_FORMAT_WAV_PCM16: i32 = 0;
+/// `audiopc_start_capture`: record 32-bit float WAV (keeps input headroom).
+pub const CAPTURE_FORMAT_WAV_F32: i32 = 1;
+/// Seconds of input the record ring holds while the writer thread catches
+/// up.  Frames arriving when it is full are dropped and counted.
+pub const CAPTURE_RING_SECONDS: usize = 4;
+/// Frames the writer thread waits for before each file write, so the disk
+/// sees few large sequential writes.
+pub const CAPTURE_WRITE_BATCH_FRAMES: usize = 8192;
+/// How long (ms) the writer thread sleeps when less than a batch is queued.
+pub const CAPTURE_WRITER_IDLE_MS: u64 = 20;
+/// Most monitored input (ms) allowed to queue ahead of the output; older
+/// input is skipped so monitoring latency stays bounded.
+pub const CAPTURE_MONITOR_MAX_LATENCY_MS: usize = 20;
+
+// ── Track analysis ────────────────────────────────────────────────────────────
+
+/// Mono sample rate tracks are decoded to for beat and onset analysis.
+pub const ANALYSIS_SAMPLE_RATE: u32 = 22_050;
+/// FFT size of the onset (spectral flux) analysis.  Must be a power of two.
+pub const ANALYSIS_FFT_SIZE: usize = 1024;
+/// Hop (samples) between analysis frames; ~23 ms at the analysis rate.
+pub const ANALYSIS_HOP_SIZE: usize = 512;
+/// Gain applied to STFT magnitudes before log compression (`ln(1 + g|X|)`).
+pub const ANALYSIS_LOG_COMPRESSION: f32 = 100.0;
+/// Slowest tempo (BPM) the tempo estimator considers.
+pub const ANALYSIS_MIN_BPM: f32 = 60.0;
+/// Fastest tempo (BPM) the tempo estimator considers.
+pub const ANALYSIS_MAX_BPM: f32 = 200.0;
+/// Tempo the estimator prefers between octave-related candidates.
+pub const ANALYSIS_PREFERRED_BPM: f32 = 120.0;
+/// Onset threshold above the local mean of the onset function, in
+/// standard deviations of the whole function.
+pub const ANALYSIS_ONSET_THRESHOLD: f32 = 1.0;
+/// An onset must be the largest value within this many frames either side.
+pub const ANALYSIS_ONSET_PEAK_FRAMES: usize = 3;
+/// Frames either side averaged for the onset threshold's local mean.
+pub const ANALYSIS_ONSET_MEAN_FRAMES: usize = 16;
+/// Seconds of decoded audio between progress events of a batch analysis.
+pub const ANALYSIS_PROGRESS_SECONDS: u32 = 30;
+/// Analysed tracks kept in the result cache.  The oldest are evicted first.
+pub const ANALYSIS_CACHE_ENTRIES: usize = 512;
+/// Buffer size (bytes) `audiopc_analyze_track` callers should provide.
+pub const ANALYSIS_JSON_MAX_BYTES: i32 = 1024 * 1024;
+
+// ── Thread priority ───────────────────────────────────────────────────────────
+
+/// `audiopc_thread_priority` role: the output callback thread.
+pub const THREAD_ROLE_CALLBACK: i32 = 0;
+/// `audiopc_thread_priority` role: the decode workers.
+pub const THREAD_ROLE_DECODE: i32 = 1;
+
+/// `audiopc_thread_priority`: the thread runs at its default priority.
+pub const THREAD_PRIORITY_NORMAL: i32 = 0;
+/// `audiopc_thread_priority`: the thread got a raised nice value.
+pub const THREAD_PRIORITY_ELEVATED: i32 = 1;
+/// `audiopc_thread_priority`: the thread runs under `SCHED_FIFO`.
+pub const THREAD_PRIORITY_REALTIME: i32 = 2;
+/// `audiopc_thread_priority`: elevation was requested but not permitted.
+pub const THREAD_PRIORITY_DENIED: i32 = -1;
+
+/// `SCHED_FIFO` priority requested for the output callback (Linux, 1–99).
+/// Kept low so device and IRQ threads still preempt it.
+pub const THREAD_RT_PRIORITY_CALLBACK: i32 = 10;
+/// Nice value for the output callback when `SCHED_FIFO` is refused.
+pub const THREAD_NICE_CALLBACK: i32 = -11;
+/// Nice value for decode workers while elevated priority is enabled.
+pub const THREAD_NICE_DECODE: i32 = -6;
+
+// ── Scheduling ────────────────────────────────────────────────────────────────
+
+/// `audiopc_schedule*` command: start or resume playback.
+pub const SCHEDULE_PLAY: i32 = 0;
+/// `audiopc_schedule*` command: pause playback, keeping the position.
+pub const SCHEDULE_PAUSE: i32 = 1;
+/// `audiopc_schedule*` command: jump to `value` ms.  The target is decoded
+/// ahead, so the jump itself is sample-exact.
+pub const SCHEDULE_SEEK: i32 = 2;
+/// `audiopc_schedule*` command: set the volume to `value`.
+pub const SCHEDULE_VOLUME: i32 = 3;
+/// Commands that can be pending at once; one of them may be a seek.
+pub const MAX_SCHEDULED_COMMANDS: usize = 64;
@@ -1,6 +1,11 @@
 use std::collections::HashMap;
+use std::sync::Arc;
 use std::time::Duration;
 
+use serde_json::json;
+
+use crate::analysis::TrackAnalysis;
+use crate::enums::*;
 use crate::error::AudioError;
 
 /// Metadata about a track, populated from Symphonia tag data.
@@ -24,9 +29,10 @@ pub struct DeviceInfo {
 
 /// The canonical event type that every component emits.
 ///
-/// Consumers receive events through a channel obtained from
-/// [`Engine::events()`].  The channel is **multi-producer, single-consumer**:
-/// each `Engine` instance owns one sender; callers receive a receiver clone.
+/// Consumers receive events through the bounded bus obtained from
+/// [`crate::engine::AudioEngine::events`] (see [`crate::event_bus`]).  Any
+/// number of components publish; receiver clones share one stream, so each
+/// event reaches exactly one of them.
 ///
 /// All variants are intentionally `Clone` so events can be fanned out to
 /// multiple listeners (e.g., UI thread + logging thread) without heap
@@ -46,6 +52,14 @@ pub enum AudioEvent {
     PlaybackStopped,
     /// A new track has become the active source.
     TrackChanged { metadata: TrackMetadata },
+    /// The source passed to `set_source` has been opened and probed in the
+    /// background.  Fields are `None` when the container does not declare
+    /// them.
+    SourceLoaded {
+        duration:    Option<Duration>,
+        sample_rate: Option<u32>,
+        channels:    Option<usize>,
+    },
 
     // ── Queue ─────────────────────────────────────────────────────────────
     /// The playback queue has been exhausted.
@@ -85,17 +99,134 @@ pub enum AudioEvent {
         current: Duration,
         total:   Option<Duration>,
     },
+
+    // ── Track analysis ────────────────────────────────────────────────────
+    /// A batch analysis is part-way through `path`.  `percent` is `None`
+    /// when the duration is unknown; `bpm` is the estimate so far.
+    AnalysisProgress {
+        job:     u64,
+        path:    String,
+        percent: Option<f32>,
+        bpm:     Option<f32>,
+    },
+    /// A batch analysis finished (or failed on) `path`.
+    AnalysisResult {
+        job:      u64,
+        path:     String,
+        analysis: Result<Arc<TrackAnalysis>, String>,
+    },
+    /// Every track of a batch analysis is done or the batch was cancelled.
+    AnalysisFinished { job: u64 },
+
+    // ── Scheduling ────────────────────────────────────────────────────────
+    /// Scheduled command `id` ran at output `frame`, `late_frames` after the
+    /// frame it was due at (0 unless it was scheduled in the past).
+    ScheduleFired {
+        id:          u32,
+        command:     i32,
+        frame:       u64,
+        late_frames: u64,
+    },
 }
 
 // ── Channel helpers ───────────────────────────────────────────────────────────
 
-/// Sender half of the event channel.
-pub type EventSender = std::sync::mpsc::Sender<AudioEvent>;
+pub use crate::event_bus::{event_channel, EventReceiver, EventSender};
+
+// ── FFI encoding ──────────────────────────────────────────────────────────────
+
+impl AudioEvent {
+    /// The `EVENT_*` code identifying this variant over FFI.
+    pub fn kind(&self) -> i32 {
+        match self {
+            Self::PlaybackStarted           => EVENT_PLAYBACK_STARTED,
+            Self::PlaybackPaused { .. }     => EVENT_PLAYBACK_PAUSED,
+            Self::PlaybackResumed { .. }    => EVENT_PLAYBACK_RESUMED,
+            Self::PlaybackFinished          => EVENT_PLAYBACK_FINISHED,
+            Self::PlaybackStopped           => EVENT_PLAYBACK_STOPPED,
+            Self::TrackChanged { .. }       => EVENT_TRACK_CHANGED,
+            Self::SourceLoaded { .. }       => EVENT_SOURCE_LOADED,
+            Self::QueueExhausted            => EVENT_QUEUE_EXHAUSTED,
+            Self::QueueUpdated { .. }       => EVENT_QUEUE_UPDATED,
+            Self::Error(_)                  => EVENT_ERROR,
+            Self::Underrun { .. }           => EVENT_UNDERRUN,
+            Self::DecoderWarning(_)         => EVENT_DECODER_WARNING,
+            Self::Buffering { .. }          => EVENT_BUFFERING,
+            Self::BufferingComplete         => EVENT_BUFFERING_COMPLETE,
+            Self::Reconnecting { .. }       => EVENT_RECONNECTING,
+            Self::StreamMetadata(_)         => EVENT_STREAM_METADATA,
+            Self::DeviceAdded(_)            => EVENT_DEVICE_ADDED,
+            Self::DeviceRemoved(_)          => EVENT_DEVICE_REMOVED,
+            Self::DefaultDeviceChanged(_)   => EVENT_DEFAULT_DEVICE_CHANGED,
+            Self::Position { .. }           => EVENT_POSITION,
+            Self::AnalysisProgress { .. }   => EVENT_ANALYSIS_PROGRESS,
+            Self::AnalysisResult { .. }     => EVENT_ANALYSIS_RESULT,
+            Self::AnalysisFinished { .. }   => EVENT_ANALYSIS_FINISHED,
+            Self::ScheduleFired { .. }      => EVENT_SCHEDULE_FIRED,
+        }
+    }
 
-/// Receiver half of the event channel.
-pub type EventReceiver = std::sync::mpsc::Receiver<AudioEvent>;
+    /// JSON object with a `kind` code and the variant's fields, durations
+    /// in milliseconds.
+    pub fn to_json(&self) -> serde_json::Value {
+        let millis = |d: &Duration| d.as_millis() as u64;
+        let device = |d: &DeviceInfo| json!({ "name": d.name, "is_default": d.is_default });
 
-/// Create a new event channel pair.
-pub fn event_channel() -> (EventSender, EventReceiver) {
-    std::sync::mpsc::channel()
+        let mut value = match self {
+            Self::PlaybackPaused { position } | Self::PlaybackResumed { position } => {
+                json!({ "position_ms": millis(position) })
+            }
+            Self::TrackChanged { metadata } => json!({
+                "title":  metadata.title,
+                "artist": metadata.artist,
+                "album":  metadata.album,
+                "track":  metadata.track,
+                "year":   metadata.year,
+                "extra":  metadata.extra,
+            }),
+            Self::SourceLoaded { duration, sample_rate, channels } => json!({
+                "duration_ms": duration.as_ref().map(millis),
+                "sample_rate": sample_rate,
+                "channels":    channels,
+            }),
+            Self::QueueUpdated { len }       => json!({ "len": len }),
+            Self::Error(err)                 => json!({ "message": err.to_string() }),
+            Self::Underrun { count }         => json!({ "count": count }),
+            Self::DecoderWarning(message)    => json!({ "message": message }),
+            Self::Buffering { percent }      => json!({ "percent": percent }),
+            Self::Reconnecting { attempt }   => json!({ "attempt": attempt }),
+            Self::StreamMetadata(tags)       => json!({ "tags": tags }),
+            Self::DeviceAdded(info)
+            | Self::DeviceRemoved(info)
+            | Self::DefaultDeviceChanged(info) => device(info),
+            Self::Position { current, total } => json!({
+                "current_ms": millis(current),
+                "total_ms":   total.as_ref().map(millis),
+            }),
+            Self::AnalysisProgress { job, path, percent, bpm } => json!({
+                "job":     job,
+                "path":    path,
+                "percent": percent,
+                "bpm":     bpm,
+            }),
+            Self::AnalysisResult { job, path, analysis } => match analysis {
+                Ok(analysis) => json!({ "job": job, "path": path, "analysis": analysis.summary_json() }),
+                Err(message) => json!({ "job": job, "path": path, "message": message }),
+            },
+            Self::AnalysisFinished { job }   => json!({ "job": job }),
+            Self::ScheduleFired { id, command, frame, late_frames } => json!({
+                "id":          id,
+                "command":     command,
+                "frame":       frame,
+                "late_frames": late_frames,
+            }),
+            Self::PlaybackStarted
+            | Self::PlaybackFinished
+            | Self::PlaybackStopped
+            | Self::QueueExhausted
+            | Self::BufferingComplete => json!({}),
+        };
+        value["kind"] = json!(self.kind());
+        value
+    }
 }
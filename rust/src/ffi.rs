@@ -17,15 +17,28 @@
 
 use std::ffi::CStr;
 use std::os::raw::c_char;
-use std::sync::Mutex;
+use std::sync::atomic::AtomicBool;
+use std::sync::{Arc, Mutex};
+use std::time::Duration;
 
 use once_cell::sync::Lazy;
 
 use crate::{
-    engine::AudioEngine,
+    analysis,
+    capture::CaptureFormat,
+    convolver::{ConvolutionIr, ConvolutionSpec},
+    engine::{decode_source_to_output, AudioEngine},
     error, info,
-    player_state::PlayerState,
+    enums::{
+        CAPTURE_FORMAT_WAV_F32, CAPTURE_FORMAT_WAV_PCM16, CONVOLVER_BLOCK_FRAMES,
+        CONVOLVER_MAX_IR_SECONDS, QUEUE_STORAGE_F16, QUEUE_STORAGE_F32, QUEUE_STORAGE_I16,
+        SOURCE_LOAD_FAILED, SOURCE_LOAD_IDLE, SOURCE_LOAD_LOADING, SOURCE_LOAD_READY,
+    },
+    player_state::{LoadState, PlayerState},
+    sample_queue::QueueStorage,
+    schedule::{self, Due, ScheduledCommand},
     source::AudioSource,
+    thread_priority::{self, ThreadRole},
 };
 
 // ── Singleton engine ──────────────────────────────────────────────────────────
@@ -72,9 +85,9 @@ where
 }
 
 /// Like `with_engine` but maps `Result<(), String>` → `i32` (0 ok, -1 err).
-fn with_engine_mut<F>(mut f: F) -> i32
+fn with_engine_mut<F>(f: F) -> i32
 where
-    F: FnMut(&mut AudioEngine) -> Result<(), String>,
+    F: FnOnce(&mut AudioEngine) -> Result<(), String>,
 {
     let mut guard = match ENGINE.lock() {
         Ok(g) => g,
@@ -149,6 +162,32 @@ fn c_string(ptr: *const c_char) -> Option<String> {
     unsafe { CStr::from_ptr(ptr) }.to_str().ok().map(ToOwned::to_owned)
 }
 
+/// Copy `text` into a caller-provided buffer as a NUL-terminated C string.
+///
+/// Returns the number of bytes written (excluding the terminator), or `-2`
+/// if the buffer is too small.
+fn write_c_string(text: &str, buffer: *mut c_char, max_len: i32) -> i32 {
+    let bytes = text.as_bytes();
+    let copy_len = bytes.len() as i32;
+
+    if copy_len <= 0 || copy_len >= max_len {
+        return -2; // Need space for the null terminator.
+    }
+
+    // SAFETY: buffer is valid for max_len bytes (caller contract) and
+    // copy_len + 1 <= max_len (checked above).
+    unsafe {
+        std::ptr::copy_nonoverlapping(
+            bytes.as_ptr() as *const c_char,
+            buffer,
+            copy_len as usize,
+        );
+        *buffer.add(copy_len as usize) = 0;
+    }
+
+    copy_len
+}
+
 // ── Device query ──────────────────────────────────────────────────────────────
 
 #[unsafe(no_mangle)]
@@ -199,6 +238,21 @@ pub extern "C" fn audiopc_set_source_url(url: *const c_char) -> i32 {
     })
 }
 
+/// Set a live Icecast/SHOUTcast or HLS (`.m3u8`) stream as the source.  The
+/// stream is buffered, reconnects automatically and cannot seek.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_set_source_live(url: *const c_char) -> i32 {
+    let Some(url) = c_string(url) else {
+        error!("Live stream URL is null or invalid UTF-8");
+        return -2;
+    };
+
+    with_engine_mut(|engine| {
+        engine.set_source(AudioSource::Live(url.clone()));
+        Ok(())
+    })
+}
+
 #[unsafe(no_mangle)]
 pub extern "C" fn audiopc_set_source_memory(data: *const u8, len: i32) -> i32 {
     if data.is_null() || len <= 0 {
@@ -221,7 +275,7 @@ pub extern "C" fn audiopc_set_source_memory(data: *const u8, len: i32) -> i32 {
 pub extern "C" fn audiopc_play() -> i32 {
     with_engine_mut(|engine| {
         engine.ensure_stream()?;
-        engine.start_decode_thread_if_needed()?;
+        engine.start_decoder_if_needed()?;
         engine.set_playing(true);
         Ok(())
     })
@@ -280,11 +334,46 @@ pub extern "C" fn audiopc_set_max_queue_seconds(seconds: i32) -> i32 {
     })
 }
 
+/// Enable (non-zero) or disable (0) TPDF dither on integer output formats.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_set_output_dither(enabled: i32) -> i32 {
+    with_engine_mut(|engine| {
+        engine.set_output_dither(enabled != 0);
+        Ok(())
+    })
+}
+
 #[unsafe(no_mangle)]
 pub extern "C" fn audiopc_get_max_queue_seconds() -> i32 {
     with_engine_ref(|engine| engine.max_queue_seconds())
 }
 
+/// Choose how decoded samples are queued: `QUEUE_STORAGE_F32`,
+/// `QUEUE_STORAGE_I16` or `QUEUE_STORAGE_F16`.  The 16-bit modes halve the
+/// memory of long queues.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_set_queue_storage(mode: i32) -> i32 {
+    let storage = match mode {
+        QUEUE_STORAGE_F32 => QueueStorage::F32,
+        QUEUE_STORAGE_I16 => QueueStorage::I16,
+        QUEUE_STORAGE_F16 => QueueStorage::F16,
+        _ => {
+            error!("Unknown queue storage mode {mode}");
+            return -2;
+        }
+    };
+    with_engine_mut(|engine| {
+        engine.set_queue_storage(storage);
+        Ok(())
+    })
+}
+
+/// Bytes allocated for the decoded sample queue.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_queue_bytes() -> i64 {
+    with_engine(|engine| engine.queue_bytes())
+}
+
 #[unsafe(no_mangle)]
 pub extern "C" fn audiopc_buffered_samples() -> i32 {
     with_engine_ref(|engine| engine.buffered_samples())
@@ -310,11 +399,99 @@ pub extern "C" fn audiopc_duration_millis() -> i32 {
     with_engine_ref(|engine| engine.duration_millis())
 }
 
+/// Progress of the background load started by the last `set_source` call
+/// (one of the `SOURCE_LOAD_*` constants).
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_source_load_state() -> i32 {
+    with_engine_ref(|engine| match engine.source_load_state() {
+        LoadState::Idle    => SOURCE_LOAD_IDLE,
+        LoadState::Loading => SOURCE_LOAD_LOADING,
+        LoadState::Ready   => SOURCE_LOAD_READY,
+        LoadState::Failed  => SOURCE_LOAD_FAILED,
+    })
+}
+
 #[unsafe(no_mangle)]
 pub extern "C" fn audiopc_position_millis() -> i32 {
     with_engine_ref(|engine| engine.position_millis())
 }
 
+// ── Scheduling ────────────────────────────────────────────────────────────────
+//
+// Dart binds the three clock queries as leaf calls (see `ffigen.yaml`).
+
+/// Current host time (ns): the time base of `audiopc_schedule_at_time` and
+/// the clock queries, shared by everything in the process.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_clock_now_ns() -> i64 {
+    schedule::host_now_ns() as i64
+}
+
+/// Output frame (engine sample time) heard at host time `host_ns`, or -1
+/// until the output has started.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_clock_frame_at(host_ns: i64) -> i64 {
+    if host_ns < 0 {
+        return -2;
+    }
+    with_engine(|engine| engine.clock_frame_at(host_ns as u64).map_or(-1, |frame| frame.max(0)))
+}
+
+/// Host time (ns) at which output frame `frame` is heard, or -1 until the
+/// output has started.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_clock_time_at(frame: i64) -> i64 {
+    if frame < 0 {
+        return -2;
+    }
+    with_engine(|engine| engine.clock_host_ns_at(frame).unwrap_or(-1))
+}
+
+fn schedule_command(command: i32, value: f64, due: Due) -> i32 {
+    let Some(command) = ScheduledCommand::from_code(command, value) else {
+        error!("Unknown schedule command {command} or invalid value {value}");
+        return -2;
+    };
+    with_engine_mut_i32(|engine| engine.schedule(command, due).map(|id| id as i32))
+}
+
+/// Run `command` (`SCHEDULE_*`, taking `value` as its argument) when output
+/// frame `frame` is heard, splitting the callback block at that sample.
+/// Starts the output if needed.  Returns the command's id (> 0), which tags
+/// its `EVENT_SCHEDULE_FIRED` event.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_schedule(command: i32, value: f64, frame: i64) -> i32 {
+    if frame < 0 {
+        return -2;
+    }
+    schedule_command(command, value, Due::Frame(frame as u64))
+}
+
+/// Like `audiopc_schedule`, due at host time `host_ns` (see
+/// `audiopc_clock_now_ns`).
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_schedule_at_time(command: i32, value: f64, host_ns: i64) -> i32 {
+    if host_ns < 0 {
+        return -2;
+    }
+    schedule_command(command, value, Due::HostNs(host_ns as u64))
+}
+
+/// Cancel scheduled command `id`.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_cancel_scheduled(id: i32) -> i32 {
+    if id <= 0 {
+        return -2;
+    }
+    with_engine_mut(|engine| engine.cancel_scheduled(id as u32))
+}
+
+/// Cancel every scheduled command.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_clear_schedule() -> i32 {
+    with_engine_mut(|engine| engine.clear_schedule())
+}
+
 // ── Player state ──────────────────────────────────────────────────────────────
 
 #[unsafe(no_mangle)]
@@ -332,7 +509,46 @@ pub unsafe extern "C" fn audiopc_get_player_state() -> i32 {
     })
 }
 
+// ── Events ────────────────────────────────────────────────────────────────────
+
+/// Wait up to `timeout_ms` for the next engine event and write it into
+/// `buffer` as JSON: `{"kind": EVENT_*, ...fields}`.
+///
+/// Blocks without holding the engine lock, so call it from a dedicated
+/// thread or isolate.  `buffer` should hold `EVENT_JSON_MAX_BYTES`.
+/// Returns the JSON length, 0 on timeout, -2 for bad arguments or an event
+/// that did not fit (it is discarded), -500 if the engine is unavailable.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_wait_event(buffer: *mut c_char, max_len: i32, timeout_ms: i32) -> i32 {
+    if buffer.is_null() || max_len <= 0 || timeout_ms < 0 {
+        error!("Event buffer is null, or max_len/timeout_ms is invalid");
+        return -2;
+    }
+    let Some(events) = with_engine(|engine| Some(engine.events())) else {
+        return -500;
+    };
+    match events.recv_timeout(Duration::from_millis(timeout_ms as u64)) {
+        Some(event) => {
+            let written = write_c_string(&event.to_json().to_string(), buffer, max_len);
+            if written < 0 {
+                error!("Event of kind {} does not fit in {max_len} bytes", event.kind());
+            }
+            written
+        }
+        None => 0,
+    }
+}
+
+/// Events discarded so far because nobody drained the bus in time.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_dropped_event_count() -> i64 {
+    with_engine(|engine| engine.events().dropped() as i64)
+}
+
 // ── Visualizer ────────────────────────────────────────────────────────────────
+//
+// Dart binds these as leaf calls (see `ffigen.yaml`): they must stay short,
+// never block for long and never call back into Dart.
 
 #[unsafe(no_mangle)]
 pub extern "C" fn audiopc_visualizer_available_samples() -> i32 {
@@ -398,24 +614,7 @@ pub extern "C" fn audiopc_get_metadata(
             Ok(j) => j,
             Err(e) => { error!("Failed to get metadata: {e}"); return -1; }
         };
-        let bytes = json.as_bytes();
-        let copy_len = bytes.len() as i32;
-
-        if copy_len <= 0 || copy_len >= max_len {
-            return -2; // Need space for the null terminator.
-        }
-
-        // SAFETY: buffer is valid and large enough (checked above).
-        unsafe {
-            std::ptr::copy_nonoverlapping(
-                bytes.as_ptr() as *const c_char,
-                buffer,
-                copy_len as usize,
-            );
-            *buffer.add(copy_len as usize) = 0;
-        }
-
-        bytes.len() as i32
+        write_c_string(&json, buffer, max_len)
     })
 }
 
@@ -493,4 +692,353 @@ pub extern "C" fn audiopc_set_lowpass_hz(cutoff_hz: f64, q: f32) -> i32 {
 #[unsafe(no_mangle)]
 pub extern "C" fn audiopc_set_high_pass_filter(cutoff_hz: f32, q: f32) -> i32 {
     with_engine_mut(|engine| { engine.set_high_pass_filter(cutoff_hz, q); Ok(()) })
-}
\ No newline at end of file
+}
+
+// ── Convolution ───────────────────────────────────────────────────────────────
+
+/// Decode and transform an impulse response without holding the engine
+/// lock, then install it.
+fn load_convolution(source: AudioSource, wet: f32, dry: f32) -> i32 {
+    let (channels, sample_rate) = with_engine(|engine| engine.output_format());
+    if channels == 0 || sample_rate == 0 {
+        return -1;
+    }
+
+    let max_samples = (sample_rate as usize)
+        .saturating_mul(channels)
+        .saturating_mul(CONVOLVER_MAX_IR_SECONDS);
+    let ir = decode_source_to_output(source, channels, sample_rate, max_samples)
+        .and_then(|pcm| ConvolutionIr::new(&pcm, channels, CONVOLVER_BLOCK_FRAMES));
+    let ir = match ir {
+        Ok(ir) => Arc::new(ir),
+        Err(e) => { error!("Failed to load impulse response: {e}"); return -1; }
+    };
+
+    with_engine_mut(|engine| {
+        engine.set_convolution(ConvolutionSpec::new(Arc::clone(&ir), wet, dry));
+        Ok(())
+    })
+}
+
+/// Convolve the output with the impulse response in the file at `path`.
+/// Blocks while the IR is decoded and transformed.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_set_convolution_ir_path(path: *const c_char, wet: f32, dry: f32) -> i32 {
+    let Some(path) = c_string(path) else {
+        error!("Impulse response path is null or invalid UTF-8");
+        return -2;
+    };
+    load_convolution(AudioSource::Path(path), wet, dry)
+}
+
+/// Convolve the output with an impulse response given as `len` encoded
+/// bytes.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_set_convolution_ir_memory(
+    data: *const u8,
+    len:  i32,
+    wet:  f32,
+    dry:  f32,
+) -> i32 {
+    if data.is_null() || len <= 0 {
+        error!("Impulse response pointer is null or length is non-positive");
+        return -2;
+    }
+
+    // SAFETY: Caller must provide a valid pointer for `len` bytes.
+    let bytes = unsafe { std::slice::from_raw_parts(data, len as usize) }.to_vec();
+    load_convolution(AudioSource::Memory(bytes), wet, dry)
+}
+
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_set_convolution_mix(wet: f32, dry: f32) -> i32 {
+    with_engine_mut(|engine| engine.set_convolution_mix(wet, dry))
+}
+
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_clear_convolution() -> i32 {
+    with_engine_mut(|engine| {
+        engine.clear_convolution();
+        Ok(())
+    })
+}
+
+// ── Sample bank ───────────────────────────────────────────────────────────────
+
+/// Decode `source` without holding the engine lock, then cache it.
+fn preload_sample(key: String, source: AudioSource) -> i32 {
+    let (channels, sample_rate, max_samples) = with_engine(|engine| {
+        let (channels, sample_rate) = engine.output_format();
+        (channels, sample_rate, engine.sample_bank_max_samples())
+    });
+    if channels == 0 || sample_rate == 0 {
+        return -1;
+    }
+
+    let pcm = match decode_source_to_output(source, channels, sample_rate, max_samples) {
+        Ok(pcm) => pcm,
+        Err(e) => { error!("Failed to preload sample '{key}': {e}"); return -1; }
+    };
+
+    with_engine_mut(|engine| engine.insert_sample(key, pcm))
+}
+
+/// Decode the file at `path` once and cache it under `key`.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_preload_sample_path(key: *const c_char, path: *const c_char) -> i32 {
+    let (Some(key), Some(path)) = (c_string(key), c_string(path)) else {
+        error!("Sample key or path is null or invalid UTF-8");
+        return -2;
+    };
+    preload_sample(key, AudioSource::Path(path))
+}
+
+/// Decode `len` encoded bytes once and cache them under `key`.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_preload_sample_memory(
+    key:  *const c_char,
+    data: *const u8,
+    len:  i32,
+) -> i32 {
+    let Some(key) = c_string(key) else {
+        error!("Sample key is null or invalid UTF-8");
+        return -2;
+    };
+    if data.is_null() || len <= 0 {
+        error!("Sample memory pointer is null or length is non-positive");
+        return -2;
+    }
+
+    // SAFETY: Caller must provide a valid pointer for `len` bytes.
+    let bytes = unsafe { std::slice::from_raw_parts(data, len as usize) }.to_vec();
+    preload_sample(key, AudioSource::Memory(bytes))
+}
+
+/// Play the sound cached under `key` on top of the current source.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_play_sample(key: *const c_char, gain: f32) -> i32 {
+    let Some(key) = c_string(key) else {
+        error!("Sample key is null or invalid UTF-8");
+        return -2;
+    };
+    with_engine_mut(|engine| engine.play_sample(&key, gain))
+}
+
+/// Remove the sound cached under `key`.  Returns `-1` if there was none.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_unload_sample(key: *const c_char) -> i32 {
+    let Some(key) = c_string(key) else {
+        error!("Sample key is null or invalid UTF-8");
+        return -2;
+    };
+    with_engine_mut(|engine| {
+        if engine.unload_sample(&key) { Ok(()) } else { Err(format!("No sample cached under '{key}'")) }
+    })
+}
+
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_clear_sample_bank() -> i32 {
+    with_engine_mut(|engine| {
+        engine.clear_sample_bank();
+        Ok(())
+    })
+}
+
+/// Set the sample bank's memory budget in bytes, evicting least recently
+/// used sounds if it is exceeded.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_set_sample_bank_budget(bytes: i64) -> i32 {
+    if bytes < 0 {
+        error!("Sample bank budget must not be negative");
+        return -2;
+    }
+    with_engine_mut(|engine| {
+        engine.set_sample_bank_budget(bytes as usize);
+        Ok(())
+    })
+}
+
+/// Bytes currently held by cached sounds.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_sample_bank_bytes() -> i64 {
+    with_engine(|engine| engine.sample_bank_bytes() as i64)
+}
+
+// ── Capture ───────────────────────────────────────────────────────────────────
+
+/// Record the input device `device_name` (null for the system default) to a
+/// WAV file at `path`, replacing any running capture.  `format` is
+/// `CAPTURE_FORMAT_WAV_PCM16` or `CAPTURE_FORMAT_WAV_F32`; a non-zero
+/// `monitor` also plays the input through the effect chains.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_start_capture(
+    path:        *const c_char,
+    device_name: *const c_char,
+    format:      i32,
+    monitor:     i32,
+) -> i32 {
+    let Some(path) = c_string(path) else {
+        error!("Capture path is null or invalid UTF-8");
+        return -2;
+    };
+    let format = match format {
+        CAPTURE_FORMAT_WAV_PCM16 => CaptureFormat::WavPcm16,
+        CAPTURE_FORMAT_WAV_F32   => CaptureFormat::WavF32,
+        _ => {
+            error!("Unknown capture format {format}");
+            return -2;
+        }
+    };
+    let device_name = c_string(device_name);
+    with_engine_mut(|engine| engine.start_capture(&path, device_name.as_deref(), format, monitor != 0))
+}
+
+/// Stop the running capture and finalise its file.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_stop_capture() -> i32 {
+    with_engine_mut(|engine| engine.stop_capture())
+}
+
+/// Start (non-zero) or stop (0) monitoring the running capture.  Fails when
+/// the input could not be opened at the output sample rate.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_set_capture_monitor(enabled: i32) -> i32 {
+    with_engine_mut(|engine| engine.set_capture_monitor(enabled != 0))
+}
+
+/// Input frames the running capture dropped because the writer fell
+/// behind, or -1 when nothing is being captured.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_capture_dropped_frames() -> i64 {
+    with_engine(|engine| engine.capture_dropped_frames())
+}
+
+/// Write the running capture's state (frames, drops, backlogs) as JSON into
+/// `buffer`.  Returns -1 when nothing is being captured.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_get_capture_stats(buffer: *mut c_char, max_len: i32) -> i32 {
+    if buffer.is_null() || max_len <= 0 {
+        error!("Capture stats buffer is null or max_len is non-positive");
+        return -2;
+    }
+    with_engine_ref(|engine| match engine.capture_stats_json() {
+        Some(json) => write_c_string(&json, buffer, max_len),
+        None => -1,
+    })
+}
+
+// ── Track analysis ────────────────────────────────────────────────────────────
+
+/// Analyse the file or URL at `path` (tempo, beat grid, onsets) and write
+/// the result as JSON into `buffer`.  Blocks while decoding unless the
+/// result is cached; the engine is not needed.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_analyze_track(path: *const c_char, buffer: *mut c_char, max_len: i32) -> i32 {
+    let Some(path) = c_string(path) else {
+        error!("Analysis path is null or invalid UTF-8");
+        return -2;
+    };
+    if buffer.is_null() || max_len <= 0 {
+        error!("Analysis buffer is null or max_len is non-positive");
+        return -2;
+    }
+    match analysis::analyse_track(&path, &AtomicBool::new(false), |_, _| {}) {
+        Ok(result) => write_c_string(&result.to_json().to_string(), buffer, max_len),
+        Err(e) => { error!("Analysis of '{path}' failed: {e}"); -1 }
+    }
+}
+
+/// Analyse the paths in the JSON array `paths_json` in the background on up
+/// to `threads` threads (0 = one per core).  Returns the job id (> 0) that
+/// tags its `EVENT_ANALYSIS_*` events.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_start_analysis(paths_json: *const c_char, threads: i32) -> i32 {
+    let paths = c_string(paths_json).and_then(|json| serde_json::from_str::<Vec<String>>(&json).ok());
+    let Some(paths) = paths else {
+        error!("Analysis paths must be a JSON array of strings");
+        return -2;
+    };
+    if paths.is_empty() || threads < 0 {
+        error!("Analysis needs at least one path and a non-negative thread count");
+        return -2;
+    }
+    with_engine_mut_i32(|engine| {
+        let job = engine.start_analysis(paths.clone(), threads as usize)?;
+        i32::try_from(job).map_err(|_| "Analysis job ids exhausted".to_string())
+    })
+}
+
+/// Cancel a batch analysis started by `audiopc_start_analysis`.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_cancel_analysis(job: i32) -> i32 {
+    if job <= 0 {
+        return -2;
+    }
+    with_engine_mut(|engine| engine.cancel_analysis(job as u64))
+}
+
+/// Forget every cached analysis result.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_clear_analysis_cache() -> i32 {
+    analysis::clear_cache();
+    0
+}
+
+// ── Thread priority ───────────────────────────────────────────────────────────
+
+/// Request (non-zero) or drop (0) elevated priority for the output callback
+/// and decode workers.  Linux only; applied by each thread on its next
+/// iteration, so it works before or after the engine is initialised.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_set_realtime_priority(enabled: i32) -> i32 {
+    thread_priority::set_enabled(enabled != 0);
+    0
+}
+
+/// Priority most recently obtained by the threads of `role`
+/// (`THREAD_ROLE_*`), as a `THREAD_PRIORITY_*` code.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_thread_priority(role: i32) -> i32 {
+    match ThreadRole::from_code(role) {
+        Some(role) => thread_priority::status(role),
+        None => {
+            error!("Unknown thread role {role}");
+            -2
+        }
+    }
+}
+
+// ── Telemetry ─────────────────────────────────────────────────────────────────
+
+/// Write a JSON snapshot of the engine's runtime metrics into `buffer`.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_get_metrics(buffer: *mut c_char, max_len: i32) -> i32 {
+    if buffer.is_null() || max_len <= 0 {
+        error!("Metrics buffer is null or max_len is non-positive");
+        return -2;
+    }
+    with_engine_ref(|engine| write_c_string(&engine.metrics_json(), buffer, max_len))
+}
+
+/// Export the recent callback history as a Chrome trace-event JSON file.
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_write_metrics_trace(path: *const c_char) -> i32 {
+    let Some(path) = c_string(path) else {
+        error!("Trace path is null or invalid UTF-8");
+        return -2;
+    };
+    with_engine_ref(|engine| match engine.write_metrics_trace(&path) {
+        Ok(()) => 0,
+        Err(e) => { error!("{e}"); -1 }
+    })
+}
+
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_reset_metrics() -> i32 {
+    with_engine_ref(|engine| { engine.reset_metrics(); 0 })
+}
+
+#[unsafe(no_mangle)]
+pub extern "C" fn audiopc_underrun_count() -> i32 {
+    with_engine_ref(|engine| engine.underrun_count())
+}
@@ -1,7 +1,12 @@
 use std::io::{Read, Seek, SeekFrom};
+use std::thread;
+use std::time::Duration;
+
 use reqwest::blocking::Client;
 use symphonia::core::io::MediaSource;
 
+use crate::enums::{HTTP_READ_RETRIES, HTTP_RETRY_BASE_MS};
+
 pub struct HttpStream {
    pub url: reqwest::Url,
    pub client: Client,
@@ -43,11 +48,63 @@ impl HttpStream {
             .map_err(|e| std::io::Error::new(std::io::ErrorKind::Other, e))?
             .error_for_status()
             .map_err(|e| std::io::Error::new(std::io::ErrorKind::Other, e))?;
-        
+
+        // A server that ignores `Range` answers 200 with the file from byte
+        // 0, which is only what was asked for when `start` is 0.
+        let served_from = match res.status() {
+            reqwest::StatusCode::PARTIAL_CONTENT => content_range_start(&res),
+            _ => Some(0),
+        };
+        if served_from != Some(start) {
+            return Err(std::io::Error::new(
+                std::io::ErrorKind::InvalidData,
+                format!("Server did not honour Range from byte {start} (status {})", res.status()),
+            ));
+        }
+
         self.response = Some(res);
         self.pos = start;
         Ok(())
     }
+
+    /// Re-request from `pos` after a failed read, up to `HTTP_READ_RETRIES`
+    /// times with a growing delay, and read into `buf` from the new
+    /// response.
+    fn resume(&mut self, buf: &mut [u8], error: std::io::Error) -> std::io::Result<usize> {
+        let mut last = error;
+        for attempt in 1..=HTTP_READ_RETRIES {
+            thread::sleep(Duration::from_millis(HTTP_RETRY_BASE_MS * u64::from(attempt)));
+            let retried = self.send_range_request(self.pos).and_then(|()| match self.response.as_mut() {
+                Some(res) => res.read(buf),
+                None => Ok(0),
+            });
+            match retried {
+                Ok(n) => return Ok(n),
+                // Asking again will not make the server honour the range.
+                Err(e) if e.kind() == std::io::ErrorKind::InvalidData => {
+                    self.response = None;
+                    return Err(e);
+                }
+                Err(e) => last = e,
+            }
+        }
+        self.response = None;
+        Err(last)
+    }
+}
+
+/// First byte of a `Content-Range: bytes <first>-<last>/<len>` header.
+fn content_range_start(res: &reqwest::blocking::Response) -> Option<u64> {
+    res.headers()
+        .get(reqwest::header::CONTENT_RANGE)?
+        .to_str()
+        .ok()?
+        .strip_prefix("bytes ")?
+        .split('-')
+        .next()?
+        .trim()
+        .parse()
+        .ok()
 }
 
 impl Read for HttpStream {
@@ -58,7 +115,11 @@ impl Read for HttpStream {
 
         match self.response.as_mut() {
             Some(res) => {
-                let bytes_read = res.read(buf)?;
+                let bytes_read = match res.read(buf) {
+                    Ok(n) => n,
+                    // A dropped connection resumes from the current offset.
+                    Err(e) => self.resume(buf, e)?,
+                };
                 if bytes_read == 0 {
                     // End of stream
                     self.response = None;
@@ -113,4 +174,110 @@ impl MediaSource for HttpStream {
     fn byte_len(&self) -> Option<u64> {
         self.len
     }
-}
\ No newline at end of file
+}
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::io::Write;
+    use std::net::{Shutdown, TcpListener, TcpStream};
+
+    const LEN:     usize = 64 * 1024;
+    const DROP_AT: usize = 16 * 1024;
+
+    /// Byte `offset` of the served file.
+    fn pattern(offset: usize) -> u8 {
+        ((offset as u32).wrapping_mul(2_654_435_761) >> 24) as u8
+    }
+
+    /// Loopback stand-in for a static file server.  The first GET is cut
+    /// off after `DROP_AT` bytes; later ones honour `Range` unless
+    /// `ignore_range` is set, in which case they answer 200 from byte 0.
+    fn serve(ignore_range: bool) -> String {
+        let listener = TcpListener::bind("127.0.0.1:0").unwrap();
+        let url      = format!("http://{}/file", listener.local_addr().unwrap());
+        thread::spawn(move || {
+            let mut gets = 0;
+            for socket in listener.incoming() {
+                let Ok(mut socket) = socket else { continue };
+                let (method, range) = read_request(&mut socket);
+                let file: Vec<u8> = (0..LEN).map(pattern).collect();
+                if method == "HEAD" {
+                    let _ = write!(socket, "HTTP/1.1 200 OK\r\nContent-Length: {LEN}\r\nConnection: close\r\n\r\n");
+                    continue;
+                }
+                gets += 1;
+                let honour = gets == 1 || !ignore_range;
+                let start  = if honour { range } else { 0 };
+                let head = if honour {
+                    format!(
+                        "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes {start}-{}/{LEN}\r\n",
+                        LEN - 1,
+                    )
+                } else {
+                    "HTTP/1.1 200 OK\r\n".to_string()
+                };
+                let end = if gets == 1 { DROP_AT } else { LEN };
+                let _ = write!(socket, "{head}Content-Length: {}\r\nConnection: close\r\n\r\n", LEN - start);
+                let _ = socket.write_all(&file[start..end]);
+                let _ = socket.shutdown(Shutdown::Both);
+            }
+        });
+        url
+    }
+
+    /// Read the request head and return its method and `Range` start.
+    fn read_request(socket: &mut TcpStream) -> (String, usize) {
+        let mut head = Vec::new();
+        let mut byte = [0u8; 1];
+        while !head.ends_with(b"\r\n\r\n") && socket.read(&mut byte).unwrap_or(0) == 1 {
+            head.push(byte[0]);
+        }
+        let head   = String::from_utf8_lossy(&head).to_string();
+        let method = head.split_whitespace().next().unwrap_or("").to_string();
+        let range  = head
+            .lines()
+            .find_map(|line| line.to_ascii_lowercase().strip_prefix("range: bytes=").map(str::to_string))
+            .and_then(|r| r.trim_end_matches('-').parse().ok())
+            .unwrap_or(0);
+        (method, range)
+    }
+
+    /// Read until end of stream or the first error, checking every byte
+    /// against the file at its offset.
+    fn read_all(stream: &mut HttpStream) -> (usize, std::io::Result<()>) {
+        let mut buf  = [0u8; 4_096];
+        let mut read = 0;
+        loop {
+            match stream.read(&mut buf) {
+                Ok(0) => return (read, Ok(())),
+                Ok(n) => {
+                    for (i, &b) in buf[..n].iter().enumerate() {
+                        assert_eq!(b, pattern(read + i), "byte {}", read + i);
+                    }
+                    read += n;
+                }
+                Err(e) => return (read, Err(e)),
+            }
+        }
+    }
+
+    /// A dropped read resumes from the current offset.
+    #[test]
+    fn dropped_read_resumes_with_a_range_request() {
+        let mut stream = HttpStream::new(&serve(false)).unwrap();
+        assert_eq!(stream.len, Some(LEN as u64));
+        let (read, result) = read_all(&mut stream);
+        result.unwrap();
+        assert_eq!(read, LEN);
+    }
+
+    /// A server that answers the resume with the whole file is an error,
+    /// not bytes spliced in at the wrong offset.
+    #[test]
+    fn resume_rejects_a_server_that_ignores_range() {
+        let mut stream = HttpStream::new(&serve(true)).unwrap();
+        let (read, result) = read_all(&mut stream);
+        assert_eq!(result.unwrap_err().kind(), std::io::ErrorKind::InvalidData);
+        assert_eq!(read, DROP_AT);
+    }
+}
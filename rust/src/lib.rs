@@ -3,15 +3,29 @@
 // ── Core modules ──────────────────────────────────────────────────────────────
 mod error;       // Typed AudioError
 mod events;      // AudioEvent + EventSender/Receiver
+mod event_bus;   // Bounded lock-free event queue with coalescing
 mod source;      // AudioSource enum
 mod enums;       // Shared constants
 
 // ── Engine layer ──────────────────────────────────────────────────────────────
 mod device;      // DeviceManager + hotplug watcher
+mod capture;     // Input capture to WAV + monitor tap
 mod player_state; // SharedPlayback, PlaybackStatus, ResampleState
 mod effects;     // AudioProcessor trait + Effects chain + built-in processors
+mod chain_exchange; // Lock-free effect chain publication to the callback
+mod convolver;   // Partitioned FFT convolution (impulse responses)
+mod mix_matrix;  // Layout-aware channel mixing (ITU downmix)
 mod processor;   // VisualizerProcessor (FFT spectrum)
+mod sample_format; // Block f32 → device format conversion + TPDF dither
 mod http_stream; // HTTP/HTTPS MediaSource adapter
+mod live_stream; // Icecast / HLS live sources behind a jitter buffer
+mod metrics;     // Lock-free runtime telemetry (histograms, trace export)
+mod sample_bank; // Decode-once PCM cache + voices for short sounds
+mod sample_queue; // Decoded queue storage (f32 / i16 / f16)
+mod decode_pool; // Shared decode workers, earliest-underrun first
+mod thread_priority; // Opt-in RT / elevated thread priorities (Linux)
+mod analysis;    // Offline tempo / beat grid / onset analysis
+mod schedule;    // Output frame clock + sample-accurate command schedule
 
 // ── Engine ────────────────────────────────────────────────────────────────────
 mod engine;      // AudioEngine — ties everything together
@@ -0,0 +1,880 @@
+/// Live (unbounded) network sources: Icecast/SHOUTcast and HLS.
+///
+/// [`crate::http_stream::HttpStream`] assumes a static file with a known
+/// length.  A live source never ends, cannot seek, and is expected to drop
+/// now and then, so it is read differently:
+///
+/// * A producer thread owns the network side and writes the audio bytes into
+///   a bounded [`JitterBuffer`].  The decoder reads from the other end
+///   through [`LiveStream`], which Symphonia sees as a plain non-seekable
+///   `MediaSource`.
+/// * Reads block while the buffer is empty.  After an underrun the reader
+///   waits for [`LIVE_PREBUFFER_BYTES`] again before resuming, so a flaky
+///   link stutters once instead of on every packet.
+/// * Disconnects and stalls (no data for [`LIVE_HTTP_TIMEOUT_MS`]) are
+///   retried with exponential backoff, announced as
+///   [`AudioEvent::Reconnecting`].  The decoder only sees an error once
+///   [`LIVE_MAX_RECONNECT_ATTEMPTS`] consecutive attempts have failed.
+///
+/// **ICY** — connections ask for inline metadata (`Icy-MetaData: 1`); the
+/// `StreamTitle='…';` blocks interleaved every `icy-metaint` bytes are
+/// stripped from the audio and sent as [`AudioEvent::StreamMetadata`].
+///
+/// **HLS** — the playlist is polled, and new segments are downloaded
+/// [`LIVE_HLS_PREFETCH_SEGMENTS`] at a time in parallel and appended in
+/// order.  Packed audio (AAC/MP3) and fMP4 segments are supported; MPEG-TS
+/// segments need a demuxer Symphonia does not have and are rejected, as are
+/// encrypted playlists.
+
+use std::collections::{HashMap, VecDeque};
+use std::io::{self, Read, Seek, SeekFrom};
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{Arc, Condvar, Mutex};
+use std::thread;
+use std::time::Duration;
+
+use reqwest::blocking::{Client, Response};
+use reqwest::Url;
+use symphonia::core::io::MediaSource;
+
+use crate::enums::{
+    LIVE_HLS_LIVE_EDGE_SEGMENTS, LIVE_HLS_PREFETCH_SEGMENTS, LIVE_HTTP_TIMEOUT_MS,
+    LIVE_JITTER_BUFFER_BYTES, LIVE_MAX_RECONNECT_ATTEMPTS, LIVE_PREBUFFER_BYTES,
+    LIVE_READ_CHUNK_BYTES, LIVE_RECONNECT_BASE_MS, LIVE_RECONNECT_MAX_MS,
+};
+use crate::events::{AudioEvent, EventSender};
+use crate::{info, warn};
+
+/// How often blocked readers and writers re-check the stop flags.
+const POLL_INTERVAL: Duration = Duration::from_millis(50);
+
+/// What a live source needs from the decode thread that opens it.
+#[derive(Clone)]
+pub struct LiveOptions {
+    pub events: EventSender,
+    /// The decode thread's stop flag.  Unblocks readers and ends the
+    /// producer once set.
+    pub stop:   Arc<AtomicBool>,
+}
+
+// ── Halt ──────────────────────────────────────────────────────────────────────
+
+/// Stop condition shared by the producer thread and the reader: the decode
+/// thread was stopped, or the [`LiveStream`] was dropped.
+#[derive(Clone)]
+struct Halt {
+    stop:   Arc<AtomicBool>,
+    closed: Arc<AtomicBool>,
+}
+
+impl Halt {
+    fn is_set(&self) -> bool {
+        self.stop.load(Ordering::SeqCst) || self.closed.load(Ordering::SeqCst)
+    }
+
+    /// Sleep for `duration`, returning early (`false`) when halted.
+    fn sleep(&self, duration: Duration) -> bool {
+        let mut left = duration;
+        while !left.is_zero() {
+            if self.is_set() { return false; }
+            let step = left.min(POLL_INTERVAL);
+            thread::sleep(step);
+            left -= step;
+        }
+        !self.is_set()
+    }
+}
+
+/// Delay before reconnect attempt `attempt` (1-based).
+fn backoff(attempt: u32) -> Duration {
+    let millis = LIVE_RECONNECT_BASE_MS.saturating_mul(1 << attempt.saturating_sub(1).min(16));
+    Duration::from_millis(millis.min(LIVE_RECONNECT_MAX_MS))
+}
+
+// ── JitterBuffer ──────────────────────────────────────────────────────────────
+
+struct BufferState {
+    bytes:     VecDeque<u8>,
+    /// The reader is waiting for the prebuffer to fill.
+    buffering: bool,
+    /// Set by the producer when it gives up (`Err`) or the stream ended.
+    finished:  Option<Result<(), String>>,
+}
+
+/// Bounded byte FIFO between the network producer and the decoder.
+struct JitterBuffer {
+    state:    Mutex<BufferState>,
+    readable: Condvar,
+    writable: Condvar,
+}
+
+impl JitterBuffer {
+    fn new() -> Self {
+        Self {
+            state: Mutex::new(BufferState {
+                bytes:     VecDeque::with_capacity(LIVE_JITTER_BUFFER_BYTES),
+                buffering: true,
+                finished:  None,
+            }),
+            readable: Condvar::new(),
+            writable: Condvar::new(),
+        }
+    }
+
+    /// Append `data`, blocking while the buffer is full.  Returns `false`
+    /// if halted before everything was written.
+    fn write(&self, mut data: &[u8], halt: &Halt) -> bool {
+        let Ok(mut state) = self.state.lock() else { return false };
+        while !data.is_empty() {
+            if halt.is_set() { return false; }
+            let room = LIVE_JITTER_BUFFER_BYTES.saturating_sub(state.bytes.len());
+            if room == 0 {
+                state = match self.writable.wait_timeout(state, POLL_INTERVAL) {
+                    Ok((s, _)) => s,
+                    Err(_) => return false,
+                };
+                continue;
+            }
+            let count = room.min(data.len());
+            state.bytes.extend(&data[..count]);
+            data = &data[count..];
+            self.readable.notify_all();
+        }
+        true
+    }
+
+    /// Mark the producer as done.  Buffered bytes are still delivered.
+    fn finish(&self, result: Result<(), String>) {
+        if let Ok(mut state) = self.state.lock() {
+            state.finished = Some(result);
+        }
+        self.readable.notify_all();
+    }
+
+    /// Read into `buf`, blocking until data is available, the producer has
+    /// finished, or `halt` is set (which reads as end of stream).
+    fn read(&self, buf: &mut [u8], halt: &Halt, events: &EventSender) -> io::Result<usize> {
+        let mut state = self.state.lock().map_err(|_| io::Error::other("Jitter buffer poisoned"))?;
+        let mut announced = None;
+        loop {
+            if halt.is_set() { return Ok(0); }
+
+            let fill = state.bytes.len();
+            if state.buffering {
+                if fill >= LIVE_PREBUFFER_BYTES || state.finished.is_some() {
+                    state.buffering = false;
+                    if announced.is_some() {
+                        let _ = events.send(AudioEvent::BufferingComplete);
+                    }
+                } else {
+                    // Announce progress in 25 % steps.
+                    let step = fill * 4 / LIVE_PREBUFFER_BYTES;
+                    if announced != Some(step) {
+                        announced = Some(step);
+                        let percent = (fill as f32 / LIVE_PREBUFFER_BYTES as f32 * 100.0).min(100.0);
+                        let _ = events.send(AudioEvent::Buffering { percent });
+                    }
+                }
+            }
+
+            if !state.buffering && fill > 0 {
+                let count = fill.min(buf.len());
+                for (dst, src) in buf.iter_mut().zip(state.bytes.drain(..count)) {
+                    *dst = src;
+                }
+                self.writable.notify_all();
+                return Ok(count);
+            }
+
+            match &state.finished {
+                Some(Ok(())) => return Ok(0),
+                Some(Err(e)) => return Err(io::Error::other(e.clone())),
+                None => {}
+            }
+
+            // Underrun: wait for the prebuffer to refill before resuming.
+            state.buffering = true;
+            state = match self.readable.wait_timeout(state, POLL_INTERVAL) {
+                Ok((s, _)) => s,
+                Err(_) => return Err(io::Error::other("Jitter buffer poisoned")),
+            };
+        }
+    }
+}
+
+// ── LiveStream ────────────────────────────────────────────────────────────────
+
+/// Non-seekable `MediaSource` reading a live stream through a jitter buffer.
+pub struct LiveStream {
+    buffer: Arc<JitterBuffer>,
+    halt:   Halt,
+    events: EventSender,
+}
+
+impl LiveStream {
+    /// Connect to `url` and start the producer thread.
+    ///
+    /// URLs ending in `.m3u8`, or answered with an HLS playlist content
+    /// type, are read as HLS; anything else as an ICY stream.  The first
+    /// connection is made synchronously so that a bad URL fails the load.
+    pub fn open(url_str: &str, options: LiveOptions) -> Result<Self, String> {
+        let url    = Url::parse(url_str).map_err(|e| format!("Invalid URL: {e}"))?;
+        let client = Client::builder()
+            .connect_timeout(Duration::from_millis(LIVE_HTTP_TIMEOUT_MS))
+            .timeout(Duration::from_millis(LIVE_HTTP_TIMEOUT_MS))
+            .build()
+            .map_err(|e| format!("Failed to build HTTP client: {e}"))?;
+
+        let halt = Halt { stop: options.stop, closed: Arc::new(AtomicBool::new(false)) };
+        let buffer = Arc::new(JitterBuffer::new());
+
+        let first = if url.path().ends_with(".m3u8") { None } else { Some(connect_icy(&client, &url)?) };
+        let is_hls = first.as_ref().map_or(true, |res| {
+            res.headers()
+                .get(reqwest::header::CONTENT_TYPE)
+                .and_then(|v| v.to_str().ok())
+                .is_some_and(|ct| ct.to_ascii_lowercase().contains("mpegurl"))
+        });
+
+        let producer_buffer = Arc::clone(&buffer);
+        let producer_halt   = halt.clone();
+        let events          = options.events.clone();
+        thread::Builder::new()
+            .name("audiopc-live".into())
+            .spawn(move || {
+                let result = match first {
+                    Some(response) if !is_hls => {
+                        info!("Live ICY stream: {url}");
+                        run_icy(&client, &url, response, &producer_buffer, &producer_halt, &events)
+                    }
+                    _ => {
+                        info!("Live HLS stream: {url}");
+                        run_hls(&client, &url, &producer_buffer, &producer_halt, &events)
+                    }
+                };
+                if let Err(e) = &result {
+                    warn!("Live stream ended: {e}");
+                }
+                producer_buffer.finish(result);
+            })
+            .map_err(|e| format!("Failed to start live stream thread: {e}"))?;
+
+        Ok(Self { buffer, halt, events: options.events })
+    }
+}
+
+impl Drop for LiveStream {
+    fn drop(&mut self) {
+        self.halt.closed.store(true, Ordering::SeqCst);
+    }
+}
+
+impl Read for LiveStream {
+    fn read(&mut self, buf: &mut [u8]) -> io::Result<usize> {
+        if buf.is_empty() { return Ok(0); }
+        self.buffer.read(buf, &self.halt, &self.events)
+    }
+}
+
+impl Seek for LiveStream {
+    fn seek(&mut self, _pos: SeekFrom) -> io::Result<u64> {
+        Err(io::Error::new(io::ErrorKind::Unsupported, "Live streams cannot seek"))
+    }
+}
+
+impl MediaSource for LiveStream {
+    fn is_seekable(&self) -> bool { false }
+
+    fn byte_len(&self) -> Option<u64> { None }
+}
+
+// ── Reconnect ─────────────────────────────────────────────────────────────────
+
+/// Retry `connect` with backoff until it succeeds, giving up after
+/// [`LIVE_MAX_RECONNECT_ATTEMPTS`].  `Ok(None)` means halted.
+fn reconnect<T>(
+    halt:    &Halt,
+    events:  &EventSender,
+    mut connect: impl FnMut() -> Result<T, String>,
+) -> Result<Option<T>, String> {
+    let mut last_error = String::new();
+    for attempt in 1..=LIVE_MAX_RECONNECT_ATTEMPTS {
+        let _ = events.send(AudioEvent::Reconnecting { attempt });
+        if !halt.sleep(backoff(attempt)) { return Ok(None); }
+        match connect() {
+            Ok(value) => return Ok(Some(value)),
+            Err(e) => {
+                warn!("Reconnect attempt {attempt} failed: {e}");
+                last_error = e;
+            }
+        }
+    }
+    Err(format!("Gave up after {LIVE_MAX_RECONNECT_ATTEMPTS} reconnect attempts: {last_error}"))
+}
+
+// ── ICY ───────────────────────────────────────────────────────────────────────
+
+fn connect_icy(client: &Client, url: &Url) -> Result<Response, String> {
+    client
+        .get(url.clone())
+        .header("Icy-MetaData", "1")
+        .send()
+        .and_then(|res| res.error_for_status())
+        .map_err(|e| format!("Failed to connect to {url}: {e}"))
+}
+
+/// Pump an ICY stream into `buffer`, reconnecting whenever it drops.
+fn run_icy(
+    client:       &Client,
+    url:          &Url,
+    mut response: Response,
+    buffer:       &JitterBuffer,
+    halt:         &Halt,
+    events:       &EventSender,
+) -> Result<(), String> {
+    loop {
+        match pump_icy(&mut response, buffer, halt, events) {
+            Ok(()) if halt.is_set() => return Ok(()),
+            Ok(()) => { warn!("ICY stream closed by server; reconnecting"); }
+            Err(e) => { warn!("ICY stream read failed: {e}; reconnecting"); }
+        }
+        response = match reconnect(halt, events, || connect_icy(client, url))? {
+            Some(res) => res,
+            None => return Ok(()),
+        };
+    }
+}
+
+/// Copy audio from one ICY connection until it ends, stripping and
+/// publishing the inline metadata blocks.
+fn pump_icy(
+    response: &mut Response,
+    buffer:   &JitterBuffer,
+    halt:     &Halt,
+    events:   &EventSender,
+) -> io::Result<()> {
+    let metaint = response
+        .headers()
+        .get("icy-metaint")
+        .and_then(|v| v.to_str().ok())
+        .and_then(|s| s.trim().parse::<usize>().ok())
+        .filter(|&n| n > 0);
+
+    let mut chunk      = vec![0u8; LIVE_READ_CHUNK_BYTES];
+    let mut until_meta = metaint.unwrap_or(usize::MAX);
+    loop {
+        if halt.is_set() { return Ok(()); }
+        let want  = chunk.len().min(until_meta);
+        let count = response.read(&mut chunk[..want])?;
+        if count == 0 { return Ok(()); }
+        if !buffer.write(&chunk[..count], halt) { return Ok(()); }
+
+        if let Some(interval) = metaint {
+            until_meta -= count;
+            if until_meta == 0 {
+                read_icy_metadata(response, events)?;
+                until_meta = interval;
+            }
+        }
+    }
+}
+
+/// Read one metadata block (a length byte × 16, then the text).
+fn read_icy_metadata(response: &mut Response, events: &EventSender) -> io::Result<()> {
+    let mut len = [0u8; 1];
+    response.read_exact(&mut len)?;
+    if len[0] == 0 { return Ok(()); }
+
+    let mut raw = vec![0u8; len[0] as usize * 16];
+    response.read_exact(&mut raw)?;
+    let tags = parse_icy_metadata(&raw);
+    if !tags.is_empty() {
+        let _ = events.send(AudioEvent::StreamMetadata(tags));
+    }
+    Ok(())
+}
+
+/// Parse `Key='value';Key2='value2';` (values may contain quotes).
+fn parse_icy_metadata(raw: &[u8]) -> HashMap<String, String> {
+    let text = String::from_utf8_lossy(raw);
+    let mut rest = text.trim_end_matches('\0');
+    let mut tags = HashMap::new();
+
+    while let Some(eq) = rest.find('=') {
+        let key = rest[..eq].trim().to_string();
+        rest = &rest[eq + 1..];
+        let value = if let Some(quoted) = rest.strip_prefix('\'') {
+            let end = quoted.find("';").or_else(|| quoted.rfind('\'')).unwrap_or(quoted.len());
+            rest = quoted.get(end + 2..).unwrap_or("");
+            &quoted[..end]
+        } else {
+            let end = rest.find(';').unwrap_or(rest.len());
+            let value = &rest[..end];
+            rest = rest.get(end + 1..).unwrap_or("");
+            value
+        };
+        if !key.is_empty() {
+            tags.insert(key, value.to_string());
+        }
+    }
+    tags
+}
+
+// ── HLS ───────────────────────────────────────────────────────────────────────
+
+struct MediaPlaylist {
+    target_duration: Duration,
+    /// Sequence number of `segments[0]`.
+    media_sequence:  u64,
+    segments:        Vec<Url>,
+    /// `#EXT-X-MAP` initialisation segment (fMP4).
+    init:            Option<Url>,
+    /// `#EXT-X-ENDLIST`: no more segments will be added.
+    ended:           bool,
+}
+
+fn fetch_bytes(client: &Client, url: &Url) -> Result<Vec<u8>, String> {
+    client
+        .get(url.clone())
+        .send()
+        .and_then(|res| res.error_for_status())
+        .and_then(|res| res.bytes())
+        .map(|b| b.to_vec())
+        .map_err(|e| format!("Failed to fetch {url}: {e}"))
+}
+
+fn fetch_text(client: &Client, url: &Url) -> Result<String, String> {
+    fetch_bytes(client, url).map(|b| String::from_utf8_lossy(&b).into_owned())
+}
+
+/// Value of `name=` in an attribute list such as `BANDWIDTH=1280000,URI="a"`.
+fn attribute<'a>(list: &'a str, name: &str) -> Option<&'a str> {
+    list.split(',').find_map(|pair| {
+        let (k, v) = pair.split_once('=')?;
+        (k.trim() == name).then(|| v.trim().trim_matches('"'))
+    })
+}
+
+/// The highest-bandwidth variant of a master playlist, if `text` is one.
+fn best_variant(base: &Url, text: &str) -> Option<Url> {
+    let mut best: Option<(u64, Url)> = None;
+    let mut lines = text.lines().map(str::trim);
+    while let Some(line) = lines.next() {
+        let Some(attrs) = line.strip_prefix("#EXT-X-STREAM-INF:") else { continue };
+        let bandwidth = attribute(attrs, "BANDWIDTH").and_then(|b| b.parse().ok()).unwrap_or(0);
+        let Some(uri) = lines.find(|l| !l.is_empty() && !l.starts_with('#')) else { break };
+        let Ok(url) = base.join(uri) else { continue };
+        if best.as_ref().is_none_or(|(b, _)| bandwidth > *b) {
+            best = Some((bandwidth, url));
+        }
+    }
+    best.map(|(_, url)| url)
+}
+
+fn parse_media_playlist(base: &Url, text: &str) -> Result<MediaPlaylist, String> {
+    if !text.trim_start().starts_with("#EXTM3U") {
+        return Err("Not an HLS playlist".to_string());
+    }
+    let mut playlist = MediaPlaylist {
+        target_duration: Duration::from_secs(6),
+        media_sequence:  0,
+        segments:        Vec::new(),
+        init:            None,
+        ended:           false,
+    };
+
+    for line in text.lines().map(str::trim).filter(|l| !l.is_empty()) {
+        if let Some(v) = line.strip_prefix("#EXT-X-TARGETDURATION:") {
+            if let Ok(secs) = v.parse::<f64>() {
+                playlist.target_duration = Duration::from_secs_f64(secs.max(1.0));
+            }
+        } else if let Some(v) = line.strip_prefix("#EXT-X-MEDIA-SEQUENCE:") {
+            playlist.media_sequence = v.parse().unwrap_or(0);
+        } else if let Some(attrs) = line.strip_prefix("#EXT-X-MAP:") {
+            playlist.init = attribute(attrs, "URI").and_then(|u| base.join(u).ok());
+        } else if let Some(attrs) = line.strip_prefix("#EXT-X-KEY:") {
+            if attribute(attrs, "METHOD").is_some_and(|m| m != "NONE") {
+                return Err("Encrypted HLS streams are not supported".to_string());
+            }
+        } else if line == "#EXT-X-ENDLIST" {
+            playlist.ended = true;
+        } else if !line.starts_with('#') {
+            let url = base.join(line).map_err(|e| format!("Bad segment URI '{line}': {e}"))?;
+            playlist.segments.push(url);
+        }
+    }
+    Ok(playlist)
+}
+
+/// Fetch a segment, retrying with backoff.  `Ok(None)` means halted.
+fn fetch_segment(
+    client: &Client,
+    url:    &Url,
+    halt:   &Halt,
+    events: &EventSender,
+) -> Result<Option<Vec<u8>>, String> {
+    match fetch_bytes(client, url) {
+        Ok(bytes) => Ok(Some(bytes)),
+        Err(e) => {
+            warn!("{e}; retrying");
+            reconnect(halt, events, || fetch_bytes(client, url))
+        }
+    }
+}
+
+/// MPEG-TS packets start with a 0x47 sync byte every 188 bytes.
+fn is_mpeg_ts(bytes: &[u8]) -> bool {
+    bytes.len() >= 376 && bytes[0] == 0x47 && bytes[188] == 0x47
+}
+
+/// Poll an HLS playlist and append its segments to `buffer` in order.
+fn run_hls(
+    client: &Client,
+    url:    &Url,
+    buffer: &JitterBuffer,
+    halt:   &Halt,
+    events: &EventSender,
+) -> Result<(), String> {
+    let load = |url: &Url| fetch_text(client, url);
+    let mut text = match load(url) {
+        Ok(text) => text,
+        Err(e) => {
+            warn!("{e}; retrying");
+            match reconnect(halt, events, || load(url))? {
+                Some(text) => text,
+                None => return Ok(()),
+            }
+        }
+    };
+    let media_url = match best_variant(url, &text) {
+        Some(variant) => {
+            text = fetch_text(client, &variant)?;
+            variant
+        }
+        None => url.clone(),
+    };
+
+    let mut next_sequence: Option<u64> = None;
+    let mut written_init: Option<Url>  = None;
+
+    loop {
+        let playlist = parse_media_playlist(&media_url, &text)?;
+        let last     = playlist.media_sequence + playlist.segments.len() as u64;
+        // Start a live playlist near its live edge, a finished one at the top.
+        let first = next_sequence.unwrap_or(if playlist.ended {
+            playlist.media_sequence
+        } else {
+            last.saturating_sub(LIVE_HLS_LIVE_EDGE_SEGMENTS as u64).max(playlist.media_sequence)
+        });
+        // Fell behind the sliding window: skip to what is still listed.
+        let first = first.max(playlist.media_sequence);
+        let pending = &playlist.segments[(first - playlist.media_sequence) as usize..];
+
+        if let Some(init) = &playlist.init {
+            if written_init.as_ref() != Some(init) {
+                let Some(bytes) = fetch_segment(client, init, halt, events)? else { return Ok(()) };
+                if !buffer.write(&bytes, halt) { return Ok(()); }
+                written_init = Some(init.clone());
+            }
+        }
+
+        for window in pending.chunks(LIVE_HLS_PREFETCH_SEGMENTS.max(1)) {
+            // Download the window in parallel, append in playlist order.
+            let written = thread::scope(|scope| -> Result<bool, String> {
+                let fetches: Vec<_> = window
+                    .iter()
+                    .map(|segment| scope.spawn(move || fetch_segment(client, segment, halt, events)))
+                    .collect();
+                for fetch in fetches {
+                    let bytes = fetch.join().map_err(|_| "Segment fetch panicked".to_string())??;
+                    let Some(bytes) = bytes else { return Ok(false) };
+                    if is_mpeg_ts(&bytes) {
+                        return Err("MPEG-TS HLS segments are not supported".to_string());
+                    }
+                    if !buffer.write(&bytes, halt) { return Ok(false); }
+                }
+                Ok(true)
+            })?;
+            if !written { return Ok(()); }
+        }
+        next_sequence = Some(last);
+
+        if playlist.ended { return Ok(()); }
+
+        // Poll again after half a target duration when nothing was new.
+        if pending.is_empty() && !halt.sleep(playlist.target_duration / 2) {
+            return Ok(());
+        }
+        text = match load(&media_url) {
+            Ok(text) => text,
+            Err(e) => {
+                warn!("{e}; retrying");
+                match reconnect(halt, events, || load(&media_url))? {
+                    Some(text) => text,
+                    None => return Ok(()),
+                }
+            }
+        };
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::io::Write;
+    use std::net::{Shutdown, TcpListener, TcpStream};
+    use std::sync::atomic::AtomicUsize;
+    use std::time::Instant;
+
+    use crate::events::{event_channel, EventReceiver};
+
+    const METAINT: usize = 8_192;
+
+    /// Byte `offset` of the simulated audio stream.
+    fn pattern(offset: usize) -> u8 {
+        ((offset as u32).wrapping_mul(2_654_435_761) >> 24) as u8
+    }
+
+    /// Loopback stand-in server: every connection is handed to `handler`
+    /// on its own thread with its index and request path.
+    fn serve<H>(handler: H) -> (String, Arc<AtomicBool>)
+    where
+        H: Fn(usize, &str, &mut TcpStream, &AtomicBool) + Send + Sync + 'static,
+    {
+        let listener = TcpListener::bind("127.0.0.1:0").unwrap();
+        let base     = format!("http://{}", listener.local_addr().unwrap());
+        let done     = Arc::new(AtomicBool::new(false));
+        let handler  = Arc::new(handler);
+        let server_done = Arc::clone(&done);
+        thread::spawn(move || {
+            for (index, socket) in listener.incoming().enumerate() {
+                let Ok(mut socket) = socket else { continue };
+                let handler = Arc::clone(&handler);
+                let done    = Arc::clone(&server_done);
+                thread::spawn(move || {
+                    let path = read_request(&mut socket);
+                    handler(index, &path, &mut socket, &done);
+                });
+            }
+        });
+        (base, done)
+    }
+
+    /// Read the request head and return its path.
+    fn read_request(socket: &mut TcpStream) -> String {
+        let mut head = Vec::new();
+        let mut byte = [0u8; 1];
+        while !head.ends_with(b"\r\n\r\n") && socket.read(&mut byte).unwrap_or(0) == 1 {
+            head.push(byte[0]);
+        }
+        let head = String::from_utf8_lossy(&head);
+        head.split_whitespace().nth(1).unwrap_or("/").to_string()
+    }
+
+    /// Hold a connection open without sending until the test is over.
+    fn hold(done: &AtomicBool) {
+        while !done.load(Ordering::SeqCst) {
+            thread::sleep(Duration::from_millis(20));
+        }
+    }
+
+    /// Writes the ICY body of one connection, continuing the shared audio
+    /// stream at `offset` and inserting a metadata block every `METAINT`.
+    struct IcyWriter<'a> {
+        socket: &'a mut TcpStream,
+        title:  String,
+        since_meta: usize,
+    }
+
+    impl<'a> IcyWriter<'a> {
+        fn start(socket: &'a mut TcpStream, title: String) -> Self {
+            let head = format!("HTTP/1.0 200 OK\r\nContent-Type: audio/mpeg\r\nicy-metaint: {METAINT}\r\n\r\n");
+            let _ = socket.write_all(head.as_bytes());
+            Self { socket, title, since_meta: 0 }
+        }
+
+        /// Send `len` audio bytes from `offset` in pieces of `piece`,
+        /// sleeping `delay` between pieces.  Stops quietly once the client
+        /// hangs up.
+        fn audio(&mut self, offset: &AtomicUsize, len: usize, piece: usize, delay: Duration) {
+            let mut sent = 0;
+            while sent < len {
+                let count = piece.min(len - sent).min(METAINT - self.since_meta);
+                let from  = offset.fetch_add(count, Ordering::SeqCst);
+                let bytes: Vec<u8> = (from..from + count).map(pattern).collect();
+                if self.socket.write_all(&bytes).is_err() {
+                    return;
+                }
+                sent += count;
+                self.since_meta += count;
+                if self.since_meta == METAINT {
+                    let text = format!("StreamTitle='{}';", self.title);
+                    let blocks = text.len().div_ceil(16);
+                    let mut meta = vec![blocks as u8];
+                    meta.extend(text.as_bytes());
+                    meta.resize(1 + blocks * 16, 0);
+                    if self.socket.write_all(&meta).is_err() {
+                        return;
+                    }
+                    self.since_meta = 0;
+                }
+                if !delay.is_zero() {
+                    thread::sleep(delay);
+                }
+            }
+        }
+    }
+
+    fn open(url: &str) -> (LiveStream, EventReceiver) {
+        let (events, inbox) = event_channel();
+        let stop = Arc::new(AtomicBool::new(false));
+        (LiveStream::open(url, LiveOptions { events, stop }).unwrap(), inbox)
+    }
+
+    /// Read exactly `len` bytes, returning them and the longest wait for a
+    /// single read.
+    fn read_len(stream: &mut LiveStream, len: usize) -> (Vec<u8>, Duration) {
+        let mut out = Vec::with_capacity(len);
+        let mut buf = [0u8; 4_096];
+        let mut longest = Duration::ZERO;
+        while out.len() < len {
+            let started = Instant::now();
+            let count = stream.read(&mut buf[..(len - out.len()).min(4_096)]).unwrap();
+            longest = longest.max(started.elapsed());
+            assert!(count > 0, "stream ended after {} bytes", out.len());
+            out.extend_from_slice(&buf[..count]);
+        }
+        (out, longest)
+    }
+
+    fn drain(inbox: &EventReceiver) -> Vec<AudioEvent> {
+        std::iter::from_fn(|| inbox.try_recv()).collect()
+    }
+
+    #[test]
+    fn icy_survives_latency_pauses_and_disconnects() {
+        let offset = Arc::new(AtomicUsize::new(0));
+        let served = Arc::clone(&offset);
+        let (base, done) = serve(move |index, _, socket, done| {
+            let mut icy = IcyWriter::start(socket, format!("conn {index}"));
+            match index {
+                // Slow link, then the server drops the connection.
+                0 => icy.audio(&served, 96 * 1024, 4_096, Duration::from_millis(2)),
+                // A pause shorter than the timeout, then a clean close.
+                1 => {
+                    icy.audio(&served, 32 * 1024, 8_192, Duration::ZERO);
+                    thread::sleep(Duration::from_millis(300));
+                    icy.audio(&served, 32 * 1024, 8_192, Duration::ZERO);
+                }
+                // Enough that a late underrun can always prebuffer again.
+                _ => {
+                    icy.audio(&served, 256 * 1024, 8_192, Duration::ZERO);
+                    hold(done);
+                }
+            }
+            let _ = socket.shutdown(Shutdown::Both);
+        });
+
+        let started = Instant::now();
+        let (mut stream, inbox) = open(&format!("{base}/stream"));
+        let opened = started.elapsed();
+        let (audio, longest) = read_len(&mut stream, 192 * 1024);
+        let total = started.elapsed();
+        drop(stream);
+        done.store(true, Ordering::SeqCst);
+
+        // Metadata stripped, nothing lost or repeated across reconnects.
+        let expected: Vec<u8> = (0..audio.len()).map(pattern).collect();
+        assert!(audio == expected, "audio bytes differ from the served stream");
+
+        let events = drain(&inbox);
+        let reconnects = events.iter().filter(|e| matches!(e, AudioEvent::Reconnecting { attempt: 1 })).count();
+        assert_eq!(reconnects, 2);
+        let titles: Vec<_> = events
+            .iter()
+            .filter_map(|e| match e {
+                AudioEvent::StreamMetadata(tags) => tags.get("StreamTitle").cloned(),
+                _ => None,
+            })
+            .collect();
+        for index in 0..3 {
+            assert!(titles.contains(&format!("conn {index}")), "{titles:?}");
+        }
+        assert!(events.iter().any(|e| matches!(e, AudioEvent::BufferingComplete)));
+        println!("open {opened:?}, longest read {longest:?}, 192 KiB in {total:?}");
+    }
+
+    #[test]
+    fn icy_reconnects_after_a_stall() {
+        let offset  = Arc::new(AtomicUsize::new(0));
+        let served  = Arc::clone(&offset);
+        let moments = Arc::new(Mutex::new(Vec::new()));
+        let log     = Arc::clone(&moments);
+        let (base, done) = serve(move |index, _, socket, done| {
+            log.lock().unwrap().push((index, "connected", Instant::now()));
+            let mut icy = IcyWriter::start(socket, format!("conn {index}"));
+            // Connection 0 goes silent after 80 KiB but stays open.
+            let len = if index == 0 { 80 * 1024 } else { 512 * 1024 };
+            icy.audio(&served, len, 8_192, Duration::ZERO);
+            log.lock().unwrap().push((index, "stalled", Instant::now()));
+            hold(done);
+        });
+
+        let (mut stream, inbox) = open(&format!("{base}/stream"));
+        let (audio, longest) = read_len(&mut stream, 208 * 1024);
+        drop(stream);
+        done.store(true, Ordering::SeqCst);
+
+        let expected: Vec<u8> = (0..audio.len()).map(pattern).collect();
+        assert!(audio == expected, "audio bytes differ from the served stream");
+        assert!(drain(&inbox).iter().any(|e| matches!(e, AudioEvent::Reconnecting { attempt: 1 })));
+
+        let moments = moments.lock().unwrap();
+        let at = |index, what| moments.iter().find(|m| m.0 == index && m.1 == what).map(|m| m.2).unwrap();
+        let recovery = at(1, "connected") - at(0, "stalled");
+        let timeout  = Duration::from_millis(LIVE_HTTP_TIMEOUT_MS);
+        assert!(recovery >= timeout, "reconnected after {recovery:?}");
+        assert!(recovery < timeout + backoff(1) + Duration::from_secs(2), "reconnected after {recovery:?}");
+        println!("stall to reconnect {recovery:?}, longest read {longest:?}");
+    }
+
+    #[test]
+    fn hls_appends_segments_in_order_despite_latency_and_errors() {
+        const SEGMENT: usize = 20 * 1024;
+        let failures = Arc::new(AtomicUsize::new(0));
+        let failed   = Arc::clone(&failures);
+        let (base, _done) = serve(move |_, path, socket, _| {
+            let body: Vec<u8> = match path {
+                "/live.m3u8" => b"#EXTM3U\n#EXT-X-TARGETDURATION:1\n#EXT-X-MEDIA-SEQUENCE:0\n\
+                                  seg0.aac\nseg1.aac\nseg2.aac\nseg3.aac\n#EXT-X-ENDLIST\n"
+                    .to_vec(),
+                _ => {
+                    let n: usize = path.trim_start_matches("/seg").trim_end_matches(".aac").parse().unwrap();
+                    match n {
+                        // The first segment of the window arrives last.
+                        0 => thread::sleep(Duration::from_millis(300)),
+                        // The second fails once and is retried.
+                        1 if failed.fetch_add(1, Ordering::SeqCst) == 0 => {
+                            let _ = socket.write_all(b"HTTP/1.0 503 Service Unavailable\r\n\r\n");
+                            return;
+                        }
+                        _ => {}
+                    }
+                    (n * SEGMENT..(n + 1) * SEGMENT).map(pattern).collect()
+                }
+            };
+            let head = format!("HTTP/1.0 200 OK\r\nContent-Length: {}\r\n\r\n", body.len());
+            let _ = socket.write_all(head.as_bytes());
+            let _ = socket.write_all(&body);
+        });
+
+        let (mut stream, inbox) = open(&format!("{base}/live.m3u8"));
+        let mut audio = Vec::new();
+        stream.read_to_end(&mut audio).unwrap();
+
+        let expected: Vec<u8> = (0..4 * SEGMENT).map(pattern).collect();
+        assert!(audio == expected, "got {} bytes, not the segments in order", audio.len());
+        assert_eq!(failures.load(Ordering::SeqCst), 2);
+        assert!(drain(&inbox).iter().any(|e| matches!(e, AudioEvent::Reconnecting { attempt: 1 })));
+    }
+}
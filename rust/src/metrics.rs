@@ -0,0 +1,584 @@
+/// Lock-free runtime telemetry for the audio callback and decode thread.
+///
+/// Every recorder in this module is a plain atomic, so recording never
+/// blocks, allocates or takes a lock — it is safe to call from the cpal
+/// callback.  Each metric has exactly one writer thread (the callback *or*
+/// the decode thread), which keeps the atomics uncontended and makes them
+/// effectively per-thread counters; readers (FFI, trace export) only load.
+///
+/// # What is recorded
+///
+/// * Callback duration and load (duration / buffer deadline), plus the
+///   number of callbacks that overran their deadline.
+/// * Time the callback and decode thread wait on the `SharedPlayback` lock.
+/// * Decode + resample time per packet.
+/// * Queue fill level, both as a histogram and as a short time series.
+/// * Startup (`play` → first audible sample) and seek latencies.
+///
+/// A snapshot is rendered to JSON by [`EngineMetrics::snapshot_json`] and a
+/// Chrome/Perfetto trace of the recent callback history by
+/// [`EngineMetrics::write_trace`].
+
+use std::fs::File;
+use std::io::{BufWriter, Write};
+use std::sync::atomic::{AtomicU32, AtomicU64, AtomicUsize, Ordering};
+use std::time::{Duration, Instant};
+
+use serde_json::{json, Value};
+
+use crate::enums::{METRICS_HISTOGRAM_BUCKETS, METRICS_TRACE_CAPACITY};
+
+// ── Histogram ─────────────────────────────────────────────────────────────────
+
+/// Number of linear sub-buckets per power of two (as a bit count).
+const SUB_BUCKET_BITS: u32 = 3;
+const SUB_BUCKETS: u64 = 1 << SUB_BUCKET_BITS;
+
+/// A fixed-size, log-linear (HDR-style) histogram of `u64` values.
+///
+/// Values below `SUB_BUCKETS` get their own bucket; above that each power of
+/// two is split into `SUB_BUCKETS` linear buckets, giving ~12 % relative
+/// precision over the whole range without any allocation.
+pub struct Histogram {
+    buckets: [AtomicU64; METRICS_HISTOGRAM_BUCKETS],
+    count:   AtomicU64,
+    sum:     AtomicU64,
+    max:     AtomicU64,
+}
+
+impl Histogram {
+    pub fn new() -> Self {
+        Self {
+            buckets: std::array::from_fn(|_| AtomicU64::new(0)),
+            count:   AtomicU64::new(0),
+            sum:     AtomicU64::new(0),
+            max:     AtomicU64::new(0),
+        }
+    }
+
+    #[inline]
+    fn bucket_index(value: u64) -> usize {
+        if value < SUB_BUCKETS {
+            return value as usize;
+        }
+        let exp = 63 - value.leading_zeros();
+        let sub = (value >> (exp - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+        let index = ((exp - SUB_BUCKET_BITS + 1) as u64) * SUB_BUCKETS + sub;
+        (index as usize).min(METRICS_HISTOGRAM_BUCKETS - 1)
+    }
+
+    /// Smallest value that falls into bucket `index`.
+    fn bucket_floor(index: usize) -> u64 {
+        let index = index as u64;
+        if index < SUB_BUCKETS {
+            return index;
+        }
+        let exp = index / SUB_BUCKETS + SUB_BUCKET_BITS as u64 - 1;
+        let sub = index % SUB_BUCKETS;
+        (SUB_BUCKETS + sub) << (exp - SUB_BUCKET_BITS as u64)
+    }
+
+    /// Record one value from any thread.  Real-time safe.
+    #[inline]
+    pub fn record(&self, value: u64) {
+        self.buckets[Self::bucket_index(value)].fetch_add(1, Ordering::Relaxed);
+        self.count.fetch_add(1, Ordering::Relaxed);
+        self.sum.fetch_add(value, Ordering::Relaxed);
+        self.max.fetch_max(value, Ordering::Relaxed);
+    }
+
+    /// Record one value from the histogram's only writer (the audio
+    /// callback).  Plain loads and stores instead of locked read-modify-
+    /// writes; a `reset` racing with it may keep one stale sample.
+    #[inline]
+    pub fn record_owned(&self, value: u64) {
+        bump(&self.buckets[Self::bucket_index(value)], 1);
+        bump(&self.count, 1);
+        bump(&self.sum, value);
+        if value > self.max.load(Ordering::Relaxed) {
+            self.max.store(value, Ordering::Relaxed);
+        }
+    }
+
+    /// Record a duration in whole microseconds.
+    #[inline]
+    pub fn record_micros(&self, elapsed: Duration) {
+        self.record(elapsed.as_micros().min(u64::MAX as u128) as u64);
+    }
+
+    pub fn reset(&self) {
+        for b in &self.buckets {
+            b.store(0, Ordering::Relaxed);
+        }
+        self.count.store(0, Ordering::Relaxed);
+        self.sum.store(0, Ordering::Relaxed);
+        self.max.store(0, Ordering::Relaxed);
+    }
+
+    /// Approximate value at quantile `q` (0.0–1.0).
+    fn quantile(&self, counts: &[u64; METRICS_HISTOGRAM_BUCKETS], total: u64, q: f64) -> u64 {
+        if total == 0 {
+            return 0;
+        }
+        let rank = ((total as f64) * q).ceil().max(1.0) as u64;
+        let mut seen = 0u64;
+        for (index, count) in counts.iter().enumerate() {
+            seen += count;
+            if seen >= rank {
+                return Self::bucket_floor(index);
+            }
+        }
+        self.max.load(Ordering::Relaxed)
+    }
+
+    /// Summarise the histogram as `{count, mean, p50, p90, p99, p999, max}`.
+    pub fn summary(&self) -> Value {
+        let counts: [u64; METRICS_HISTOGRAM_BUCKETS] =
+            std::array::from_fn(|i| self.buckets[i].load(Ordering::Relaxed));
+        let total: u64 = counts.iter().sum();
+        let sum = self.sum.load(Ordering::Relaxed);
+        let mean = if total > 0 { sum as f64 / total as f64 } else { 0.0 };
+        json!({
+            "count": total,
+            "mean":  mean,
+            "p50":   self.quantile(&counts, total, 0.50),
+            "p90":   self.quantile(&counts, total, 0.90),
+            "p99":   self.quantile(&counts, total, 0.99),
+            "p999":  self.quantile(&counts, total, 0.999),
+            "max":   self.max.load(Ordering::Relaxed),
+        })
+    }
+}
+
+impl Default for Histogram {
+    fn default() -> Self { Self::new() }
+}
+
+// ── Callback trace ring ───────────────────────────────────────────────────────
+
+/// One entry of the callback time series.  Entries may be torn while the
+/// callback overwrites them; that is acceptable for telemetry.
+struct TraceEntry {
+    start_us:     AtomicU64,
+    duration_us:  AtomicU32,
+    deadline_us:  AtomicU32,
+    fill_permille: AtomicU32,
+}
+
+// ── EngineMetrics ─────────────────────────────────────────────────────────────
+
+/// Kind of latency measurement currently pending (see
+/// [`EngineMetrics::mark_startup`] / [`EngineMetrics::mark_seek`]).
+const PENDING_NONE:    u32 = 0;
+const PENDING_STARTUP: u32 = 1;
+const PENDING_SEEK:    u32 = 2;
+
+/// All runtime telemetry for one [`crate::engine::AudioEngine`].
+///
+/// Shared as `Arc<EngineMetrics>` between the engine, the cpal callback and
+/// the decode thread.
+pub struct EngineMetrics {
+    epoch: Instant,
+
+    // ── Callback ──────────────────────────────────────────────────────────
+    pub callbacks:          AtomicU64,
+    pub callback_overruns:  AtomicU64,
+    /// Wall-clock time spent inside the callback (µs).
+    pub callback_us:        Histogram,
+    /// Callback duration as a fraction of the buffer deadline (‰).
+    pub callback_load:      Histogram,
+    /// Time the callback waited for the `SharedPlayback` lock (µs).
+    pub callback_lock_wait_us: Histogram,
+    /// Queue fill level at the start of each callback (‰ of `max_samples`).
+    pub queue_fill:         Histogram,
+
+    // ── Decode thread ─────────────────────────────────────────────────────
+    /// Decode + resample time per packet (µs).
+    pub decode_packet_us:   Histogram,
+    /// Time the decode thread waited for the `SharedPlayback` lock (µs).
+    pub decode_lock_wait_us: Histogram,
+    /// Time a runnable decode job waited for a pool worker (µs).
+    pub decode_wait_us:     Histogram,
+
+    // ── Control latencies ─────────────────────────────────────────────────
+    /// `play()` → first audible sample (µs).
+    pub startup_us:         Histogram,
+    /// `seek()` → first audible sample at the new position (µs).
+    pub seek_us:            Histogram,
+    /// Time the caller spends inside `set_source` (µs).
+    pub set_source_us:      Histogram,
+    /// `set_source` return → source opened and probed (µs).
+    pub source_load_us:     Histogram,
+    /// Cached-sound trigger → first callback mixing it (µs).
+    pub sample_trigger_us:  Histogram,
+
+    pending_kind:  AtomicU32,
+    pending_since: AtomicU64,
+
+    trace:       Box<[TraceEntry]>,
+    trace_head:  AtomicUsize,
+}
+
+impl EngineMetrics {
+    pub fn new() -> Self {
+        Self {
+            epoch:                 Instant::now(),
+            callbacks:             AtomicU64::new(0),
+            callback_overruns:     AtomicU64::new(0),
+            callback_us:           Histogram::new(),
+            callback_load:         Histogram::new(),
+            callback_lock_wait_us: Histogram::new(),
+            queue_fill:            Histogram::new(),
+            decode_packet_us:      Histogram::new(),
+            decode_lock_wait_us:   Histogram::new(),
+            decode_wait_us:        Histogram::new(),
+            startup_us:            Histogram::new(),
+            seek_us:               Histogram::new(),
+            set_source_us:         Histogram::new(),
+            source_load_us:        Histogram::new(),
+            sample_trigger_us:     Histogram::new(),
+            pending_kind:          AtomicU32::new(PENDING_NONE),
+            pending_since:         AtomicU64::new(0),
+            trace: (0..METRICS_TRACE_CAPACITY)
+                .map(|_| TraceEntry {
+                    start_us:      AtomicU64::new(0),
+                    duration_us:   AtomicU32::new(0),
+                    deadline_us:   AtomicU32::new(0),
+                    fill_permille: AtomicU32::new(0),
+                })
+                .collect(),
+            trace_head: AtomicUsize::new(0),
+        }
+    }
+
+    /// Microseconds elapsed since this metrics instance was created.
+    #[inline]
+    fn now_us(&self) -> u64 {
+        self.epoch.elapsed().as_micros() as u64
+    }
+
+    // ── Control-thread markers ────────────────────────────────────────────
+
+    /// Start measuring time until the next audible sample (after `play`).
+    pub fn mark_startup(&self) {
+        self.pending_since.store(self.now_us(), Ordering::Relaxed);
+        self.pending_kind.store(PENDING_STARTUP, Ordering::Release);
+    }
+
+    /// Start measuring time until the first audible sample after a seek.
+    pub fn mark_seek(&self) {
+        self.pending_since.store(self.now_us(), Ordering::Relaxed);
+        self.pending_kind.store(PENDING_SEEK, Ordering::Release);
+    }
+
+    // ── Callback-side recording ───────────────────────────────────────────
+
+    /// Begin timing one cpal callback.  Call [`CallbackProbe::lock_acquired`]
+    /// once the shared lock is held and [`CallbackProbe::finish`] at the end.
+    #[inline]
+    pub fn begin_callback(&self) -> CallbackProbe<'_> {
+        CallbackProbe { metrics: self, started: Instant::now() }
+    }
+
+    /// Resolve a pending startup/seek measurement; called by the callback
+    /// when it has emitted real (non-silent) samples.
+    #[inline]
+    fn audio_emitted(&self) {
+        let kind = self.pending_kind.load(Ordering::Acquire);
+        if kind == PENDING_NONE {
+            return;
+        }
+        if self
+            .pending_kind
+            .compare_exchange(kind, PENDING_NONE, Ordering::AcqRel, Ordering::Relaxed)
+            .is_err()
+        {
+            return;
+        }
+        let since = self.pending_since.load(Ordering::Relaxed);
+        let elapsed = self.now_us().saturating_sub(since);
+        match kind {
+            PENDING_STARTUP => self.startup_us.record(elapsed),
+            PENDING_SEEK    => self.seek_us.record(elapsed),
+            _ => {}
+        }
+    }
+
+    // ── Reset / export ────────────────────────────────────────────────────
+
+    pub fn reset(&self) {
+        self.callbacks.store(0, Ordering::Relaxed);
+        self.callback_overruns.store(0, Ordering::Relaxed);
+        self.callback_us.reset();
+        self.callback_load.reset();
+        self.callback_lock_wait_us.reset();
+        self.queue_fill.reset();
+        self.decode_packet_us.reset();
+        self.decode_lock_wait_us.reset();
+        self.decode_wait_us.reset();
+        self.startup_us.reset();
+        self.seek_us.reset();
+        self.set_source_us.reset();
+        self.source_load_us.reset();
+        self.sample_trigger_us.reset();
+    }
+
+    /// Render every counter and histogram summary as a JSON object.
+    ///
+    /// `underruns` is passed in by the engine because it lives in
+    /// `SharedPlayback`.
+    pub fn snapshot_json(&self, underruns: u32) -> String {
+        json!({
+            "uptime_us":          self.now_us(),
+            "underruns":          underruns,
+            "callbacks":          self.callbacks.load(Ordering::Relaxed),
+            "callback_overruns":  self.callback_overruns.load(Ordering::Relaxed),
+            "callback_us":        self.callback_us.summary(),
+            "callback_load_permille": self.callback_load.summary(),
+            "callback_lock_wait_us":  self.callback_lock_wait_us.summary(),
+            "queue_fill_permille":    self.queue_fill.summary(),
+            "decode_packet_us":       self.decode_packet_us.summary(),
+            "decode_lock_wait_us":    self.decode_lock_wait_us.summary(),
+            "decode_wait_us":         self.decode_wait_us.summary(),
+            "startup_us":         self.startup_us.summary(),
+            "seek_us":            self.seek_us.summary(),
+            "set_source_us":      self.set_source_us.summary(),
+            "source_load_us":     self.source_load_us.summary(),
+            "sample_trigger_us":  self.sample_trigger_us.summary(),
+        })
+        .to_string()
+    }
+
+    /// Write the recent callback history as a Chrome trace-event file
+    /// (loadable in `chrome://tracing` or Perfetto).
+    ///
+    /// Each callback becomes a complete (`"X"`) slice, and queue fill and
+    /// load are emitted as counter (`"C"`) tracks.
+    pub fn write_trace(&self, path: &str) -> Result<(), String> {
+        let file = File::create(path)
+            .map_err(|e| format!("Failed to create trace file '{path}': {e}"))?;
+        let mut out = BufWriter::new(file);
+
+        let head  = self.trace_head.load(Ordering::Acquire);
+        let len   = self.trace.len();
+        let count = head.min(len);
+
+        let mut events = Vec::with_capacity(count * 2);
+        for i in (head - count)..head {
+            let entry    = &self.trace[i % len];
+            let ts       = entry.start_us.load(Ordering::Relaxed);
+            let dur      = entry.duration_us.load(Ordering::Relaxed);
+            let deadline = entry.deadline_us.load(Ordering::Relaxed);
+            let fill     = entry.fill_permille.load(Ordering::Relaxed);
+            events.push(json!({
+                "name": "callback", "ph": "X", "pid": 1, "tid": 1,
+                "ts": ts, "dur": dur,
+                "args": { "deadline_us": deadline },
+            }));
+            events.push(json!({
+                "name": "queue", "ph": "C", "pid": 1, "ts": ts,
+                "args": { "fill_permille": fill },
+            }));
+        }
+
+        let doc = json!({ "traceEvents": events, "displayTimeUnit": "ms" });
+        serde_json::to_writer(&mut out, &doc)
+            .map_err(|e| format!("Failed to write trace file '{path}': {e}"))?;
+        out.flush()
+            .map_err(|e| format!("Failed to flush trace file '{path}': {e}"))
+    }
+}
+
+impl Default for EngineMetrics {
+    fn default() -> Self { Self::new() }
+}
+
+// ── CallbackProbe ─────────────────────────────────────────────────────────────
+
+/// Scoped timer for one cpal callback (see [`EngineMetrics::begin_callback`]).
+pub struct CallbackProbe<'a> {
+    metrics: &'a EngineMetrics,
+    started: Instant,
+}
+
+/// Single-writer counter increment; see [`Histogram::record_owned`].
+#[inline]
+fn bump(counter: &AtomicU64, by: u64) {
+    counter.store(counter.load(Ordering::Relaxed).wrapping_add(by), Ordering::Relaxed);
+}
+
+// The callback thread is the only writer of every histogram and counter
+// touched below, so the probe records with `record_owned` / `bump` and
+// keeps its cost to three clock reads plus plain stores.
+impl CallbackProbe<'_> {
+    /// Record how long the callback waited for the shared lock.
+    #[inline]
+    pub fn lock_acquired(&self) {
+        let waited = self.started.elapsed().as_micros() as u64;
+        self.metrics.callback_lock_wait_us.record_owned(waited);
+    }
+
+    /// Finish timing the callback.
+    ///
+    /// * `frames` / `sample_rate` define the buffer deadline.
+    /// * `queued` / `capacity` give the queue fill level at callback start.
+    /// * `emitted` is `true` if any real (non-silent) sample was produced.
+    #[inline]
+    pub fn finish(
+        self,
+        frames:      usize,
+        sample_rate: u32,
+        queued:      usize,
+        capacity:    usize,
+        emitted:     bool,
+    ) {
+        let m = self.metrics;
+        let elapsed_us  = self.started.elapsed().as_micros() as u64;
+        let deadline_us = if sample_rate > 0 {
+            (frames as u64).saturating_mul(1_000_000) / sample_rate as u64
+        } else {
+            0
+        };
+        let fill = if capacity > 0 {
+            ((queued as u64).saturating_mul(1000) / capacity as u64).min(1000)
+        } else {
+            0
+        };
+
+        bump(&m.callbacks, 1);
+        m.callback_us.record_owned(elapsed_us);
+        m.queue_fill.record_owned(fill);
+        if deadline_us > 0 {
+            m.callback_load.record_owned(elapsed_us.saturating_mul(1000) / deadline_us);
+            if elapsed_us > deadline_us {
+                bump(&m.callback_overruns, 1);
+            }
+        }
+        if emitted {
+            m.audio_emitted();
+        }
+
+        // Single writer: the callback thread owns `trace_head`.
+        let head  = m.trace_head.load(Ordering::Relaxed);
+        let entry = &m.trace[head % m.trace.len()];
+        entry.start_us.store(
+            self.started.saturating_duration_since(m.epoch).as_micros() as u64,
+            Ordering::Relaxed,
+        );
+        entry.duration_us.store(elapsed_us.min(u32::MAX as u64) as u32, Ordering::Relaxed);
+        entry.deadline_us.store(deadline_us.min(u32::MAX as u64) as u32, Ordering::Relaxed);
+        entry.fill_permille.store(fill as u32, Ordering::Relaxed);
+        m.trace_head.store(head.wrapping_add(1), Ordering::Release);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::{Arc, Mutex};
+
+    use crate::chain_exchange::{ChainExchange, ChainRuntime};
+    use crate::effects::{build_channel_chains, FilterSpec};
+    use crate::player_state::SharedPlayback;
+
+    #[test]
+    fn histogram_quantiles_stay_within_bucket_precision() {
+        let h = Histogram::new();
+        for v in 1..=10_000 {
+            h.record(v);
+        }
+        let s = h.summary();
+        for (key, exact) in [("p50", 5_000.0), ("p90", 9_000.0), ("p99", 9_900.0)] {
+            let got = s[key].as_u64().unwrap() as f64;
+            assert!(got <= exact && got >= exact * 0.875, "{key} = {got}, exact {exact}");
+        }
+        assert_eq!(s["count"], 10_000);
+        assert_eq!(s["max"], 10_000);
+    }
+
+    #[test]
+    fn probe_records_one_callback() {
+        let m = EngineMetrics::new();
+        let probe = m.begin_callback();
+        probe.lock_acquired();
+        probe.finish(480, 48_000, 250, 1_000, true);
+
+        assert_eq!(m.callbacks.load(Ordering::Relaxed), 1);
+        assert_eq!(m.callback_us.count.load(Ordering::Relaxed), 1);
+        assert_eq!(m.callback_lock_wait_us.count.load(Ordering::Relaxed), 1);
+        assert_eq!(m.queue_fill.max.load(Ordering::Relaxed), 250);
+        assert_eq!(m.trace_head.load(Ordering::Relaxed), 1);
+        assert_eq!(m.trace[0].deadline_us.load(Ordering::Relaxed), 10_000);
+    }
+
+    /// `cargo test --release -- --ignored --nocapture callback_probe_overhead`
+    ///
+    /// Cost of the probe against a typical callback: 512 stereo frames of
+    /// queued audio through three peaking filters.
+    #[test]
+    #[ignore]
+    fn callback_probe_overhead() {
+        const FRAMES: usize = 512;
+        const RUNS:   usize = 20_000;
+
+        let shared = Mutex::new(SharedPlayback::new(2, 48_000));
+        {
+            let mut g = shared.lock().unwrap();
+            g.stream_finished = false;
+            g.set_playing(true);
+        }
+        let exchange = Arc::new(ChainExchange::new());
+        let specs: Vec<FilterSpec> = [100.0, 1_000.0, 8_000.0]
+            .into_iter()
+            .map(|center_hz| FilterSpec::Peak { center_hz, gain_db: 3.0, q: 1.0 })
+            .collect();
+        exchange.publish(build_channel_chains(&specs, 48_000, 2));
+        let mut chains = ChainRuntime::new(exchange, Default::default(), 2, 48_000);
+        let source: Vec<f32> = (0..FRAMES * 2).map(|n| (n as f32 * 0.01).sin() * 0.5).collect();
+        let mut out = vec![0.0f32; FRAMES * 2];
+
+        let mut render = |chains: &mut ChainRuntime, g: &mut SharedPlayback| {
+            g.push_samples_bounded(&source);
+            chains.refresh(FRAMES);
+            for (i, o) in out.iter_mut().enumerate() {
+                *o = g.next_sample(chains, i % 2, 0.0);
+            }
+            std::hint::black_box(&out);
+        };
+
+        let metrics = EngineMetrics::new();
+        let time = |f: &mut dyn FnMut()| {
+            let started = Instant::now();
+            for _ in 0..RUNS {
+                f();
+            }
+            started.elapsed().as_nanos() as f64 / RUNS as f64
+        };
+
+        let bare = time(&mut || {
+            let mut g = shared.lock().unwrap();
+            render(&mut chains, &mut g);
+        });
+        let probed = time(&mut || {
+            let probe = metrics.begin_callback();
+            let mut g = shared.lock().unwrap();
+            probe.lock_acquired();
+            render(&mut chains, &mut g);
+            probe.finish(FRAMES, 48_000, g.queue.len(), g.max_samples, true);
+        });
+        let probe_only = time(&mut || {
+            let probe = metrics.begin_callback();
+            probe.lock_acquired();
+            probe.finish(FRAMES, 48_000, 1_000, 2_000, true);
+        });
+
+        let share = probe_only / bare * 100.0;
+        println!(
+            "callback {bare:.0} ns, with probe {probed:.0} ns; probe alone {probe_only:.0} ns = {share:.2} % \
+             of the callback, {:.4} % of the {} µs deadline",
+            probe_only / (FRAMES as f64 * 1e9 / 48_000.0) * 100.0,
+            FRAMES * 1_000_000 / 48_000,
+        );
+        assert!(share < 1.0);
+    }
+}
@@ -0,0 +1,289 @@
+/// Channel-layout-aware mixing from a source layout to the device layout.
+///
+/// A [`MixMatrix`] is built once per (source layout, output channel count)
+/// pair and cached in [`crate::player_state::ResampleState`], so the
+/// resampler applies a fixed set of gains per frame instead of re-deciding
+/// how to map channels for every sample.
+///
+/// Downmix gains follow ITU-R BS.775: centre and surrounds fold into the
+/// front pair at −3 dB (`1/√2`), and LFE is dropped unless the output has an
+/// LFE channel.  A matrix whose rows would sum above unity is scaled down
+/// uniformly so a full-scale downmix cannot clip.  Upmixing only routes
+/// channels the output actually has; mono sources play at unity on the
+/// front pair.
+///
+/// The device side only reports a channel count, so output layouts are
+/// assumed to use the standard WAVE/ALSA ordering for that count.
+
+/// −3 dB, the ITU fold-down gain.
+const MINUS_3DB: f32 = std::f32::consts::FRAC_1_SQRT_2;
+
+// Speaker positions, using the bit layout of Symphonia's `Channels`.
+const FL:   u32 = 1 << 0;
+const FR:   u32 = 1 << 1;
+const FC:   u32 = 1 << 2;
+const LFE:  u32 = 1 << 3;
+const RL:   u32 = 1 << 4;
+const RC:   u32 = 1 << 5;
+const RR:   u32 = 1 << 6;
+const LFE2: u32 = 1 << 7;
+const FLC:  u32 = 1 << 8;
+const FRC:  u32 = 1 << 9;
+const RLC:  u32 = 1 << 10;
+const RRC:  u32 = 1 << 11;
+const FLW:  u32 = 1 << 12;
+const FRW:  u32 = 1 << 13;
+const FLH:  u32 = 1 << 14;
+const FCH:  u32 = 1 << 15;
+const FRH:  u32 = 1 << 16;
+const RLH:  u32 = 1 << 17;
+const RCH:  u32 = 1 << 18;
+const RRH:  u32 = 1 << 19;
+const SL:   u32 = 1 << 20;
+const SR:   u32 = 1 << 21;
+
+/// Default speaker order for a bare channel count.
+fn default_layout(channels: usize) -> Vec<u32> {
+    match channels {
+        1 => vec![FC],
+        2 => vec![FL, FR],
+        3 => vec![FL, FR, FC],
+        4 => vec![FL, FR, RL, RR],
+        5 => vec![FL, FR, FC, RL, RR],
+        6 => vec![FL, FR, FC, LFE, RL, RR],
+        7 => vec![FL, FR, FC, LFE, RC, SL, SR],
+        _ => {
+            // 7.1 plus unassigned extra channels, which stay silent.
+            let mut layout = vec![FL, FR, FC, LFE, RL, RR, SL, SR];
+            layout.resize(channels, 0);
+            layout
+        }
+    }
+}
+
+/// Speakers of a Symphonia channel mask in interleaving (bit) order, or the
+/// default layout when the mask does not describe `channels` channels.
+fn source_layout(mask: u32, channels: usize) -> Vec<u32> {
+    if mask.count_ones() as usize != channels || channels == 1 {
+        return default_layout(channels);
+    }
+    (0..32).map(|bit| 1u32 << bit).filter(|s| mask & s != 0).collect()
+}
+
+/// Call `add(target, gain)` for every output speaker `speaker` feeds.
+fn route(speaker: u32, out_mask: u32, gain: f32, add: &mut impl FnMut(u32, f32)) {
+    if speaker & out_mask != 0 {
+        add(speaker, gain);
+        return;
+    }
+    let has = |s: u32| out_mask & s != 0;
+    let pair = |l: u32, r: u32, g: f32, add: &mut dyn FnMut(u32, f32)| {
+        add(l, gain * g);
+        add(r, gain * g);
+    };
+
+    match speaker {
+        FC   => pair(FL, FR, MINUS_3DB, add),
+        LFE  => {}
+        LFE2 => if has(LFE) { add(LFE, gain) },
+        RL   => if has(SL) { add(SL, gain) } else { add(FL, gain * MINUS_3DB) },
+        RR   => if has(SR) { add(SR, gain) } else { add(FR, gain * MINUS_3DB) },
+        SL   => if has(RL) { add(RL, gain) } else { add(FL, gain * MINUS_3DB) },
+        SR   => if has(RR) { add(RR, gain) } else { add(FR, gain * MINUS_3DB) },
+        RC   => {
+            if has(RL) && has(RR) {
+                pair(RL, RR, MINUS_3DB, add);
+            } else if has(SL) && has(SR) {
+                pair(SL, SR, MINUS_3DB, add);
+            } else {
+                pair(FL, FR, 0.5, add);
+            }
+        }
+        FLC | FLW | FLH => route(FL, out_mask, gain, add),
+        FRC | FRW | FRH => route(FR, out_mask, gain, add),
+        RLC | RLH       => route(RL, out_mask, gain, add),
+        RRC | RRH       => route(RR, out_mask, gain, add),
+        FCH             => route(FC, out_mask, gain, add),
+        RCH             => route(RC, out_mask, gain, add),
+        // Unknown positions are treated as centre-panned.
+        _ => pair(FL, FR, MINUS_3DB, add),
+    }
+}
+
+// ── MixMatrix ─────────────────────────────────────────────────────────────────
+
+/// Fixed gains mapping one source frame to one output frame.
+#[derive(Default)]
+pub struct MixMatrix {
+    src_mask:     u32,
+    src_channels: usize,
+    out_channels: usize,
+    /// The matrix is the identity; frames are copied as-is.
+    identity:     bool,
+    /// Row-major `out_channels × src_channels` gains.  Dense: with at most
+    /// a handful of channels a branch-free dot product per output channel
+    /// beats walking sparse taps.
+    gains:        Box<[f32]>,
+}
+
+impl MixMatrix {
+    /// Build the matrix for a source with Symphonia channel mask `src_mask`
+    /// and `src_channels` channels, played on `out_channels` channels.
+    pub fn new(src_mask: u32, src_channels: usize, out_channels: usize) -> Self {
+        let src = source_layout(src_mask, src_channels);
+        let mut dense = vec![0.0f32; out_channels * src_channels];
+
+        if src_channels == 1 || out_channels == 1 {
+            Self::fill_mono(&src, out_channels, &mut dense);
+        } else {
+            let out = default_layout(out_channels);
+            let out_mask = out.iter().fold(0, |m, s| m | s);
+            for (s, &speaker) in src.iter().enumerate() {
+                route(speaker, out_mask, 1.0, &mut |target, gain| {
+                    if let Some(o) = out.iter().position(|&t| t == target) {
+                        dense[o * src_channels + s] += gain;
+                    }
+                });
+            }
+        }
+
+        // Scale down so no output channel can exceed full scale.
+        let peak = dense
+            .chunks_exact(src_channels.max(1))
+            .map(|row| row.iter().map(|g| g.abs()).sum::<f32>())
+            .fold(0.0f32, f32::max);
+        if peak > 1.0 {
+            dense.iter_mut().for_each(|g| *g /= peak);
+        }
+
+        let identity = src_channels == out_channels
+            && dense.iter().enumerate().all(|(i, &g)| {
+                let (o, s) = (i / src_channels, i % src_channels);
+                g == if o == s { 1.0 } else { 0.0 }
+            });
+
+        Self { src_mask, src_channels, out_channels, identity, gains: dense.into() }
+    }
+
+    /// Mono on either side: a mono source plays at unity on the front pair,
+    /// and a mono output is the average of the source's stereo downmix.
+    fn fill_mono(src: &[u32], out_channels: usize, dense: &mut [f32]) {
+        let src_channels = src.len();
+        if src_channels == 1 {
+            let out = default_layout(out_channels);
+            let front: Vec<usize> = if out_channels == 1 {
+                vec![0]
+            } else {
+                out.iter()
+                    .enumerate()
+                    .filter(|(_, s)| **s == FL || **s == FR)
+                    .map(|(o, _)| o)
+                    .collect()
+            };
+            for o in front {
+                dense[o] = 1.0;
+            }
+            return;
+        }
+
+        for (s, &speaker) in src.iter().enumerate() {
+            route(speaker, FL | FR, 0.5, &mut |_, gain| dense[s] += gain);
+        }
+    }
+
+    /// Whether this matrix was built for the given source and output.
+    pub fn matches(&self, src_mask: u32, src_channels: usize, out_channels: usize) -> bool {
+        self.src_channels == src_channels
+            && self.out_channels == out_channels
+            && self.src_mask == src_mask
+            && !self.gains.is_empty()
+    }
+
+    pub fn is_identity(&self) -> bool { self.identity }
+
+    /// Mix the interleaved source frames in `src` into `out`, which holds
+    /// the same number of output frames.  Common layouts get a kernel with
+    /// the channel counts fixed at compile time, which unrolls fully.
+    pub fn apply_block(&self, src: &[f32], out: &mut [f32]) {
+        match (self.src_channels, self.out_channels) {
+            (1, 2) => self.apply_fixed::<1, 2>(src, out),
+            (1, 8) => self.apply_fixed::<1, 8>(src, out),
+            (2, 1) => self.apply_fixed::<2, 1>(src, out),
+            (2, 6) => self.apply_fixed::<2, 6>(src, out),
+            (2, 8) => self.apply_fixed::<2, 8>(src, out),
+            (6, 2) => self.apply_fixed::<6, 2>(src, out),
+            (6, 8) => self.apply_fixed::<6, 8>(src, out),
+            (8, 2) => self.apply_fixed::<8, 2>(src, out),
+            (8, 6) => self.apply_fixed::<8, 6>(src, out),
+            (8, 8) => self.apply_fixed::<8, 8>(src, out),
+            _ => {
+                let frames = src.chunks_exact(self.src_channels).zip(out.chunks_exact_mut(self.out_channels));
+                for (frame, mixed) in frames {
+                    for (o, row) in mixed.iter_mut().zip(self.gains.chunks_exact(self.src_channels)) {
+                        *o = row.iter().zip(frame).map(|(g, s)| g * s).sum();
+                    }
+                }
+            }
+        }
+    }
+
+    fn apply_fixed<const S: usize, const O: usize>(&self, src: &[f32], out: &mut [f32]) {
+        let mut gains = [[0.0f32; S]; O];
+        for (row, dense) in gains.iter_mut().zip(self.gains.chunks_exact(S)) {
+            row.copy_from_slice(dense);
+        }
+        for (frame, mixed) in src.chunks_exact(S).zip(out.chunks_exact_mut(O)) {
+            for (o, row) in mixed.iter_mut().zip(&gains) {
+                *o = row.iter().zip(frame).map(|(g, s)| g * s).sum();
+            }
+        }
+    }
+
+    /// Mix one source `frame` and append the output frame to `out`.
+    #[inline]
+    pub fn apply(&self, frame: &[f32], out: &mut Vec<f32>) {
+        out.extend(
+            self.gains
+                .chunks_exact(self.src_channels)
+                .map(|row| row.iter().zip(frame).map(|(g, s)| g * s).sum::<f32>()),
+        );
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn block_kernels_match_frame_by_frame() {
+        let pairs = [(1, 2), (1, 8), (2, 1), (2, 6), (2, 8), (6, 2), (6, 8), (8, 2), (8, 6), (8, 8), (3, 2), (6, 6)];
+        for (src_channels, out_channels) in pairs {
+            let mix = MixMatrix::new(0, src_channels, out_channels);
+            let src: Vec<f32> = (0..64 * src_channels).map(|n| (n as f32 * 0.37).sin()).collect();
+
+            let mut expected = Vec::new();
+            for frame in src.chunks_exact(src_channels) {
+                mix.apply(frame, &mut expected);
+            }
+            let mut block = vec![0.0; 64 * out_channels];
+            mix.apply_block(&src, &mut block);
+            assert_eq!(block, expected, "{src_channels} → {out_channels}");
+        }
+    }
+
+    #[test]
+    fn surround_downmix_keeps_centre_and_surrounds() {
+        let mix = MixMatrix::new(0, 6, 2);
+        let mut out = Vec::new();
+        // FL FR FC LFE RL RR, one speaker at a time.
+        for speaker in 0..6 {
+            let mut frame = [0.0; 6];
+            frame[speaker] = 1.0;
+            mix.apply(&frame, &mut out);
+        }
+        let left: Vec<f32> = out.iter().step_by(2).copied().collect();
+        assert!(left[2] > 0.0 && left[4] > 0.0, "centre and left surround reach the left channel");
+        assert_eq!(left[3], 0.0, "LFE is dropped");
+        assert!(left[0] > left[2]);
+    }
+}
@@ -1,12 +1,20 @@
 use std::collections::VecDeque;
-use std::time::Duration;
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::Arc;
+use std::time::{Duration, Instant};
 
-use crate::effects::Effects;
+use crate::capture::MonitorTap;
+use crate::chain_exchange::ChainRuntime;
 use crate::enums::{
     DEFAULT_MAX_QUEUE_SECONDS, DEFAULT_VISUALIZER_SECONDS, MAX_MAX_QUEUE_SECONDS,
-    MIN_MAX_QUEUE_SECONDS,
+    MAX_SAMPLE_VOICES, MIN_MAX_QUEUE_SECONDS,
 };
 use crate::error::AudioError;
+use crate::events::AudioEvent;
+use crate::mix_matrix::MixMatrix;
+use crate::sample_bank::SampleVoice;
+use crate::sample_queue::{QueueStorage, SampleQueue};
+use crate::schedule::{Schedule, Scheduled, ScheduledCommand};
 
 // ── PlaybackStatus ────────────────────────────────────────────────────────────
 
@@ -49,6 +57,61 @@ impl From<&PlaybackStatus> for PlayerState {
     }
 }
 
+// ── SourceLoad ────────────────────────────────────────────────────────────────
+
+/// Progress of the background probe started by `set_source`.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum LoadState {
+    /// No source has been set.
+    Idle,
+    /// The source is being opened and probed.
+    Loading,
+    /// The source was probed; `duration_millis` is final.
+    Ready,
+    /// Opening or probing the source failed.
+    Failed,
+}
+
+/// Probe result for the current source.
+///
+/// Tagged with the `set_source` generation that requested it, so a late
+/// result for a source that has since been replaced is discarded.
+pub struct SourceLoad {
+    pub generation:      u64,
+    pub state:           LoadState,
+    /// `-1` while loading or when the container declares no duration.
+    pub duration_millis: i32,
+    /// When `set_source` started the current load.
+    pub requested:       Instant,
+}
+
+impl SourceLoad {
+    pub fn new() -> Self {
+        Self { generation: 0, state: LoadState::Idle, duration_millis: -1, requested: Instant::now() }
+    }
+
+    /// Start a new load and return its generation.
+    pub fn begin(&mut self) -> u64 {
+        self.generation      = self.generation.wrapping_add(1);
+        self.state           = LoadState::Loading;
+        self.duration_millis = -1;
+        self.requested       = Instant::now();
+        self.generation
+    }
+
+    /// Record the outcome of load `generation`.  Returns `false` (and
+    /// changes nothing) if a newer load has started since or this one was
+    /// already resolved, so only the first job to open a source reports it.
+    pub fn resolve(&mut self, generation: u64, state: LoadState, duration_millis: i32) -> bool {
+        if generation != self.generation || self.state != LoadState::Loading {
+            return false;
+        }
+        self.state           = state;
+        self.duration_millis = duration_millis;
+        true
+    }
+}
+
 // ── ResampleState ─────────────────────────────────────────────────────────────
 
 /// Carries fractional position and boundary samples across decode packets.
@@ -59,14 +122,21 @@ impl From<&PlaybackStatus> for PlayerState {
 pub struct ResampleState {
     /// Current fractional position within the current packet (source frames).
     pub pos: f64,
-    /// The last *source* frame of the previous packet, used as the left
-    /// neighbour for the first interpolated output sample of the next packet.
+    /// The last frame of the previous packet, already mixed to the output
+    /// layout, used as the left neighbour for the first interpolated output
+    /// sample of the next packet.
     pub carry: Vec<f32>,
+    /// Channel mix for the current source layout; rebuilt only when the
+    /// layout or the output channel count changes.
+    pub mix: MixMatrix,
+    /// The carry frame followed by the current packet, mixed to the output
+    /// layout.  Reused across packets.
+    pub mixed: Vec<f32>,
 }
 
 impl ResampleState {
     pub fn new() -> Self {
-        Self { pos: 0.0, carry: Vec::new() }
+        Self { pos: 0.0, carry: Vec::new(), mix: MixMatrix::default(), mixed: Vec::new() }
     }
 
     pub fn reset(&mut self) {
@@ -79,6 +149,30 @@ impl Default for ResampleState {
     fn default() -> Self { Self::new() }
 }
 
+// ── StagedSeek ────────────────────────────────────────────────────────────────
+
+/// Audio decoded from the target of a scheduled seek, waiting to replace
+/// the live queue at the seek's due frame.
+///
+/// A second decode job fills `queue` while the current one keeps feeding
+/// playback.  When the seek fires the callback swaps the two queues and
+/// raises `replaced_stop`; the staged job then writes to the live queue.
+/// The swapped-out queue stays here until a non-audio thread takes it with
+/// [`SharedPlayback::take_retired`], so the callback never frees memory.
+pub struct StagedSeek {
+    /// Id of the scheduled seek.
+    pub id:               u32,
+    pub queue:            SampleQueue,
+    /// `source_position_samples` once the seek has fired.
+    pub position_samples: f64,
+    /// The staged job has decoded the whole source.
+    pub finished:         bool,
+    /// Stop flag of the job feeding the queue that is being replaced.
+    pub replaced_stop:    Arc<AtomicBool>,
+    /// The seek fired; `queue` now holds the replaced audio.
+    pub swapped:          bool,
+}
+
 // ── SharedPlayback ────────────────────────────────────────────────────────────
 
 /// State that is **shared** between the audio-callback thread and any thread
@@ -88,14 +182,31 @@ impl Default for ResampleState {
 /// is held only for the shortest possible time to avoid priority inversion.
 pub struct SharedPlayback {
     // ── Sample queues ─────────────────────────────────────────────────────
-    /// Ready-to-play interleaved `f32` samples fed by the decode thread and
-    /// consumed by the cpal callback.
-    pub queue: VecDeque<f32>,
+    /// Ready-to-play interleaved samples fed by the decode thread and
+    /// consumed by the cpal callback, stored as `f32` or a compact 16-bit
+    /// format (see [`QueueStorage`]).
+    pub queue: SampleQueue,
 
     /// Recent samples kept for visualiser use.  Written by the cpal callback
     /// after applying volume; read by the visualiser on the UI thread.
     pub visualizer_ring: VecDeque<f32>,
 
+    /// Cached sounds currently playing on top of the main source.  Capacity
+    /// is reserved up front so triggering never allocates.  Kept in trigger
+    /// order read cyclically from `oldest_voice`.
+    pub voices: Vec<SampleVoice>,
+
+    /// Index of the oldest entry in `voices` — the one a trigger into a
+    /// full pool replaces.
+    oldest_voice: usize,
+
+    /// Captured input mixed into the output ahead of the effect chains,
+    /// while a capture is being monitored.
+    pub monitor: Option<Arc<MonitorTap>>,
+
+    /// Decoded audio for a pending scheduled seek.
+    pub staged: Option<StagedSeek>,
+
     // ── Queue sizing ──────────────────────────────────────────────────────
     pub max_samples:          usize,
     pub max_queue_seconds:    usize,
@@ -128,10 +239,9 @@ pub struct SharedPlayback {
     /// Sample rate of the output device (Hz).
     pub sample_rate: u32,
 
-    // ── Per-channel DSP ───────────────────────────────────────────────────
-    /// One `Effects` chain per output channel.  Indexed by
-    /// `emitted_samples % effects.len()`.
-    pub effects: Vec<Effects>,
+    /// Channel count of the output device.  Per-channel effects are indexed
+    /// by `emitted_samples % channels`.
+    pub channels: usize,
 
     // ── Detailed status ───────────────────────────────────────────────────
     /// Fine-grained playback status used for event emission.
@@ -140,6 +250,13 @@ pub struct SharedPlayback {
     // ── Underrun counter ──────────────────────────────────────────────────
     /// Cumulative buffer-underrun count since last reset.
     pub underrun_count: u32,
+
+    // ── Output clock ──────────────────────────────────────────────────────
+    /// Output frames rendered since the engine was created (engine sample
+    /// time).  Never reset; advanced by the callback after every block.
+    pub frames: u64,
+    /// Commands due at a given output frame (see [`crate::schedule`]).
+    pub schedule: Schedule,
 }
 
 impl SharedPlayback {
@@ -153,8 +270,12 @@ impl SharedPlayback {
             .saturating_mul(DEFAULT_VISUALIZER_SECONDS);
 
         Self {
-            queue:                   VecDeque::with_capacity(max_samples),
+            queue:                   SampleQueue::new(QueueStorage::F32, max_samples),
             visualizer_ring:         VecDeque::with_capacity(visualizer_max_samples),
+            voices:                  Vec::with_capacity(MAX_SAMPLE_VOICES),
+            oldest_voice:            0,
+            monitor:                 None,
+            staged:                  None,
             visualizer_max_samples,
             max_samples,
             max_queue_seconds:       DEFAULT_MAX_QUEUE_SECONDS,
@@ -165,9 +286,11 @@ impl SharedPlayback {
             emitted_samples:         0,
             source_position_samples: 0.0,
             sample_rate,
-            effects:                 (0..channels.max(1)).map(|_| Effects::new()).collect(),
+            channels:                channels.max(1),
             status:                  PlaybackStatus::Idle,
             underrun_count:          0,
+            frames:                  0,
+            schedule:                Schedule::new(),
         }
     }
 
@@ -176,10 +299,32 @@ impl SharedPlayback {
     /// Push up to `max_samples - queue.len()` samples.  Returns the count
     /// actually pushed; caller retries the rest after sleeping.
     pub fn push_samples_bounded(&mut self, samples: &[f32]) -> usize {
-        let available = self.max_samples.saturating_sub(self.queue.len());
-        let push_count = samples.len().min(available);
-        self.queue.extend(samples.iter().take(push_count).copied());
-        push_count
+        push_bounded(&mut self.queue, self.max_samples, samples)
+    }
+
+    /// Push decoded output for a job that decodes for staged seek `staged`,
+    /// or for the live queue when `None`.  Once the seek has fired (or is
+    /// gone) the job is switched to the live queue.  Returns the count
+    /// pushed and the length of the queue written to.
+    pub fn push_decoded(&mut self, staged: &mut Option<u32>, samples: &[f32]) -> (usize, usize) {
+        if let Some(id) = *staged {
+            match self.staged.as_mut() {
+                Some(seek) if seek.id == id && !seek.swapped => {
+                    let pushed = push_bounded(&mut seek.queue, self.max_samples, samples);
+                    return (pushed, seek.queue.len());
+                }
+                _ => *staged = None,
+            }
+        }
+        (self.push_samples_bounded(samples), self.queue.len())
+    }
+
+    /// Record that a job decoded its whole source (see [`Self::push_decoded`]).
+    pub fn finish_decoding(&mut self, staged: Option<u32>) {
+        match self.staged.as_mut() {
+            Some(seek) if Some(seek.id) == staged && !seek.swapped => seek.finished = true,
+            _ => self.stream_finished = true,
+        }
     }
 
     /// Resize the queue cap.  Excess samples are dropped from the front.
@@ -189,14 +334,18 @@ impl SharedPlayback {
         self.max_samples = (self.sample_rate as usize)
             .saturating_mul(channels)
             .saturating_mul(bounded);
-        while self.queue.len() > self.max_samples {
-            self.queue.pop_front();
-        }
+        self.queue.truncate_front(self.max_samples);
         if self.queue.capacity() < self.max_samples {
-            self.queue.reserve(self.max_samples.saturating_sub(self.queue.capacity()));
+            self.queue.reserve_total(self.max_samples);
         }
     }
 
+    /// Switch the queue's storage format, converting what is already
+    /// buffered so playback continues without a gap.
+    pub fn set_queue_storage(&mut self, storage: QueueStorage) {
+        self.queue.convert(storage, self.max_samples);
+    }
+
     // ── Visualiser helpers ────────────────────────────────────────────────
 
     pub fn push_visualizer_sample(&mut self, sample: f32) {
@@ -211,77 +360,197 @@ impl SharedPlayback {
 
     /// Copy the most recent `out.len()` samples from the visualiser ring into
     /// `out`.  Returns the number of samples written.
+    ///
+    /// The ring is at most two contiguous segments, so this is at most two
+    /// bulk copies.
     pub fn copy_latest_visualizer_samples(&self, out: &mut [f32]) -> usize {
-        if out.is_empty() || self.visualizer_ring.is_empty() {
-            return 0;
-        }
         let count = out.len().min(self.visualizer_ring.len());
-        let skip  = self.visualizer_ring.len().saturating_sub(count);
-        for (i, s) in self.visualizer_ring.iter().skip(skip).take(count).enumerate() {
-            out[i] = *s;
-        }
+        let skip  = self.visualizer_ring.len() - count;
+        let (front, back) = match self.visualizer_ring.as_slices() {
+            (front, back) if skip < front.len() => (&front[skip..], back),
+            (front, back) => (&[][..], &back[skip - front.len()..]),
+        };
+        out[..front.len()].copy_from_slice(front);
+        out[front.len()..count].copy_from_slice(back);
         count
     }
 
+    // ── Scheduled seeks ───────────────────────────────────────────────────
+
+    /// Make the staged queue of seek `id` the live one.  Called by the
+    /// callback between two samples; swaps buffers and never allocates.
+    fn swap_in_staged(&mut self, id: u32) {
+        let Some(seek) = self.staged.as_mut() else { return };
+        if seek.id != id || seek.swapped {
+            return;
+        }
+        std::mem::swap(&mut self.queue, &mut seek.queue);
+        seek.swapped = true;
+        seek.replaced_stop.store(true, Ordering::SeqCst);
+        self.source_position_samples = seek.position_samples;
+        self.emitted_samples         = 0;
+        self.stream_finished         = seek.finished;
+    }
+
+    /// The queue replaced by a fired seek, for the caller to drop outside
+    /// the lock.
+    pub fn take_retired(&mut self) -> Option<StagedSeek> {
+        self.staged.take_if(|seek| seek.swapped)
+    }
+
+    /// Take the pending (not yet fired) seek, if it is `id` or `id` is
+    /// `None`, and drop its schedule entry.  The caller stops its job.
+    pub fn unstage(&mut self, id: Option<u32>) -> Option<StagedSeek> {
+        let seek = self.staged.take_if(|seek| !seek.swapped && id.is_none_or(|id| id == seek.id))?;
+        self.schedule.cancel(seek.id);
+        Some(seek)
+    }
+
     // ── State reset ───────────────────────────────────────────────────────
 
     /// Clear all transient audio state without touching volume / rate / device.
     pub fn clear_audio_state(&mut self) {
+        self.schedule.clear();
         self.queue.clear();
         self.visualizer_ring.clear();
         self.emitted_samples         = 0;
         self.source_position_samples = 0.0;
         self.stream_finished         = true;
         self.underrun_count          = 0;
-        for e in &mut self.effects {
-            *e = Effects::new();
-        }
     }
 
     // ── Hot-path sample output ────────────────────────────────────────────
 
     /// Called by the cpal callback for every output sample.
     ///
-    /// Returns 0.0 (silence) if paused, buffering, or the queue is empty.  
-    /// Applies per-channel effects and volume, then records the sample in the
+    /// `channel_index` is the sample's channel within its output frame and
+    /// `monitor` is captured input to mix in (0.0 when not monitoring).
+    /// Returns 0.0 (silence) if paused, buffering, or the queue is empty and
+    /// nothing is monitored.  Applies volume to the queued sample, adds the
+    /// monitor input, runs the channel's filters and convolver (owned by the
+    /// callback, see [`ChainRuntime`]), then records the sample in the
     /// visualiser ring.
     #[inline]
-    pub fn next_sample(&mut self) -> f32 {
-        if !self.playing {
-            return 0.0;
-        }
+    pub fn next_sample(&mut self, chains: &mut ChainRuntime, channel_index: usize, monitor: f32) -> f32 {
+        let queued = if self.playing { self.pop_queued() } else { None };
+        let sample = match queued {
+            Some(raw) => raw * self.volume + monitor,
+            None if monitor != 0.0 => monitor,
+            None => return 0.0,
+        };
 
-        let channel_count = self.effects.len().max(1);
-        let channel_index = (self.emitted_samples as usize) % channel_count;
+        // Apply per-channel DSP chain.
+        let sample = chains.process(sample, channel_index).clamp(-1.0, 1.0);
+        self.push_visualizer_sample(sample);
+        sample
+    }
 
-        let raw = match self.queue.pop_front() {
-            Some(s) => {
+    /// Pop the next queued sample and advance the position.  On an empty
+    /// queue, flags the end of the stream or counts an underrun.
+    #[inline]
+    fn pop_queued(&mut self) -> Option<f32> {
+        let sample = self.queue.pop_front();
+        match sample {
+            Some(_) => {
                 self.emitted_samples = self.emitted_samples.saturating_add(1);
                 self.source_position_samples += self.playback_rate as f64;
-                s
             }
-            None => {
-                if self.stream_finished {
-                    self.playing = false;
-                    self.status  = PlaybackStatus::Finished;
-                } else {
-                    // Queue empty but stream not done → underrun.
-                    self.underrun_count = self.underrun_count.saturating_add(1);
-                }
-                return 0.0;
+            None if self.stream_finished => {
+                self.playing = false;
+                self.status  = PlaybackStatus::Finished;
             }
+            // Queue empty but stream not done → underrun.
+            None => self.underrun_count = self.underrun_count.saturating_add(1),
+        }
+        sample
+    }
+
+    // ── Playback transitions ──────────────────────────────────────────────
+
+    /// Update the playing flag and status; returns the lifecycle event the
+    /// transition implies, if any.  Shared by the control thread and
+    /// commands the callback runs from the schedule.
+    pub fn set_playing(&mut self, playing: bool) -> Option<AudioEvent> {
+        let position = self.position(self.channels);
+        let event = match (playing, &self.status) {
+            (true, PlaybackStatus::Paused)   => Some(AudioEvent::PlaybackResumed { position }),
+            (true, PlaybackStatus::Playing)  => None,
+            (true, _)                        => Some(AudioEvent::PlaybackStarted),
+            (false, PlaybackStatus::Playing) => Some(AudioEvent::PlaybackPaused { position }),
+            (false, _)                       => None,
         };
+        // `stream_finished` is left alone: the source may have been fully
+        // decoded before play was pressed.  Only paths that restart the
+        // decoder clear it.
+        if playing {
+            self.status = PlaybackStatus::Playing;
+        } else {
+            self.status = PlaybackStatus::Paused;
+        }
+        self.playing = playing;
+        event
+    }
 
-        let mut sample = raw * self.volume;
+    /// Apply a scheduled command between two output samples; returns the
+    /// lifecycle event it implies, if any.
+    #[inline]
+    pub fn fire(&mut self, entry: &Scheduled) -> Option<AudioEvent> {
+        match entry.command {
+            ScheduledCommand::Play      => self.set_playing(true),
+            ScheduledCommand::Pause     => self.set_playing(false),
+            ScheduledCommand::Volume(v) => { self.volume = v; None }
+            ScheduledCommand::Seek(_)   => { self.swap_in_staged(entry.id); None }
+        }
+    }
 
-        // Apply per-channel DSP chain.
-        if let Some(effect) = self.effects.get_mut(channel_index) {
-            sample = effect.process(sample, channel_index);
+    // ── Sample voices ─────────────────────────────────────────────────────
+
+    /// Start a cached sound.  When all voices are busy the oldest one is
+    /// overwritten in place and the next one becomes the oldest, so a
+    /// trigger never shifts the pool.
+    pub fn trigger_voice(&mut self, voice: SampleVoice) {
+        if self.voices.len() < MAX_SAMPLE_VOICES {
+            // Newest goes just before the oldest: a plain push unless the
+            // pool has wrapped.
+            if self.oldest_voice == 0 {
+                self.voices.push(voice);
+            } else {
+                self.voices.insert(self.oldest_voice, voice);
+                self.oldest_voice += 1;
+            }
+        } else {
+            self.voices[self.oldest_voice] = voice;
+            self.oldest_voice = (self.oldest_voice + 1) % self.voices.len();
         }
+    }
 
-        let sample = sample.clamp(-1.0, 1.0);
-        self.push_visualizer_sample(sample);
-        sample
+    /// Mix every active voice into a rendered block, dropping voices that
+    /// finish.  Runs whether or not the main source is playing.
+    #[inline]
+    pub fn mix_voices<F: FnMut(Instant)>(&mut self, out: &mut [f32], mut on_start: F) {
+        if self.voices.is_empty() {
+            return;
+        }
+        // `retain_mut` keeps the cyclic order; step `oldest_voice` back over
+        // voices that finished before it.
+        let oldest = self.oldest_voice;
+        let mut index = 0;
+        let mut finished_before = 0;
+        self.voices.retain_mut(|voice| {
+            let finished = voice.mix_into(out, &mut on_start);
+            if finished && index < oldest {
+                finished_before += 1;
+            }
+            index += 1;
+            !finished
+        });
+        self.oldest_voice = oldest - finished_before;
+        if self.oldest_voice >= self.voices.len() {
+            self.oldest_voice = 0;
+        }
+        for sample in out.iter_mut() {
+            *sample = sample.clamp(-1.0, 1.0);
+        }
     }
 
     // ── Position helpers ──────────────────────────────────────────────────
@@ -300,4 +569,166 @@ impl SharedPlayback {
     pub fn position_millis(&self, out_channels: usize) -> i32 {
         self.position(out_channels).as_millis() as i32
     }
-}
\ No newline at end of file
+}
+
+/// Push up to `max - queue.len()` samples; returns the count pushed.
+fn push_bounded(queue: &mut SampleQueue, max: usize, samples: &[f32]) -> usize {
+    let count = samples.len().min(max.saturating_sub(queue.len()));
+    queue.extend_from_slice(&samples[..count]);
+    count
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::schedule::Due;
+
+    /// A source short enough to be decoded completely before play.
+    fn preloaded(samples: usize) -> SharedPlayback {
+        let mut s = SharedPlayback::new(2, 48_000);
+        s.stream_finished = false;
+        let (pushed, _) = s.push_decoded(&mut None, &vec![0.25; samples]);
+        assert_eq!(pushed, samples);
+        s.finish_decoding(None);
+        s
+    }
+
+    fn drain(s: &mut SharedPlayback, samples: usize) {
+        let mut chains = ChainRuntime::new(Default::default(), Default::default(), 2, 48_000);
+        for i in 0..samples {
+            s.next_sample(&mut chains, i % 2, 0.0);
+        }
+    }
+
+    #[test]
+    fn short_source_decoded_before_play_finishes() {
+        let mut s = preloaded(960);
+        assert!(matches!(s.set_playing(true), Some(AudioEvent::PlaybackStarted)));
+        drain(&mut s, 2_000);
+        assert_eq!(s.status, PlaybackStatus::Finished);
+        assert!(!s.playing);
+        assert_eq!(s.underrun_count, 0);
+    }
+
+    #[test]
+    fn scheduled_play_of_decoded_source_finishes() {
+        let mut s = preloaded(960);
+        s.fire(&Scheduled { id: 1, command: ScheduledCommand::Play, due: Due::Frame(0) });
+        drain(&mut s, 2_000);
+        assert_eq!(s.status, PlaybackStatus::Finished);
+        assert_eq!(s.underrun_count, 0);
+    }
+
+    #[test]
+    fn pause_and_resume_keep_finished_flag() {
+        let mut s = preloaded(960);
+        s.set_playing(true);
+        drain(&mut s, 100);
+        s.set_playing(false);
+        s.set_playing(true);
+        drain(&mut s, 2_000);
+        assert_eq!(s.status, PlaybackStatus::Finished);
+        assert_eq!(s.underrun_count, 0);
+    }
+
+    #[test]
+    fn load_resolves_once_per_generation() {
+        let mut load = SourceLoad::new();
+        let first = load.begin();
+        // A job restarted during the load carries a report for the same
+        // generation; only the first one to open the source publishes it.
+        assert!(load.resolve(first, LoadState::Ready, 1_500));
+        assert!(!load.resolve(first, LoadState::Ready, 1_500));
+        assert_eq!((load.state, load.duration_millis), (LoadState::Ready, 1_500));
+
+        let second = load.begin();
+        assert!(!load.resolve(first, LoadState::Failed, -1));
+        assert_eq!(load.state, LoadState::Loading);
+        assert!(load.resolve(second, LoadState::Failed, -1));
+    }
+
+    fn voice() -> SampleVoice {
+        SampleVoice::new(Arc::from(vec![0.5f32; 64]), 1.0)
+    }
+
+    #[test]
+    fn voice_pool_evicts_the_oldest_as_voices_finish() {
+        // Reference: (trigger time, samples left) in trigger order.
+        let mut model: VecDeque<(Instant, usize)> = VecDeque::new();
+        let mut s = SharedPlayback::new(2, 48_000);
+        let mut out = [0.0f32; 64];
+        let mut rng = 0x9e37_79b9u32;
+        let mut last = Instant::now();
+
+        for _ in 0..5_000 {
+            rng ^= rng << 13;
+            rng ^= rng >> 17;
+            rng ^= rng << 5;
+            if rng % 3 == 0 {
+                s.mix_voices(&mut out, |_| {});
+                model.retain_mut(|(_, left)| {
+                    *left = left.saturating_sub(out.len());
+                    *left > 0
+                });
+            } else {
+                let len = 1 + (rng >> 8) as usize % 4_000;
+                // Distinct trigger times identify voices.
+                while Instant::now() == last {}
+                let voice = SampleVoice::new(Arc::from(vec![0.0f32; len]), 1.0);
+                last = voice.triggered_at();
+                if model.len() == MAX_SAMPLE_VOICES {
+                    model.pop_front();
+                }
+                model.push_back((last, len));
+                s.trigger_voice(voice);
+            }
+            let mut live: Vec<Instant> = s.voices.iter().map(SampleVoice::triggered_at).collect();
+            live.sort();
+            assert!(live.iter().eq(model.iter().map(|(at, _)| at)));
+        }
+    }
+
+    /// `cargo test --release -- --ignored --nocapture trigger_voice_latency`
+    ///
+    /// Triggering into a full voice pool: overwrite the oldest in place
+    /// against the former `remove(0)` + `push`, and against a bare slot
+    /// overwrite as the floor.
+    #[test]
+    #[ignore]
+    fn trigger_voice_latency() {
+        const TRIGGERS: usize = 200_000;
+
+        fn shifted(s: &mut SharedPlayback, voice: SampleVoice) {
+            if s.voices.len() >= MAX_SAMPLE_VOICES {
+                s.voices.remove(0);
+            }
+            s.voices.push(voice);
+        }
+
+        let time = |trigger: fn(&mut SharedPlayback, SampleVoice)| {
+            let mut s = SharedPlayback::new(2, 48_000);
+            for _ in 0..MAX_SAMPLE_VOICES {
+                s.trigger_voice(voice());
+            }
+            // Retriggers of one cached sound share its buffer.
+            let pcm: Arc<[f32]> = Arc::from(vec![0.5f32; 64]);
+            let pending: Vec<SampleVoice> =
+                (0..TRIGGERS).map(|_| SampleVoice::new(Arc::clone(&pcm), 1.0)).collect();
+            let started = Instant::now();
+            for v in pending {
+                trigger(&mut s, v);
+            }
+            started.elapsed().as_nanos() as f64 / TRIGGERS as f64
+        };
+        fn floor(s: &mut SharedPlayback, voice: SampleVoice) {
+            s.voices[0] = voice;
+        }
+
+        let floor = time(floor);
+        let (old, new) = (time(shifted), time(SharedPlayback::trigger_voice));
+        println!(
+            "trigger into {MAX_SAMPLE_VOICES} busy voices: remove(0) {old:.1} ns, in place {new:.1} ns, \
+             bare overwrite {floor:.1} ns"
+        );
+    }
+}
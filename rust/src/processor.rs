@@ -6,6 +6,10 @@ pub struct VisualizerProcessor {
     fft: std::sync::Arc<dyn Fft<f32>>,
     fft_buffer: Vec<Complex<f32>>,
     smoothed_bars: Vec<f32>,
+    // Per-frame scratch, kept so `compute` does not allocate.
+    magnitudes: Vec<f32>,
+    raw_bars: Vec<f32>,
+    spatial: Vec<f32>,
     adaptive_level: f32,
     fast_energy: f32,
     slow_energy: f32,
@@ -19,6 +23,9 @@ impl VisualizerProcessor {
             fft,
             fft_buffer: vec![Complex::zero(); VISUALIZER_FFT_SIZE],
             smoothed_bars: vec![0.0; bar_count.max(1)],
+            magnitudes: vec![0.0; VISUALIZER_FFT_SIZE / 2],
+            raw_bars: vec![0.0; bar_count.max(1)],
+            spatial: vec![0.0; bar_count.max(1)],
             adaptive_level: 0.08,
             fast_energy: 0.0,
             slow_energy: 0.0,
@@ -36,6 +43,8 @@ impl VisualizerProcessor {
         let count = count.max(1);
         if self.smoothed_bars.len() != count {
             self.smoothed_bars = vec![0.0; count];
+            self.raw_bars = vec![0.0; count];
+            self.spatial = vec![0.0; count];
             self.adaptive_level = 0.08;
         }
     }
@@ -91,7 +100,7 @@ impl VisualizerProcessor {
         self.fft.process(&mut self.fft_buffer);
 
         let half = VISUALIZER_FFT_SIZE / 2;
-        let mut magnitudes = vec![0.0f32; half];
+        let magnitudes = &mut self.magnitudes;
         let norm = window_frames.max(1) as f32;
         for (bin, value) in self.fft_buffer.iter().take(half).enumerate() {
             magnitudes[bin] = (value.re * value.re + value.im * value.im).sqrt() / norm;
@@ -105,7 +114,7 @@ impl VisualizerProcessor {
         let min_hz = VISUALIZER_MIN_HZ;
         let max_hz = ((sample_rate as f32) * 0.46).max(min_hz + 1.0);
         let bar_count = out.len();
-        let mut raw_bars = vec![0.0f32; bar_count];
+        let raw_bars = &mut self.raw_bars;
 
         for bar in 0..bar_count {
             let t0 = bar as f32 / bar_count as f32;
@@ -134,7 +143,7 @@ impl VisualizerProcessor {
         self.adaptive_level = self.adaptive_level * 0.95 + frame_peak.max(0.0001) * 0.05;
         let level = self.adaptive_level.max(0.0001);
 
-        let mut spatial = vec![0.0f32; bar_count];
+        let spatial = &mut self.spatial;
         for index in 0..bar_count {
             let left = if index > 0 { raw_bars[index - 1] } else { raw_bars[index] };
             let center = raw_bars[index];
@@ -0,0 +1,282 @@
+/// Decode-once PCM cache for short, frequently replayed sounds.
+///
+/// UI clicks and game-style effects would otherwise pay for a full
+/// open → probe → decode → resample pass through `decode_and_feed` on every
+/// trigger.  The [`SampleBank`] instead holds each sound fully decoded at the
+/// device's rate and channel layout in a shared `Arc<[f32]>`.  Triggering a
+/// sound hands a clone of that `Arc` to a [`SampleVoice`], which the output
+/// callback mixes straight from the cached buffer — no decoding and no
+/// copies — so a trigger is heard within one callback period.
+///
+/// The bank is bounded by a byte budget; the least recently triggered sounds
+/// are evicted first.  It lives on the control thread (inside the engine);
+/// only voices cross into the callback.
+
+use std::collections::HashMap;
+use std::sync::Arc;
+use std::time::Instant;
+
+// ── SampleBank ────────────────────────────────────────────────────────────────
+
+struct BankEntry {
+    pcm:       Arc<[f32]>,
+    /// Value of [`SampleBank::tick`] at the last insert or trigger.
+    last_used: u64,
+}
+
+pub struct SampleBank {
+    entries:      HashMap<String, BankEntry>,
+    /// Evicted buffers that a voice may still be playing.  Dropped on the
+    /// control thread once the bank holds the last reference, so the audio
+    /// callback never frees a buffer.
+    retired:      Vec<Arc<[f32]>>,
+    budget_bytes: usize,
+    used_bytes:   usize,
+    tick:         u64,
+}
+
+impl SampleBank {
+    pub fn new(budget_bytes: usize) -> Self {
+        Self {
+            entries: HashMap::new(),
+            retired: Vec::new(),
+            budget_bytes,
+            used_bytes: 0,
+            tick: 0,
+        }
+    }
+
+    /// Maximum number of `f32` samples a single sound may occupy.
+    pub fn max_samples(&self) -> usize {
+        self.budget_bytes / std::mem::size_of::<f32>()
+    }
+
+    /// Bytes currently held by cached sounds (excluding retired buffers).
+    pub fn used_bytes(&self) -> usize {
+        self.used_bytes
+    }
+
+    /// Cache `pcm` under `key`, replacing any previous sound with that key
+    /// and evicting least recently used sounds until it fits.
+    pub fn insert(&mut self, key: String, pcm: Vec<f32>) -> Result<(), String> {
+        let size = pcm.len() * std::mem::size_of::<f32>();
+        if size > self.budget_bytes {
+            return Err(format!(
+                "Sample '{key}' needs {size} bytes; bank budget is {} bytes",
+                self.budget_bytes
+            ));
+        }
+
+        self.remove(&key);
+        while self.used_bytes + size > self.budget_bytes {
+            if !self.evict_lru() { break; }
+        }
+
+        self.tick += 1;
+        self.used_bytes += size;
+        self.entries.insert(key, BankEntry { pcm: pcm.into(), last_used: self.tick });
+        Ok(())
+    }
+
+    /// Look up a cached sound and mark it as recently used.
+    pub fn get(&mut self, key: &str) -> Option<Arc<[f32]>> {
+        self.purge_retired();
+        self.tick += 1;
+        let entry = self.entries.get_mut(key)?;
+        entry.last_used = self.tick;
+        Some(Arc::clone(&entry.pcm))
+    }
+
+    /// Drop the sound cached under `key`.  Returns `false` if there was none.
+    pub fn remove(&mut self, key: &str) -> bool {
+        let Some(entry) = self.entries.remove(key) else { return false };
+        self.used_bytes -= entry.pcm.len() * std::mem::size_of::<f32>();
+        self.retire(entry.pcm);
+        true
+    }
+
+    /// Drop every cached sound.  Voices already playing finish normally.
+    pub fn clear(&mut self) {
+        for (_, entry) in self.entries.drain() {
+            self.retired.push(entry.pcm);
+        }
+        self.used_bytes = 0;
+        self.purge_retired();
+    }
+
+    /// Change the byte budget, evicting sounds if the bank is now over it.
+    pub fn set_budget(&mut self, budget_bytes: usize) {
+        self.budget_bytes = budget_bytes;
+        while self.used_bytes > self.budget_bytes {
+            if !self.evict_lru() { break; }
+        }
+    }
+
+    fn evict_lru(&mut self) -> bool {
+        let Some(key) = self
+            .entries
+            .iter()
+            .min_by_key(|(_, e)| e.last_used)
+            .map(|(k, _)| k.clone())
+        else {
+            return false;
+        };
+        self.remove(&key)
+    }
+
+    fn retire(&mut self, pcm: Arc<[f32]>) {
+        if Arc::strong_count(&pcm) > 1 {
+            self.retired.push(pcm);
+        }
+        self.purge_retired();
+    }
+
+    fn purge_retired(&mut self) {
+        self.retired.retain(|pcm| Arc::strong_count(pcm) > 1);
+    }
+}
+
+// ── SampleVoice ───────────────────────────────────────────────────────────────
+
+/// One triggered playback of a cached sound, mixed by the output callback.
+pub struct SampleVoice {
+    pcm:          Arc<[f32]>,
+    pos:          usize,
+    gain:         f32,
+    triggered_at: Instant,
+    started:      bool,
+}
+
+impl SampleVoice {
+    pub fn new(pcm: Arc<[f32]>, gain: f32) -> Self {
+        Self { pcm, pos: 0, gain, triggered_at: Instant::now(), started: false }
+    }
+
+    /// When the voice was triggered.
+    #[inline]
+    pub fn triggered_at(&self) -> Instant {
+        self.triggered_at
+    }
+
+    /// Add the next `out.len()` samples into `out`.
+    ///
+    /// `on_start` receives the trigger time the first time the voice is
+    /// mixed (for latency telemetry).  Returns `true` once the voice has
+    /// played to the end.
+    #[inline]
+    pub fn mix_into<F: FnMut(Instant)>(&mut self, out: &mut [f32], on_start: &mut F) -> bool {
+        if !self.started {
+            self.started = true;
+            on_start(self.triggered_at);
+        }
+        let remaining = &self.pcm[self.pos..];
+        let count = remaining.len().min(out.len());
+        for (o, s) in out[..count].iter_mut().zip(&remaining[..count]) {
+            *o += *s * self.gain;
+        }
+        self.pos += count;
+        self.pos >= self.pcm.len()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const SOUND: usize = 10;
+    const BYTES: usize = SOUND * std::mem::size_of::<f32>();
+
+    fn bank_of(sounds: usize) -> SampleBank {
+        SampleBank::new(sounds * BYTES)
+    }
+
+    /// Cached keys, without touching their last use.
+    fn cached(bank: &SampleBank) -> Vec<&str> {
+        let mut keys: Vec<&str> = bank.entries.keys().map(String::as_str).collect();
+        keys.sort_unstable();
+        keys
+    }
+
+    #[test]
+    fn sound_over_budget_is_rejected() {
+        let mut bank = bank_of(2);
+        bank.insert("a".into(), vec![0.0; SOUND]).unwrap();
+        assert!(bank.insert("big".into(), vec![0.0; 2 * SOUND + 1]).is_err());
+        assert_eq!(cached(&bank), ["a"]);
+        assert_eq!(bank.used_bytes(), BYTES);
+
+        // Replacing a key releases the old sound's bytes.
+        bank.insert("a".into(), vec![0.0; 2 * SOUND]).unwrap();
+        assert_eq!(bank.used_bytes(), 2 * BYTES);
+    }
+
+    #[test]
+    fn least_recently_used_sound_is_evicted_first() {
+        let mut bank = bank_of(3);
+        for key in ["a", "b", "c"] {
+            bank.insert(key.into(), vec![0.0; SOUND]).unwrap();
+        }
+        bank.get("a").unwrap();
+
+        bank.insert("d".into(), vec![0.0; SOUND]).unwrap();
+        assert_eq!(cached(&bank), ["a", "c", "d"]);
+        bank.insert("e".into(), vec![0.0; 2 * SOUND]).unwrap();
+        assert_eq!(cached(&bank), ["d", "e"]);
+        assert_eq!(bank.used_bytes(), 3 * BYTES);
+    }
+
+    #[test]
+    fn shrinking_the_budget_keeps_the_most_recent_sounds() {
+        let mut bank = bank_of(4);
+        for key in ["a", "b", "c", "d"] {
+            bank.insert(key.into(), vec![0.0; SOUND]).unwrap();
+        }
+        bank.get("b").unwrap();
+
+        bank.set_budget(2 * BYTES);
+        assert_eq!(cached(&bank), ["b", "d"]);
+        assert_eq!(bank.used_bytes(), 2 * BYTES);
+        assert_eq!(bank.max_samples(), 2 * SOUND);
+        bank.set_budget(0);
+        assert!(cached(&bank).is_empty());
+        assert_eq!(bank.used_bytes(), 0);
+    }
+
+    /// An evicted sound stays alive while a voice plays it, and the bank
+    /// (not the audio callback) drops the last reference.
+    #[test]
+    fn retired_buffer_outlives_its_voice() {
+        let mut bank = bank_of(1);
+        bank.insert("a".into(), vec![0.5; SOUND]).unwrap();
+        let mut voice = SampleVoice::new(bank.get("a").unwrap(), 1.0);
+        let buffer = Arc::downgrade(&voice.pcm);
+
+        bank.insert("b".into(), vec![0.0; SOUND]).unwrap();
+        assert_eq!(cached(&bank), ["b"]);
+        assert_eq!(bank.retired.len(), 1);
+
+        let mut out = [0.0; SOUND];
+        assert!(voice.mix_into(&mut out, &mut |_| {}));
+        assert_eq!(out, [0.5; SOUND]);
+        drop(voice);
+        assert!(buffer.upgrade().is_some(), "voice dropped the last reference");
+
+        bank.get("b").unwrap();
+        assert!(bank.retired.is_empty());
+        assert!(buffer.upgrade().is_none());
+    }
+
+    /// Clearing keeps a playing buffer alive; an unused one is freed at once.
+    #[test]
+    fn clear_retires_only_buffers_in_use() {
+        let mut bank = bank_of(2);
+        bank.insert("a".into(), vec![0.0; SOUND]).unwrap();
+        bank.insert("b".into(), vec![0.0; SOUND]).unwrap();
+        let voice = SampleVoice::new(bank.get("a").unwrap(), 1.0);
+
+        bank.clear();
+        assert_eq!(bank.used_bytes(), 0);
+        assert_eq!(bank.retired.len(), 1);
+        assert!(Arc::ptr_eq(&bank.retired[0], &voice.pcm));
+    }
+}
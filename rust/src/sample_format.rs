@@ -0,0 +1,455 @@
+/// Block conversion between the engine's `f32` mix and every cpal sample
+/// format: output blocks are quantised here, and captured input is scaled
+/// back to `f32` ([`InputSample`]).
+///
+/// The callback renders a whole block of `f32` samples first and converts it
+/// in one pass afterwards, instead of converting sample by sample inside the
+/// render loop.  Each format gets its own monomorphised kernel through
+/// [`OutputSample`].  The kernels are plain Rust, not intrinsics: they are
+/// written as fixed-width lane loops with no cross-lane dependencies, no
+/// float-to-int casts and no multiplies in the noise generator, so that
+/// LLVM auto-vectorises them with the target's baseline instruction set
+/// (SSE2 on x86-64).  Nothing guarantees that; `convert_block_vs_scalar`
+/// measures the result against the old per-sample casts.
+///
+/// Integer formats round to nearest and can add TPDF dither (±1 LSB
+/// triangular noise) to decorrelate quantisation error from the signal.
+
+use cpal::SizedSample;
+
+/// Number of samples per kernel chunk (and per dither refill).
+const LANES: usize = 8;
+
+/// Adding `1.5 * 2^23` to an `f32` with `|x| < 2^22` rounds it to the
+/// nearest integer and leaves that integer in the low mantissa bits, so
+/// subtracting the magic's bit pattern yields it without a float-to-int
+/// conversion (which is saturating, and slow, in Rust).
+const ROUND_MAGIC_F32: f32 = 12_582_912.0;
+/// The same trick for `f64`, exact for `|x| < 2^51`.
+const ROUND_MAGIC_F64: f64 = 6_755_399_441_055_744.0;
+
+#[inline(always)]
+pub(crate) fn round_f32(x: f32) -> i32 {
+    (x + ROUND_MAGIC_F32).to_bits() as i32 - ROUND_MAGIC_F32.to_bits() as i32
+}
+
+#[inline(always)]
+fn round_f64(x: f64) -> i64 {
+    (x + ROUND_MAGIC_F64).to_bits() as i64 - ROUND_MAGIC_F64.to_bits() as i64
+}
+
+// ── Dither ────────────────────────────────────────────────────────────────────
+
+/// Per-stream TPDF dither generator.
+///
+/// Uses one xorshift32 generator per lane so that a whole chunk of noise is
+/// produced without serial dependencies between lanes, using only shifts
+/// and xors (SSE2 has no packed 32-bit multiply).
+pub struct Dither {
+    enabled: bool,
+    state:   [u32; LANES],
+}
+
+impl Dither {
+    pub fn new(enabled: bool) -> Self {
+        Self {
+            enabled,
+            state: std::array::from_fn(|i| 0x9E37_79B9u32.wrapping_mul(i as u32 + 1)),
+        }
+    }
+
+    pub fn set_enabled(&mut self, enabled: bool) {
+        self.enabled = enabled;
+    }
+
+    /// Quantise a block through [`run_lanes`] with TPDF noise, or with none
+    /// when disabled.  The generator state is copied into a local for the
+    /// block so it stays in registers.
+    #[inline(always)]
+    fn run<T, Q>(&mut self, src: &[f32], dst: &mut [T], quantize: Q)
+    where
+        Q: Fn(f32, f32) -> T,
+    {
+        if !self.enabled {
+            return run_lanes(src, dst, quantize, || [0.0; LANES]);
+        }
+        let mut state = self.state;
+        run_lanes(src, dst, quantize, || tpdf(&mut state));
+        self.state = state;
+    }
+}
+
+#[inline(always)]
+fn uniform(state: &mut [u32; LANES]) -> [f32; LANES] {
+    let mut out = [0.0f32; LANES];
+    for (s, o) in state.iter_mut().zip(out.iter_mut()) {
+        *s ^= *s << 13;
+        *s ^= *s >> 17;
+        *s ^= *s << 5;
+        // Signed conversion: x86 has no packed unsigned-to-float.
+        *o = (*s >> 9) as i32 as f32 * (1.0 / 8_388_608.0);
+    }
+    out
+}
+
+/// Triangular noise in `(-1, 1)` LSB.
+#[inline(always)]
+fn tpdf(state: &mut [u32; LANES]) -> [f32; LANES] {
+    let a = uniform(state);
+    let b = uniform(state);
+    std::array::from_fn(|i| a[i] - b[i])
+}
+
+// ── OutputSample ──────────────────────────────────────────────────────────────
+
+/// A cpal sample type the engine can write to.
+pub trait OutputSample: SizedSample + Send + 'static {
+    /// Convert a rendered `f32` block (`-1.0..=1.0`) into `dst`.
+    /// `src.len()` must equal `dst.len()`.
+    fn convert_block(src: &[f32], dst: &mut [Self], dither: &mut Dither);
+
+    /// Render one callback block into `data`.
+    ///
+    /// `render` fills an `f32` buffer with the samples starting at the given
+    /// offset into `data`.  Non-`f32` formats render into `scratch` and
+    /// convert the result; a device buffer longer than `scratch` is rendered
+    /// in `scratch`-sized chunks, so nothing is allocated here.  `scratch`
+    /// must hold a whole number of frames.
+    #[inline]
+    fn write_block<F>(data: &mut [Self], scratch: &mut [f32], dither: &mut Dither, mut render: F)
+    where
+        F: FnMut(&mut [f32], usize),
+    {
+        let mut offset = 0;
+        for chunk in data.chunks_mut(scratch.len().max(1)) {
+            let block = &mut scratch[..chunk.len()];
+            render(block, offset);
+            Self::convert_block(block, chunk, dither);
+            offset += chunk.len();
+        }
+    }
+}
+
+// ── Kernels ───────────────────────────────────────────────────────────────────
+
+/// Quantise to a signed integer range of at most 16 bits using `f32` math.
+///
+/// The kernels are kept out of line: inlined into the render closure, LLVM
+/// stops vectorising the dither generator and the kernel gets ~3x slower.
+#[inline(never)]
+fn quantize_narrow<T, C>(src: &[f32], dst: &mut [T], scale: f32, dither: &mut Dither, cast: C)
+where
+    C: Fn(i32) -> T,
+{
+    let lo = -scale - 1.0;
+    let hi = scale;
+    let quantize = |x: f32, noise: f32| cast(round_f32((x * scale + noise).max(lo).min(hi)));
+    dither.run(src, dst, quantize);
+}
+
+/// Quantise to a signed integer range of up to 32 bits using `f64` math.
+#[inline(never)]
+fn quantize_wide<T, C>(src: &[f32], dst: &mut [T], scale: f64, dither: &mut Dither, cast: C)
+where
+    C: Fn(i64) -> T,
+{
+    let lo = -scale - 1.0;
+    let hi = scale;
+    let quantize = |x: f32, noise: f32| cast(round_f64((x as f64 * scale + noise as f64).max(lo).min(hi)));
+    dither.run(src, dst, quantize);
+}
+
+/// Apply `quantize(sample, noise)` to every sample, a lane chunk at a time.
+#[inline(always)]
+fn run_lanes<T, Q, N>(src: &[f32], dst: &mut [T], quantize: Q, mut noise: N)
+where
+    Q: Fn(f32, f32) -> T,
+    N: FnMut() -> [f32; LANES],
+{
+    let mut src_chunks = src.chunks_exact(LANES);
+    let mut dst_chunks = dst.chunks_exact_mut(LANES);
+    for (s, d) in (&mut src_chunks).zip(&mut dst_chunks) {
+        let noise = noise();
+        for i in 0..LANES {
+            d[i] = quantize(s[i], noise[i]);
+        }
+    }
+    let noise = noise();
+    for (i, (s, d)) in src_chunks
+        .remainder()
+        .iter()
+        .zip(dst_chunks.into_remainder())
+        .enumerate()
+    {
+        *d = quantize(*s, noise[i]);
+    }
+}
+
+/// Scale to a 64-bit range.  `f32` carries 24 bits of precision, so no
+/// rounding or dither is meaningful here; `as` saturates at the bounds.
+#[inline(always)]
+fn scale_i64(src: &[f32], dst: &mut [i64]) {
+    for (s, d) in src.iter().zip(dst.iter_mut()) {
+        *d = (s.max(-1.0).min(1.0) as f64 * i64::MAX as f64) as i64;
+    }
+}
+
+// ── Implementations ───────────────────────────────────────────────────────────
+
+impl OutputSample for f32 {
+    #[inline]
+    fn convert_block(src: &[f32], dst: &mut [f32], _dither: &mut Dither) {
+        dst.copy_from_slice(src);
+    }
+
+    /// `f32` output renders straight into the device buffer.
+    #[inline]
+    fn write_block<F>(data: &mut [f32], _scratch: &mut [f32], _dither: &mut Dither, mut render: F)
+    where
+        F: FnMut(&mut [f32], usize),
+    {
+        render(data, 0);
+    }
+}
+
+impl OutputSample for f64 {
+    #[inline]
+    fn convert_block(src: &[f32], dst: &mut [f64], _dither: &mut Dither) {
+        for (s, d) in src.iter().zip(dst.iter_mut()) {
+            *d = *s as f64;
+        }
+    }
+}
+
+impl OutputSample for i8 {
+    #[inline]
+    fn convert_block(src: &[f32], dst: &mut [i8], dither: &mut Dither) {
+        quantize_narrow(src, dst, i8::MAX as f32, dither, |v| v as i8);
+    }
+}
+
+impl OutputSample for u8 {
+    #[inline]
+    fn convert_block(src: &[f32], dst: &mut [u8], dither: &mut Dither) {
+        quantize_narrow(src, dst, i8::MAX as f32, dither, |v| (v as i8 as u8) ^ 0x80);
+    }
+}
+
+impl OutputSample for i16 {
+    #[inline]
+    fn convert_block(src: &[f32], dst: &mut [i16], dither: &mut Dither) {
+        quantize_narrow(src, dst, i16::MAX as f32, dither, |v| v as i16);
+    }
+}
+
+impl OutputSample for u16 {
+    #[inline]
+    fn convert_block(src: &[f32], dst: &mut [u16], dither: &mut Dither) {
+        quantize_narrow(src, dst, i16::MAX as f32, dither, |v| (v as i16 as u16) ^ 0x8000);
+    }
+}
+
+impl OutputSample for cpal::I24 {
+    #[inline]
+    fn convert_block(src: &[f32], dst: &mut [cpal::I24], dither: &mut Dither) {
+        quantize_wide(src, dst, 8_388_607.0, dither, |v| cpal::I24::new_unchecked(v as i32));
+    }
+}
+
+impl OutputSample for i32 {
+    /// 32-bit output exceeds `f32`'s 24-bit mantissa, so dither would be
+    /// lost in rounding; it is skipped.
+    #[inline]
+    fn convert_block(src: &[f32], dst: &mut [i32], _dither: &mut Dither) {
+        quantize_wide(src, dst, i32::MAX as f64, &mut Dither::new(false), |v| v as i32);
+    }
+}
+
+impl OutputSample for u32 {
+    #[inline]
+    fn convert_block(src: &[f32], dst: &mut [u32], _dither: &mut Dither) {
+        quantize_wide(src, dst, i32::MAX as f64, &mut Dither::new(false), |v| {
+            (v as i32 as u32) ^ 0x8000_0000
+        });
+    }
+}
+
+impl OutputSample for i64 {
+    #[inline]
+    fn convert_block(src: &[f32], dst: &mut [i64], _dither: &mut Dither) {
+        scale_i64(src, dst);
+    }
+}
+
+impl OutputSample for u64 {
+    #[inline]
+    fn convert_block(src: &[f32], dst: &mut [u64], _dither: &mut Dither) {
+        for (s, d) in src.iter().zip(dst.iter_mut()) {
+            let v = (s.max(-1.0).min(1.0) as f64 * i64::MAX as f64) as i64;
+            *d = (v as u64) ^ (1 << 63);
+        }
+    }
+}
+
+// ── InputSample ───────────────────────────────────────────────────────────────
+
+/// A cpal sample type the capture engine can read from.
+pub trait InputSample: SizedSample + Send + 'static {
+    /// This sample scaled to `-1.0..=1.0`.
+    fn to_f32(self) -> f32;
+}
+
+impl InputSample for f32 {
+    #[inline(always)]
+    fn to_f32(self) -> f32 { self }
+}
+
+impl InputSample for f64 {
+    #[inline(always)]
+    fn to_f32(self) -> f32 { self as f32 }
+}
+
+impl InputSample for i8 {
+    #[inline(always)]
+    fn to_f32(self) -> f32 { self as f32 * (1.0 / 128.0) }
+}
+
+impl InputSample for u8 {
+    #[inline(always)]
+    fn to_f32(self) -> f32 { (self ^ 0x80) as i8 as f32 * (1.0 / 128.0) }
+}
+
+impl InputSample for i16 {
+    #[inline(always)]
+    fn to_f32(self) -> f32 { self as f32 * (1.0 / 32_768.0) }
+}
+
+impl InputSample for u16 {
+    #[inline(always)]
+    fn to_f32(self) -> f32 { (self ^ 0x8000) as i16 as f32 * (1.0 / 32_768.0) }
+}
+
+impl InputSample for cpal::I24 {
+    #[inline(always)]
+    fn to_f32(self) -> f32 { self.inner() as f32 * (1.0 / 8_388_608.0) }
+}
+
+impl InputSample for i32 {
+    #[inline(always)]
+    fn to_f32(self) -> f32 { (self as f64 * (1.0 / 2_147_483_648.0)) as f32 }
+}
+
+impl InputSample for u32 {
+    #[inline(always)]
+    fn to_f32(self) -> f32 { ((self ^ 0x8000_0000) as i32).to_f32() }
+}
+
+impl InputSample for i64 {
+    #[inline(always)]
+    fn to_f32(self) -> f32 { (self as f64 / i64::MAX as f64) as f32 }
+}
+
+impl InputSample for u64 {
+    #[inline(always)]
+    fn to_f32(self) -> f32 { ((self ^ (1 << 63)) as i64).to_f32() }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::time::Instant;
+
+    #[test]
+    fn long_device_buffers_render_in_scratch_chunks() {
+        let mut scratch = [0.0f32; 12];
+        let mut data    = [0i16; 50];
+        let mut offsets = Vec::new();
+        i16::write_block(&mut data, &mut scratch, &mut Dither::new(false), |block, offset| {
+            offsets.push(offset);
+            for (i, s) in block.iter_mut().enumerate() {
+                *s = (offset + i) as f32 / 32_767.0;
+            }
+        });
+        assert_eq!(offsets, [0, 12, 24, 36, 48]);
+        assert!(data.iter().enumerate().all(|(i, &v)| v == i as i16));
+    }
+
+    #[test]
+    fn integer_formats_round_and_clamp() {
+        let src = [-2.0, -1.0, -0.5, 0.0, 0.25, 1.0, 2.0];
+        let mut out = [0i16; 7];
+        i16::convert_block(&src, &mut out, &mut Dither::new(false));
+        assert_eq!(out, [-32_768, -32_767, -16_384, 0, 8_192, 32_767, 32_767]);
+
+        let mut out = [0u8; 7];
+        u8::convert_block(&src, &mut out, &mut Dither::new(false));
+        assert_eq!(out, [0, 1, 64, 128, 160, 255, 255]);
+    }
+
+    #[test]
+    fn dither_stays_within_one_lsb() {
+        let src: Vec<f32> = (0..4_096).map(|i| (i as f32 * 0.01).sin() * 0.9).collect();
+        let mut out = vec![0i16; src.len()];
+        i16::convert_block(&src, &mut out, &mut Dither::new(true));
+        let mut sum = 0.0;
+        for (&x, &y) in src.iter().zip(&out) {
+            let error = y as f32 - x * 32_767.0;
+            assert!(error.abs() <= 1.5, "{x} -> {y}");
+            sum += error;
+        }
+        assert!((sum / src.len() as f32).abs() < 0.05);
+    }
+
+    /// `cargo test --release -- --ignored --nocapture convert_block_vs_scalar`
+    #[test]
+    #[ignore]
+    fn convert_block_vs_scalar() {
+        const FRAMES: usize = 512;
+        const BLOCKS: usize = 20_000;
+        let src: Vec<f32> = (0..FRAMES * 2).map(|i| (i as f32 * 0.003).sin() * 0.8).collect();
+
+        /// Best of several runs, in ns per frame.
+        fn time(mut f: impl FnMut()) -> f64 {
+            (0..5)
+                .map(|_| {
+                    let started = Instant::now();
+                    for _ in 0..BLOCKS {
+                        f();
+                    }
+                    started.elapsed().as_nanos() as f64 / (BLOCKS * FRAMES) as f64
+                })
+                .fold(f64::INFINITY, f64::min)
+        }
+
+        /// One row: the per-sample cast the pre-block writers used (and its
+        /// obvious extension to the formats they lacked) against
+        /// `convert_block`, with and without dither where it applies.
+        fn row<T: OutputSample + Copy>(name: &str, src: &[f32], scalar: fn(f32) -> T, dithered: bool) {
+            let mut out = vec![scalar(0.0); src.len()];
+            let old = time(|| {
+                for (d, s) in out.iter_mut().zip(std::hint::black_box(src)) {
+                    *d = scalar(*s);
+                }
+            });
+            let mut noise = Dither::new(false);
+            let block = time(|| T::convert_block(std::hint::black_box(src), &mut out, &mut noise));
+            let mut noise = Dither::new(true);
+            let dither = dithered.then(|| time(|| T::convert_block(std::hint::black_box(src), &mut out, &mut noise)));
+            std::hint::black_box(&out);
+            let dither = dither.map_or("-".to_string(), |ns| format!("{ns:.2}"));
+            println!("{name:<15} {old:>8.2} {block:>7.2} {dither:>13}");
+        }
+
+        println!("stereo ns/frame   scalar   block   block+dither");
+        row("u8", &src, |s| ((s * 0.5 + 0.5) * u8::MAX as f32) as u8, true);
+        row("i8", &src, |s| (s * i8::MAX as f32) as i8, true);
+        row("u16", &src, |s| ((s * 0.5 + 0.5) * u16::MAX as f32) as u16, true);
+        row("i16", &src, |s| (s * i16::MAX as f32) as i16, true);
+        row("i24", &src, |s| cpal::I24::new_unchecked((s * 8_388_607.0) as i32), true);
+        row("u32", &src, |s| ((s as f64 * 0.5 + 0.5) * u32::MAX as f64) as u32, false);
+        row("i32", &src, |s| (s as f64 * i32::MAX as f64) as i32, false);
+        row("i64", &src, |s| (s as f64 * i64::MAX as f64) as i64, false);
+        row("u64", &src, |s| ((s as f64 * 0.5 + 0.5) * u64::MAX as f64) as u64, false);
+        row("f64", &src, |s| s as f64, false);
+    }
+}
@@ -0,0 +1,316 @@
+/// Storage for the decoded sample queue in a selectable sample format.
+///
+/// The queue holds output-rate interleaved audio, so at the maximum queue
+/// length (`MAX_MAX_QUEUE_SECONDS`) a 48 kHz stereo player buffers ~46 MB of
+/// `f32`.  [`SampleQueue`] can instead store 16-bit samples and expand them
+/// back to `f32` as the callback pops them, halving that footprint:
+///
+/// | Mode  | Bytes/sample | Precision                    | Headroom above 0 dBFS |
+/// |-------|--------------|------------------------------|-----------------------|
+/// | `F32` | 4            | 24-bit mantissa              | yes                   |
+/// | `I16` | 2            | 16-bit fixed (~96 dB SNR)    | no — clipped          |
+/// | `F16` | 2            | 11-bit mantissa (~66 dB rel.)| yes                   |
+///
+/// The per-sample cost is one conversion on push (decode thread) and one on
+/// pop (callback): a multiply for `I16`, a few integer ops for `F16`.
+
+use std::collections::VecDeque;
+
+use crate::sample_format::round_f32;
+
+/// Sample format used by [`SampleQueue`].
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum QueueStorage {
+    F32,
+    I16,
+    F16,
+}
+
+impl QueueStorage {
+    pub fn bytes_per_sample(self) -> usize {
+        match self {
+            QueueStorage::F32 => 4,
+            QueueStorage::I16 | QueueStorage::F16 => 2,
+        }
+    }
+}
+
+// ── Conversions ───────────────────────────────────────────────────────────────
+
+/// `max`/`min` rather than `clamp` so NaN lands in range; `round_f32`
+/// avoids the libm `roundf` call.
+#[inline(always)]
+fn f32_to_i16(x: f32) -> i16 {
+    round_f32(x.max(-1.0).min(1.0) * i16::MAX as f32) as i16
+}
+
+#[inline(always)]
+fn i16_to_f32(x: i16) -> f32 {
+    x as f32 * (1.0 / i16::MAX as f32)
+}
+
+/// IEEE 754 binary16 encoding of `x`, rounding to nearest even.
+#[inline]
+fn f32_to_f16(x: f32) -> u16 {
+    let bits = x.to_bits();
+    let sign = ((bits >> 16) & 0x8000) as u16;
+    let exp  = ((bits >> 23) & 0xff) as i32;
+    let man  = bits & 0x007f_ffff;
+
+    if exp == 0xff {
+        // Inf / NaN (keep NaN quiet).
+        return sign | 0x7c00 | if man != 0 { 0x0200 } else { 0 };
+    }
+    let e = exp - 127 + 15;
+    if e >= 0x1f {
+        return sign | 0x7c00;
+    }
+    if e <= 0 {
+        // Subnormal half (or underflow to zero).
+        if e < -10 {
+            return sign;
+        }
+        let m     = man | 0x0080_0000;
+        let shift = (14 - e) as u32;
+        let half  = 1u32 << (shift - 1);
+        return sign | ((m + half - 1 + ((m >> shift) & 1)) >> shift) as u16;
+    }
+    // A rounding carry out of the mantissa correctly bumps the exponent.
+    let rounded = (man + 0x0fff + ((man >> 13) & 1)) >> 13;
+    sign | (((e as u32) << 10) + rounded) as u16
+}
+
+/// `f32` value of the binary16 `h`.
+#[inline]
+fn f16_to_f32(h: u16) -> f32 {
+    let sign = ((h & 0x8000) as u32) << 16;
+    let exp  = ((h >> 10) & 0x1f) as u32;
+    let man  = (h & 0x03ff) as u32;
+    match exp {
+        0 => {
+            let v = man as f32 * (1.0 / 16_777_216.0);
+            if sign != 0 { -v } else { v }
+        }
+        0x1f => f32::from_bits(sign | 0x7f80_0000 | (man << 13)),
+        _    => f32::from_bits(sign | ((exp + 112) << 23) | (man << 13)),
+    }
+}
+
+// ── SampleQueue ───────────────────────────────────────────────────────────────
+
+/// FIFO of interleaved samples, stored as `f32`, `i16` or binary16.
+pub enum SampleQueue {
+    F32(VecDeque<f32>),
+    I16(VecDeque<i16>),
+    F16(VecDeque<u16>),
+}
+
+impl SampleQueue {
+    pub fn new(storage: QueueStorage, capacity: usize) -> Self {
+        match storage {
+            QueueStorage::F32 => SampleQueue::F32(VecDeque::with_capacity(capacity)),
+            QueueStorage::I16 => SampleQueue::I16(VecDeque::with_capacity(capacity)),
+            QueueStorage::F16 => SampleQueue::F16(VecDeque::with_capacity(capacity)),
+        }
+    }
+
+    pub fn storage(&self) -> QueueStorage {
+        match self {
+            SampleQueue::F32(_) => QueueStorage::F32,
+            SampleQueue::I16(_) => QueueStorage::I16,
+            SampleQueue::F16(_) => QueueStorage::F16,
+        }
+    }
+
+    pub fn len(&self) -> usize {
+        match self {
+            SampleQueue::F32(q) => q.len(),
+            SampleQueue::I16(q) => q.len(),
+            SampleQueue::F16(q) => q.len(),
+        }
+    }
+
+    pub fn is_empty(&self) -> bool { self.len() == 0 }
+
+    pub fn capacity(&self) -> usize {
+        match self {
+            SampleQueue::F32(q) => q.capacity(),
+            SampleQueue::I16(q) => q.capacity(),
+            SampleQueue::F16(q) => q.capacity(),
+        }
+    }
+
+    /// Bytes allocated for queued samples.
+    pub fn allocated_bytes(&self) -> usize {
+        self.capacity() * self.storage().bytes_per_sample()
+    }
+
+    pub fn clear(&mut self) {
+        match self {
+            SampleQueue::F32(q) => q.clear(),
+            SampleQueue::I16(q) => q.clear(),
+            SampleQueue::F16(q) => q.clear(),
+        }
+    }
+
+    /// Grow the allocation to hold at least `capacity` samples.
+    pub fn reserve_total(&mut self, capacity: usize) {
+        let additional = capacity.saturating_sub(self.len());
+        match self {
+            SampleQueue::F32(q) => q.reserve(additional),
+            SampleQueue::I16(q) => q.reserve(additional),
+            SampleQueue::F16(q) => q.reserve(additional),
+        }
+    }
+
+    /// Drop samples from the front until at most `max` remain.
+    pub fn truncate_front(&mut self, max: usize) {
+        let excess = self.len().saturating_sub(max);
+        match self {
+            SampleQueue::F32(q) => { q.drain(..excess); }
+            SampleQueue::I16(q) => { q.drain(..excess); }
+            SampleQueue::F16(q) => { q.drain(..excess); }
+        }
+    }
+
+    /// Append `samples`, converting to the storage format.
+    pub fn extend_from_slice(&mut self, samples: &[f32]) {
+        match self {
+            SampleQueue::F32(q) => q.extend(samples.iter().copied()),
+            SampleQueue::I16(q) => q.extend(samples.iter().map(|&s| f32_to_i16(s))),
+            SampleQueue::F16(q) => q.extend(samples.iter().map(|&s| f32_to_f16(s))),
+        }
+    }
+
+    /// Remove and expand the oldest sample.
+    #[inline]
+    pub fn pop_front(&mut self) -> Option<f32> {
+        match self {
+            SampleQueue::F32(q) => q.pop_front(),
+            SampleQueue::I16(q) => q.pop_front().map(i16_to_f32),
+            SampleQueue::F16(q) => q.pop_front().map(f16_to_f32),
+        }
+    }
+
+    /// Re-encode the queued samples in `storage`, keeping their order.
+    /// The new queue reserves `capacity` samples; the old allocation is
+    /// released.
+    pub fn convert(&mut self, storage: QueueStorage, capacity: usize) {
+        if self.storage() == storage {
+            return;
+        }
+        let mut next = SampleQueue::new(storage, capacity.max(self.len()));
+        while let Some(sample) = self.pop_front() {
+            next.extend_from_slice(&[sample]);
+        }
+        *self = next;
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::time::Instant;
+
+    const MODES: [QueueStorage; 3] = [QueueStorage::F32, QueueStorage::I16, QueueStorage::F16];
+
+    /// Largest round-trip error over a full-scale sweep.
+    fn max_error(storage: QueueStorage) -> f32 {
+        let input: Vec<f32> = (-4_000..=4_000).map(|n| n as f32 / 4_000.0).collect();
+        let mut queue = SampleQueue::new(storage, input.len());
+        queue.extend_from_slice(&input);
+        input.iter().map(|&x| (queue.pop_front().unwrap() - x).abs()).fold(0.0, f32::max)
+    }
+
+    #[test]
+    fn round_trip_stays_within_format_precision() {
+        assert_eq!(max_error(QueueStorage::F32), 0.0);
+        assert!(max_error(QueueStorage::I16) <= 0.5 / i16::MAX as f32 + f32::EPSILON);
+        // 11-bit mantissa: half an ulp just below 1.0 is 2^-12.
+        assert!(max_error(QueueStorage::F16) <= 1.0 / 4_096.0);
+        assert_eq!(f16_to_f32(f32_to_f16(-0.25)), -0.25);
+        assert!(f16_to_f32(f32_to_f16(f32::NAN)).is_nan());
+    }
+
+    /// Bytes of `queue`'s buffer that are resident in memory.  Asks the
+    /// kernel about those pages only, so other threads' allocations do not
+    /// skew it.
+    #[cfg(any(target_os = "linux", target_os = "android"))]
+    fn resident_bytes(queue: &SampleQueue) -> Option<usize> {
+        // Filled from empty without a pop, so the buffer starts at the
+        // first slice.
+        let start = match queue {
+            SampleQueue::F32(q) => q.as_slices().0.as_ptr() as usize,
+            SampleQueue::I16(q) => q.as_slices().0.as_ptr() as usize,
+            SampleQueue::F16(q) => q.as_slices().0.as_ptr() as usize,
+        };
+        // SAFETY: `sysconf` has no preconditions.
+        let page = unsafe { libc::sysconf(libc::_SC_PAGESIZE) } as usize;
+        let first = start & !(page - 1);
+        let pages = (start + queue.allocated_bytes() - first).div_ceil(page);
+        let mut flags = vec![0u8; pages];
+        // SAFETY: the range is page-aligned, lies within the queue's live
+        // allocation (rounded out to whole pages) and `flags` holds one
+        // byte per page.
+        let rc = unsafe { libc::mincore(first as *mut _, pages * page, flags.as_mut_ptr() as *mut _) };
+        (rc == 0).then(|| flags.iter().filter(|&&f| f & 1 != 0).count() * page)
+    }
+
+    #[cfg(not(any(target_os = "linux", target_os = "android")))]
+    fn resident_bytes(_queue: &SampleQueue) -> Option<usize> {
+        None
+    }
+
+    /// `cargo test --release -- --ignored --nocapture queue_storage_modes`
+    ///
+    /// One minute of 48 kHz stereo per storage mode: resident memory of the
+    /// full queue, the cost of pushing it in decoder-sized packets and of
+    /// popping it sample by sample, and the worst round-trip error.
+    #[test]
+    #[ignore]
+    fn queue_storage_modes() {
+        const SAMPLES: usize = 60 * 48_000 * 2;
+        const PACKET:  usize = 1_152 * 2;
+
+        let packet: Vec<f32> = (0..PACKET).map(|n| (n as f32 * 0.01).sin() * 0.8).collect();
+        let mut resident = Vec::new();
+        for storage in MODES {
+            let mut queue = SampleQueue::new(storage, SAMPLES);
+
+            let started = Instant::now();
+            while queue.len() + PACKET <= SAMPLES {
+                queue.extend_from_slice(&packet);
+            }
+            let push_ns = started.elapsed().as_nanos() as f64 / queue.len() as f64;
+            let queued = queue.len();
+
+            let grown = resident_bytes(&queue);
+            resident.push(grown);
+
+            let mut sum = 0.0f32;
+            let started = Instant::now();
+            while let Some(sample) = queue.pop_front() {
+                sum += sample;
+            }
+            let pop_ns = started.elapsed().as_nanos() as f64 / queued as f64;
+            std::hint::black_box(sum);
+
+            println!(
+                "{storage:?}: {} MiB allocated, {} resident, push {push_ns:.2} ns/sample, \
+                 pop {pop_ns:.2} ns/sample, max error {:.1e}",
+                queue.allocated_bytes() >> 20,
+                grown.map_or("n/a".to_string(), |b| format!("{} MiB", b >> 20)),
+                max_error(storage),
+            );
+        }
+
+        // The 16-bit modes must actually halve what the full queue keeps
+        // resident, not just what it reserves.
+        if let [Some(f32_bytes), Some(i16_bytes), Some(f16_bytes)] = resident[..] {
+            for half in [i16_bytes, f16_bytes] {
+                let ratio = half as f64 / f32_bytes as f64;
+                assert!((0.45..0.55).contains(&ratio), "16-bit queue kept {ratio:.2} of the f32 footprint");
+            }
+        }
+    }
+}
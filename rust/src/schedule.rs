@@ -0,0 +1,326 @@
+/// Sample-accurate scheduling against the output clock.
+///
+/// The engine's sample time is the number of output frames the callback has
+/// rendered since the engine was created; it keeps counting across stream
+/// rebuilds.  Once per block the callback publishes a [`ClockAnchor`] — the
+/// block's first frame and the host time at which that frame reaches the
+/// device — through a [`FrameClock`], so any thread can convert between
+/// sample time and the host clock ([`host_now_ns`]) without taking the
+/// playback lock.
+///
+/// A [`Schedule`] holds commands due at a frame, or at a host time that the
+/// first block after queueing converts to a frame with its fresh anchor.
+/// The callback splits each block at due frames and applies the commands
+/// between two samples; a command already in the past runs at the start of
+/// the next block and reports how many frames late it was.
+
+use std::sync::atomic::{fence, AtomicU32, AtomicU64, Ordering};
+use std::time::Instant;
+
+use once_cell::sync::Lazy;
+
+use crate::enums::{
+    MAX_SCHEDULED_COMMANDS, SCHEDULE_PAUSE, SCHEDULE_PLAY, SCHEDULE_SEEK, SCHEDULE_VOLUME,
+};
+
+// ── Host clock ────────────────────────────────────────────────────────────────
+
+/// Origin of the host clock: the first time any part of the engine read it.
+static EPOCH: Lazy<Instant> = Lazy::new(Instant::now);
+
+/// Monotonic host time in nanoseconds, shared by every engine and caller in
+/// the process.
+pub fn host_now_ns() -> u64 {
+    EPOCH.elapsed().as_nanos() as u64
+}
+
+// ── Frame clock ───────────────────────────────────────────────────────────────
+
+/// One point on the output timeline: `frame` is heard at `host_ns`.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct ClockAnchor {
+    pub frame:       u64,
+    pub host_ns:     u64,
+    pub sample_rate: u32,
+}
+
+impl ClockAnchor {
+    /// Frame heard at `host_ns`, extrapolated at the nominal rate and
+    /// rounded to the nearest frame.  Negative before the engine started.
+    pub fn frame_at(&self, host_ns: u64) -> i64 {
+        let elapsed = host_ns as i128 - self.host_ns as i128;
+        let frames  = (elapsed * self.sample_rate as i128 + 500_000_000).div_euclid(1_000_000_000);
+        (self.frame as i128 + frames) as i64
+    }
+
+    /// Host time at which `frame` is heard.
+    pub fn host_ns_at(&self, frame: i64) -> i64 {
+        let frames = frame as i128 - self.frame as i128;
+        let rate   = self.sample_rate.max(1) as i128;
+        (self.host_ns as i128 + (frames * 1_000_000_000).div_euclid(rate)) as i64
+    }
+}
+
+/// Latest [`ClockAnchor`], written by the callback and read lock-free.
+///
+/// A sequence lock: the writer makes the counter odd while it stores the
+/// fields, and readers retry until they see the same even count before and
+/// after reading.  Writes happen under the playback lock, so even two
+/// overlapping streams during a rebuild never write concurrently.
+pub struct FrameClock {
+    sequence:    AtomicU64,
+    frame:       AtomicU64,
+    host_ns:     AtomicU64,
+    sample_rate: AtomicU32,
+}
+
+impl FrameClock {
+    pub fn new() -> Self {
+        Self {
+            sequence:    AtomicU64::new(0),
+            frame:       AtomicU64::new(0),
+            host_ns:     AtomicU64::new(0),
+            sample_rate: AtomicU32::new(0),
+        }
+    }
+
+    /// Publish a new anchor.  Called from the callback; never blocks.
+    pub fn publish(&self, anchor: &ClockAnchor) {
+        self.sequence.fetch_add(1, Ordering::Relaxed);
+        fence(Ordering::Release);
+        self.frame.store(anchor.frame, Ordering::Relaxed);
+        self.host_ns.store(anchor.host_ns, Ordering::Relaxed);
+        self.sample_rate.store(anchor.sample_rate, Ordering::Relaxed);
+        self.sequence.fetch_add(1, Ordering::Release);
+    }
+
+    /// The latest anchor, or `None` before the first callback.
+    pub fn anchor(&self) -> Option<ClockAnchor> {
+        loop {
+            let before = self.sequence.load(Ordering::Acquire);
+            if before % 2 == 1 {
+                std::hint::spin_loop();
+                continue;
+            }
+            let anchor = ClockAnchor {
+                frame:       self.frame.load(Ordering::Relaxed),
+                host_ns:     self.host_ns.load(Ordering::Relaxed),
+                sample_rate: self.sample_rate.load(Ordering::Relaxed),
+            };
+            fence(Ordering::Acquire);
+            if self.sequence.load(Ordering::Relaxed) == before {
+                return (anchor.sample_rate > 0).then_some(anchor);
+            }
+        }
+    }
+}
+
+impl Default for FrameClock {
+    fn default() -> Self { Self::new() }
+}
+
+// ── Commands ──────────────────────────────────────────────────────────────────
+
+/// What a scheduled entry does when it comes due.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum ScheduledCommand {
+    Play,
+    Pause,
+    /// Jump to this source position (ms).  The target is decoded ahead into
+    /// a staged queue that replaces the live one at the due frame.
+    Seek(i32),
+    Volume(f32),
+}
+
+impl ScheduledCommand {
+    /// Map an FFI command code (`SCHEDULE_*`) and its argument.
+    pub fn from_code(code: i32, value: f64) -> Option<Self> {
+        match code {
+            SCHEDULE_PLAY   => Some(Self::Play),
+            SCHEDULE_PAUSE  => Some(Self::Pause),
+            SCHEDULE_SEEK   => value.is_finite().then(|| Self::Seek(value.max(0.0) as i32)),
+            SCHEDULE_VOLUME => value.is_finite().then(|| Self::Volume(value.clamp(0.0, 4.0) as f32)),
+            _ => None,
+        }
+    }
+
+    pub fn code(self) -> i32 {
+        match self {
+            Self::Play      => SCHEDULE_PLAY,
+            Self::Pause     => SCHEDULE_PAUSE,
+            Self::Seek(_)   => SCHEDULE_SEEK,
+            Self::Volume(_) => SCHEDULE_VOLUME,
+        }
+    }
+}
+
+/// When an entry is due.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Due {
+    /// Output frame (engine sample time).
+    Frame(u64),
+    /// Host time ([`host_now_ns`]); converted to a frame by the next block.
+    HostNs(u64),
+}
+
+#[derive(Debug, Clone, Copy)]
+pub struct Scheduled {
+    pub id:      u32,
+    pub command: ScheduledCommand,
+    pub due:     Due,
+}
+
+impl Scheduled {
+    /// Sort key once resolved: due frame, then scheduling order.
+    fn key(&self) -> (u64, u32) {
+        match self.due {
+            Due::Frame(frame) => (frame, self.id),
+            Due::HostNs(_)    => (u64::MAX, self.id),
+        }
+    }
+}
+
+// ── Schedule ──────────────────────────────────────────────────────────────────
+
+/// Pending commands, at most [`MAX_SCHEDULED_COMMANDS`].
+///
+/// Capacity is reserved up front and entries are kept in descending due
+/// order, so the callback pops the next one from the back and re-sorts in
+/// place: it never allocates.
+pub struct Schedule {
+    entries:  Vec<Scheduled>,
+    /// Entries were added since the callback last sorted.
+    unsorted: bool,
+    next_id:  u32,
+}
+
+impl Schedule {
+    pub fn new() -> Self {
+        Self {
+            entries:  Vec::with_capacity(MAX_SCHEDULED_COMMANDS),
+            unsorted: false,
+            next_id:  1,
+        }
+    }
+
+    /// Queue `command`; returns its id (> 0, fits an `i32`).
+    pub fn push(&mut self, command: ScheduledCommand, due: Due) -> Result<u32, String> {
+        if self.entries.len() >= MAX_SCHEDULED_COMMANDS {
+            return Err(format!("At most {MAX_SCHEDULED_COMMANDS} commands can be scheduled"));
+        }
+        let id = self.next_id;
+        self.next_id = if id >= i32::MAX as u32 { 1 } else { id + 1 };
+        self.entries.push(Scheduled { id, command, due });
+        self.unsorted = true;
+        Ok(id)
+    }
+
+    /// Remove entry `id`, returning its command.
+    pub fn cancel(&mut self, id: u32) -> Option<ScheduledCommand> {
+        let index = self.entries.iter().position(|e| e.id == id)?;
+        Some(self.entries.remove(index).command)
+    }
+
+    pub fn clear(&mut self) {
+        self.entries.clear();
+        self.unsorted = false;
+    }
+
+    /// Convert host-time entries to frames with `anchor` and restore the
+    /// order.  Called by the callback at the start of every block.
+    #[inline]
+    pub fn resolve(&mut self, anchor: &ClockAnchor) {
+        if !self.unsorted {
+            return;
+        }
+        for entry in &mut self.entries {
+            if let Due::HostNs(host_ns) = entry.due {
+                entry.due = Due::Frame(anchor.frame_at(host_ns).max(0) as u64);
+            }
+        }
+        self.entries.sort_unstable_by(|a, b| b.key().cmp(&a.key()));
+        self.unsorted = false;
+    }
+
+    /// Due frame of the earliest entry if it is before `end`.
+    #[inline]
+    pub fn next_before(&self, end: u64) -> Option<u64> {
+        match self.entries.last()?.due {
+            Due::Frame(frame) if frame < end => Some(frame),
+            _ => None,
+        }
+    }
+
+    /// Pop the earliest entry if it is due at or before `frame`.
+    #[inline]
+    pub fn pop_due(&mut self, frame: u64) -> Option<Scheduled> {
+        match self.entries.last()?.due {
+            Due::Frame(due) if due <= frame => self.entries.pop(),
+            _ => None,
+        }
+    }
+}
+
+impl Default for Schedule {
+    fn default() -> Self { Self::new() }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const RATE: u32 = 48_000;
+
+    fn anchor(frame: u64, host_ns: u64) -> ClockAnchor {
+        ClockAnchor { frame, host_ns, sample_rate: RATE }
+    }
+
+    #[test]
+    fn anchor_converts_both_ways() {
+        let a = anchor(96_000, 7_000_000_000);
+        for frame in [-48_000i64, 0, 1, 95_999, 96_000, 96_001, 1_000_000_007] {
+            assert_eq!(a.frame_at(a.host_ns_at(frame) as u64), frame, "frame {frame}");
+        }
+        // One frame is 20 833.3 ns; halfway rounds up.
+        assert_eq!(a.frame_at(7_000_000_000 + 10_416), 96_000);
+        assert_eq!(a.frame_at(7_000_000_000 + 10_417), 96_001);
+        assert_eq!(a.frame_at(7_000_000_000 - 10_417), 95_999);
+        assert_eq!(a.host_ns_at(96_000 + 48_000), 8_000_000_000);
+        assert_eq!(a.frame_at(0), 96_000 - 7 * 48_000);
+    }
+
+    #[test]
+    fn resolve_orders_host_and_frame_entries() {
+        let a = anchor(1_000, 1_000_000_000);
+        let mut s = Schedule::new();
+        let late  = s.push(ScheduledCommand::Play, Due::Frame(1_200)).unwrap();
+        let host  = s.push(ScheduledCommand::Pause, Due::HostNs(a.host_ns_at(1_100) as u64)).unwrap();
+        let tie   = s.push(ScheduledCommand::Volume(0.5), Due::Frame(1_100)).unwrap();
+        let early = s.push(ScheduledCommand::Seek(10), Due::HostNs(0)).unwrap();
+        s.resolve(&a);
+
+        assert_eq!(s.next_before(1_000), Some(0));
+        assert_eq!(s.pop_due(1_000).map(|e| e.id), Some(early));
+        assert_eq!(s.next_before(1_100), None);
+        assert_eq!(s.next_before(1_101), Some(1_100));
+        assert!(s.pop_due(1_099).is_none());
+        // Same frame: scheduling order.
+        assert_eq!(s.pop_due(1_100).map(|e| e.id), Some(host));
+        assert_eq!(s.pop_due(1_100).map(|e| e.id), Some(tie));
+        assert!(s.pop_due(1_100).is_none());
+        assert_eq!(s.pop_due(5_000).map(|e| e.id), Some(late));
+        assert!(s.pop_due(u64::MAX).is_none());
+    }
+
+    #[test]
+    fn capacity_is_reserved_and_bounded() {
+        let mut s = Schedule::new();
+        let capacity = s.entries.capacity();
+        for i in 0..MAX_SCHEDULED_COMMANDS {
+            s.push(ScheduledCommand::Play, Due::Frame(i as u64)).unwrap();
+        }
+        assert!(s.push(ScheduledCommand::Play, Due::Frame(0)).is_err());
+        s.resolve(&anchor(0, 0));
+        assert_eq!(s.entries.capacity(), capacity);
+    }
+}
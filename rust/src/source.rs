@@ -1,7 +1,7 @@
 /// Typed audio source.
 ///
 /// Every source variant must be convertible into a Symphonia `MediaSource`
-/// (see `engine::media_source_from_owned` / `media_source_from_ref`).  The
+/// (see `engine::media_source_from_owned`).  The
 /// enum is intentionally **small** — it carries only the *address* of the
 /// data, not the decoded samples.
 ///
@@ -16,6 +16,11 @@ pub enum AudioSource {
     /// use via [`crate::http_stream::HttpStream`].
     Url(String),
 
+    /// A live, unbounded network stream (Icecast/SHOUTcast or HLS), read
+    /// through [`crate::live_stream::LiveStream`].  Not seekable; dropped
+    /// connections are re-established automatically.
+    Live(String),
+
     /// Raw bytes already loaded into memory (e.g., loaded from an asset
     /// bundle or received over IPC).  Written to a temporary file before
     /// handing to Symphonia so that seeking works correctly.
@@ -25,7 +30,13 @@ pub enum AudioSource {
 impl AudioSource {
     /// Returns `true` if the source is a network URL.
     pub fn is_remote(&self) -> bool {
-        matches!(self, Self::Url(_))
+        matches!(self, Self::Url(_) | Self::Live(_))
+    }
+
+    /// Returns `true` for live streams, which have no duration and cannot
+    /// seek.
+    pub fn is_live(&self) -> bool {
+        matches!(self, Self::Live(_))
     }
 
     /// Returns a human-readable description, suitable for logging.
@@ -33,6 +44,7 @@ impl AudioSource {
         match self {
             Self::Path(p) => format!("file://{p}"),
             Self::Url(u) => u.clone(),
+            Self::Live(u) => format!("live {u}"),
             Self::Memory(b) => format!("<memory {} bytes>", b.len()),
         }
     }
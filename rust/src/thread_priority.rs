@@ -0,0 +1,307 @@
+/// Opt-in scheduling hints for the audio callback and decode workers.
+///
+/// Off by default: every thread runs at the priority it was created with.
+/// [`set_enabled`] bumps a generation counter; each hinted thread holds a
+/// [`PriorityHint`] and re-applies its priority the next time it calls
+/// [`PriorityHint::refresh`] after a change, so the toggle takes effect on
+/// threads that already exist (cpal's callback thread is not ours to spawn).
+///
+/// On Linux and Android an enabled callback thread asks for `SCHED_FIFO`,
+/// falling back to a negative nice value when the process lacks
+/// `RLIMIT_RTPRIO` / `CAP_SYS_NICE` (always, for an Android app).  Decode
+/// workers only get the nice value: they are CPU-bound for whole packets and
+/// must never be able to starve the rest of the system.  A thread's own
+/// policy and nice value are saved when it is first elevated and put back
+/// when hints are disabled.  Other platforms leave priorities to the host
+/// API and report [`THREAD_PRIORITY_NORMAL`].
+
+use std::sync::atomic::{AtomicBool, AtomicI32, AtomicU32, Ordering};
+
+use crate::enums::{
+    THREAD_NICE_CALLBACK, THREAD_NICE_DECODE, THREAD_PRIORITY_DENIED, THREAD_PRIORITY_ELEVATED,
+    THREAD_PRIORITY_NORMAL, THREAD_PRIORITY_REALTIME, THREAD_ROLE_CALLBACK, THREAD_ROLE_DECODE,
+    THREAD_RT_PRIORITY_CALLBACK,
+};
+
+// ── Roles ─────────────────────────────────────────────────────────────────────
+
+/// Which kind of thread a hint applies to.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum ThreadRole {
+    Callback,
+    Decode,
+}
+
+impl ThreadRole {
+    /// Map an FFI role code (`THREAD_ROLE_*`).
+    pub fn from_code(code: i32) -> Option<Self> {
+        match code {
+            THREAD_ROLE_CALLBACK => Some(Self::Callback),
+            THREAD_ROLE_DECODE   => Some(Self::Decode),
+            _ => None,
+        }
+    }
+
+    fn index(self) -> usize {
+        self as usize
+    }
+}
+
+// ── Global toggle ─────────────────────────────────────────────────────────────
+
+static ENABLED:    AtomicBool = AtomicBool::new(false);
+static GENERATION: AtomicU32  = AtomicU32::new(0);
+/// Outcome of the most recent attempt per role (`THREAD_PRIORITY_*`).
+static STATUS: [AtomicI32; 2] = [
+    AtomicI32::new(THREAD_PRIORITY_NORMAL),
+    AtomicI32::new(THREAD_PRIORITY_NORMAL),
+];
+
+/// Request elevated priorities (`true`) or return to normal ones (`false`).
+pub fn set_enabled(enabled: bool) {
+    ENABLED.store(enabled, Ordering::Relaxed);
+    GENERATION.fetch_add(1, Ordering::Release);
+}
+
+pub fn is_enabled() -> bool {
+    ENABLED.load(Ordering::Relaxed)
+}
+
+/// Priority most recently obtained by a thread of `role`.
+pub fn status(role: ThreadRole) -> i32 {
+    STATUS[role.index()].load(Ordering::Relaxed)
+}
+
+// ── Per-thread hint ───────────────────────────────────────────────────────────
+
+/// Owned by one thread; applies the global setting to that thread.
+pub struct PriorityHint {
+    role:  ThreadRole,
+    seen:  u32,
+    /// The thread's scheduling before it was elevated, while it is.
+    saved: Option<Saved>,
+}
+
+impl PriorityHint {
+    /// A thread starts at normal priority, which matches generation 0.
+    pub fn new(role: ThreadRole) -> Self {
+        Self { role, seen: 0, saved: None }
+    }
+
+    /// Apply the current setting if it changed since the last call.  One
+    /// relaxed load when nothing changed, so it is safe on the audio thread;
+    /// the system call itself only happens right after a toggle.
+    #[inline]
+    pub fn refresh(&mut self) {
+        let generation = GENERATION.load(Ordering::Acquire);
+        if generation == self.seen {
+            return;
+        }
+        self.seen = generation;
+        let result = apply(self.role, is_enabled(), &mut self.saved);
+        STATUS[self.role.index()].store(result, Ordering::Relaxed);
+    }
+}
+
+// ── Platform back-ends ────────────────────────────────────────────────────────
+
+/// Policy, static priority and nice value of a thread.
+#[cfg(any(target_os = "linux", target_os = "android"))]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+struct Saved {
+    policy:   i32,
+    priority: i32,
+    nice:     i32,
+}
+
+#[cfg(not(any(target_os = "linux", target_os = "android")))]
+type Saved = ();
+
+#[cfg(any(target_os = "linux", target_os = "android"))]
+fn apply(role: ThreadRole, elevated: bool, saved: &mut Option<Saved>) -> i32 {
+    if !elevated {
+        if let Some(original) = saved.take() {
+            set_policy(original.policy, original.priority);
+            set_nice(original.nice);
+        }
+        return THREAD_PRIORITY_NORMAL;
+    }
+    if saved.is_none() {
+        *saved = Some(current());
+    }
+    if role == ThreadRole::Callback && set_policy(libc::SCHED_FIFO, THREAD_RT_PRIORITY_CALLBACK) {
+        return THREAD_PRIORITY_REALTIME;
+    }
+    let nice = match role {
+        ThreadRole::Callback => THREAD_NICE_CALLBACK,
+        ThreadRole::Decode   => THREAD_NICE_DECODE,
+    };
+    if set_nice(nice) { THREAD_PRIORITY_ELEVATED } else { THREAD_PRIORITY_DENIED }
+}
+
+#[cfg(any(target_os = "linux", target_os = "android"))]
+fn current() -> Saved {
+    let mut policy = libc::SCHED_OTHER;
+    let mut param  = libc::sched_param { sched_priority: 0 };
+    // SAFETY: as in `set_policy`; both out-pointers outlive the call.
+    unsafe { libc::pthread_getschedparam(libc::pthread_self(), &mut policy, &mut param) };
+    Saved { policy, priority: param.sched_priority, nice: nice() }
+}
+
+#[cfg(any(target_os = "linux", target_os = "android"))]
+fn set_policy(policy: i32, priority: i32) -> bool {
+    let param = libc::sched_param { sched_priority: priority };
+    // SAFETY: `pthread_self` is always a valid handle for the calling thread
+    // and `param` outlives the call.
+    unsafe { libc::pthread_setschedparam(libc::pthread_self(), policy, &param) == 0 }
+}
+
+/// Set the nice value of the calling thread only.  On Linux each thread is
+/// its own scheduling entity, addressed by its kernel thread id.
+#[cfg(any(target_os = "linux", target_os = "android"))]
+fn set_nice(nice: i32) -> bool {
+    // SAFETY: plain system calls on the calling thread's id.
+    unsafe { libc::setpriority(libc::PRIO_PROCESS, thread_id(), nice) == 0 }
+}
+
+/// Nice value of the calling thread.  `getpriority` can only fail for a bad
+/// id, so its `-1` error value needs no disambiguating here.
+#[cfg(any(target_os = "linux", target_os = "android"))]
+fn nice() -> i32 {
+    // SAFETY: as in `set_nice`.
+    unsafe { libc::getpriority(libc::PRIO_PROCESS, thread_id()) }
+}
+
+#[cfg(any(target_os = "linux", target_os = "android"))]
+fn thread_id() -> libc::id_t {
+    // SAFETY: `gettid` has no preconditions.
+    unsafe { libc::syscall(libc::SYS_gettid) as libc::id_t }
+}
+
+#[cfg(not(any(target_os = "linux", target_os = "android")))]
+fn apply(_role: ThreadRole, _elevated: bool, _saved: &mut Option<Saved>) -> i32 {
+    THREAD_PRIORITY_NORMAL
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::Arc;
+    use std::thread;
+    use std::time::{Duration, Instant};
+
+    use crate::decode_pool::{self, PoolJob, Slice};
+    use crate::enums::DECODE_POOL_SLICE_MS;
+
+    #[cfg(any(target_os = "linux", target_os = "android"))]
+    #[test]
+    fn disabling_restores_the_threads_own_scheduling() {
+        thread::spawn(|| {
+            // Raising the nice value needs no privilege.
+            assert!(set_nice(5));
+            let before = current();
+            for role in [ThreadRole::Callback, ThreadRole::Decode] {
+                let mut saved = None;
+                assert_ne!(apply(role, true, &mut saved), THREAD_PRIORITY_NORMAL);
+                // A second toggle while elevated keeps the original.
+                apply(role, true, &mut saved);
+                assert_eq!(saved, Some(before));
+                assert_eq!(apply(role, false, &mut saved), THREAD_PRIORITY_NORMAL);
+                assert_eq!(current(), before);
+            }
+        })
+        .join()
+        .unwrap();
+    }
+
+    fn spin(duration: Duration) {
+        let until = Instant::now() + duration;
+        while Instant::now() < until {
+            std::hint::spin_loop();
+        }
+    }
+
+    /// A player whose decoder never catches up: every slice burns its full
+    /// budget.
+    struct Busy {
+        stop: Arc<AtomicBool>,
+    }
+
+    impl PoolJob for Busy {
+        fn run_slice(&mut self, _waited: Option<Duration>) -> Slice {
+            if self.stop.load(Ordering::Relaxed) {
+                return Slice::Done;
+            }
+            spin(Duration::from_millis(DECODE_POOL_SLICE_MS));
+            Slice::Progress
+        }
+
+        fn deadline(&self) -> Instant {
+            Instant::now()
+        }
+    }
+
+    /// `cargo test --release -- --ignored --nocapture underruns_under_load`
+    ///
+    /// A simulated output callback (256 frames at 48 kHz, 0.5 ms of work per
+    /// buffer) runs against 12 pooled and 4 dedicated CPU-bound players,
+    /// first with hints off, then on.  A buffer finished more than one period
+    /// after the device asked for it is an underrun.
+    #[test]
+    #[ignore]
+    fn underruns_under_load() {
+        const PERIOD: Duration = Duration::from_micros(5_333);
+        const WORK:   Duration = Duration::from_micros(500);
+        const RUN:    Duration = Duration::from_secs(3);
+
+        let stop = Arc::new(AtomicBool::new(false));
+        for _ in 0..12 {
+            decode_pool::submit(Box::new(Busy { stop: Arc::clone(&stop) }));
+        }
+        let dedicated: Vec<_> = (0..4)
+            .map(|_| {
+                let job = Busy { stop: Arc::clone(&stop) };
+                thread::spawn(move || decode_pool::run_dedicated(Box::new(job)))
+            })
+            .collect();
+
+        let measure = |enabled: bool| {
+            set_enabled(enabled);
+            thread::spawn(|| {
+                let mut hint = PriorityHint::new(ThreadRole::Callback);
+                let started = Instant::now();
+                let mut requested = started;
+                let (mut buffers, mut underruns, mut worst) = (0u32, 0u32, Duration::ZERO);
+                while requested - started < RUN {
+                    requested += PERIOD;
+                    thread::sleep(requested.saturating_duration_since(Instant::now()));
+                    hint.refresh();
+                    spin(WORK);
+                    let ready = requested.elapsed();
+                    worst = worst.max(ready);
+                    underruns += (ready > PERIOD) as u32;
+                    buffers += 1;
+                }
+                (buffers, underruns, worst, status(ThreadRole::Callback))
+            })
+            .join()
+            .unwrap()
+        };
+
+        let normal   = measure(false);
+        let elevated = measure(true);
+        set_enabled(false);
+        stop.store(true, Ordering::Relaxed);
+        for thread in dedicated {
+            thread.join().unwrap();
+        }
+
+        for (label, (buffers, underruns, worst, status)) in [("off", normal), ("on", elevated)] {
+            println!(
+                "hints {label:>3}: {underruns}/{buffers} underruns, slowest buffer {worst:?} \
+                 (callback status {status})"
+            );
+        }
+        assert!(elevated.1 <= normal.1);
+    }
+}
@@ -27,12 +27,41 @@ This file is automatically generated by build.rs; DO NOT MANUALLY EDIT!
 #define MAX_MAX_QUEUE_SECONDS 120
 
 /**
- * How long (ms) the decode thread sleeps when the queue is full, before
- * retrying.  Keeping this short keeps latency low while still yielding to
- * the scheduler.
+ * `audiopc_set_queue_storage`: queue decoded samples as `f32` (default).
+ */
+#define QUEUE_STORAGE_F32 0
+
+/**
+ * `audiopc_set_queue_storage`: queue as 16-bit integers (half the memory;
+ * peaks above full scale are clipped).
+ */
+#define QUEUE_STORAGE_I16 1
+
+/**
+ * `audiopc_set_queue_storage`: queue as IEEE half floats (half the memory;
+ * keeps headroom at ~11-bit precision).
+ */
+#define QUEUE_STORAGE_F16 2
+
+/**
+ * How long (ms) a decoder whose queue is full waits before retrying.
+ * Keeping this short keeps latency low while still yielding to the
+ * scheduler.
  */
 #define DECODE_BACKPRESSURE_SLEEP_MS 2
 
+/**
+ * Upper bound on the worker threads of the shared decode pool.  The pool
+ * uses one fewer than the available cores, clamped to `1..=` this.
+ */
+#define DECODE_POOL_MAX_THREADS 4
+
+/**
+ * Longest (ms) a pool worker keeps decoding one source before returning to
+ * the scheduler, so the source closest to running dry is served next.
+ */
+#define DECODE_POOL_SLICE_MS 4
+
 /**
  * Number of seconds of audio kept in the visualizer ring buffer.
  */
@@ -69,6 +98,470 @@ This file is automatically generated by build.rs; DO NOT MANUALLY EDIT!
  */
 #define DEVICE_POLL_INTERVAL_MS 2000
 
+/**
+ * Number of buckets in each log-linear metrics histogram.  Covers values up
+ * to ~2^33 (µs) with ~12 % relative precision.
+ */
+#define METRICS_HISTOGRAM_BUCKETS 256
+
+/**
+ * Number of recent callbacks kept for trace export.
+ */
+#define METRICS_TRACE_CAPACITY 4096
+
+/**
+ * How long (ms) a filter takes to glide from its previous coefficients to
+ * new ones after a parameter change.
+ */
+#define FILTER_GLIDE_MILLIS 30
+
+/**
+ * How long (ms) the callback crossfades from a replaced filter chain or
+ * convolver to its replacement, and how long a wet/dry mix change takes.
+ */
+#define CHAIN_CROSSFADE_MILLIS 30
+
+/**
+ * Number of replaced effect chains the audio callback can hand back for
+ * reclamation before it defers picking up further updates.
+ */
+#define CHAIN_RETIRE_SLOTS 4
+
+/**
+ * Samples preallocated for the `f32` render buffer of non-`f32` output
+ * streams.  Covers an 8-channel, 2048-frame device buffer in one pass;
+ * larger device buffers are rendered in chunks of this size.
+ */
+#define OUTPUT_SCRATCH_SAMPLES 16384
+
+/**
+ * `audiopc_source_load_state`: no source set.
+ */
+#define SOURCE_LOAD_IDLE 0
+
+/**
+ * `audiopc_source_load_state`: the source is being opened and probed.
+ */
+#define SOURCE_LOAD_LOADING 1
+
+/**
+ * `audiopc_source_load_state`: the source is ready; duration is final.
+ */
+#define SOURCE_LOAD_READY 2
+
+/**
+ * `audiopc_source_load_state`: opening or probing the source failed.
+ */
+#define SOURCE_LOAD_FAILED 3
+
+/**
+ * Default memory budget (bytes) for decoded sounds in the sample bank.
+ */
+#define DEFAULT_SAMPLE_BANK_BUDGET_BYTES 67108864
+
+/**
+ * Maximum number of cached sounds that can play at the same time.
+ */
+#define MAX_SAMPLE_VOICES 32
+
+/**
+ * Partition size (frames) of the FFT convolver.  Also its latency.
+ */
+#define CONVOLVER_BLOCK_FRAMES 512
+
+/**
+ * Longest impulse response (seconds) accepted by the convolver.
+ */
+#define CONVOLVER_MAX_IR_SECONDS 10
+
+/**
+ * Capacity (bytes) of the jitter buffer between a live stream's network
+ * thread and the decoder.
+ */
+#define LIVE_JITTER_BUFFER_BYTES 4194304
+
+/**
+ * Bytes a live stream buffers before playback starts, and again after an
+ * underrun.
+ */
+#define LIVE_PREBUFFER_BYTES 65536
+
+/**
+ * Size (bytes) of each network read on a live stream.
+ */
+#define LIVE_READ_CHUNK_BYTES 16384
+
+/**
+ * Connect timeout and longest stall (ms) before a live connection is
+ * considered dropped.
+ */
+#define LIVE_HTTP_TIMEOUT_MS 10000
+
+/**
+ * Delay (ms) before the first reconnect attempt; doubles per attempt.
+ */
+#define LIVE_RECONNECT_BASE_MS 500
+
+/**
+ * Longest delay (ms) between reconnect attempts.
+ */
+#define LIVE_RECONNECT_MAX_MS 10000
+
+/**
+ * Consecutive failed reconnect attempts before a live stream gives up.
+ */
+#define LIVE_MAX_RECONNECT_ATTEMPTS 8
+
+/**
+ * Number of HLS segments downloaded in parallel.
+ */
+#define LIVE_HLS_PREFETCH_SEGMENTS 3
+
+/**
+ * How many segments behind the live edge an HLS live playlist starts.
+ */
+#define LIVE_HLS_LIVE_EDGE_SEGMENTS 3
+
+/**
+ * Times a static HTTP source re-requests from its current offset after a
+ * failed read before giving up.
+ */
+#define HTTP_READ_RETRIES 3
+
+/**
+ * Delay (ms) before the first re-request of a static HTTP source; grows by
+ * the same amount per attempt.
+ */
+#define HTTP_RETRY_BASE_MS 250
+
+/**
+ * Discrete events the event bus holds before new ones are dropped.
+ * Position, buffering, underrun and queue-length updates are coalesced and
+ * do not count against it.
+ */
+#define EVENT_QUEUE_CAPACITY 256
+
+/**
+ * Slots of EVENT_QUEUE_CAPACITY kept for events that must not be lost.
+ * Kinds superseded by the next event of their kind (analysis progress,
+ * decoder warnings, stream metadata, reconnect attempts) are dropped once
+ * only these are free.
+ */
+#define EVENT_QUEUE_RESERVED 64
+
+/**
+ * Longest a blocked event consumer sleeps before re-checking the bus for
+ * events published without a wake-up (from the audio callback).
+ */
+#define EVENT_WAIT_SLICE_MS 10
+
+/**
+ * Interval (ms of played audio) between position events.
+ */
+#define EVENT_POSITION_INTERVAL_MS 100
+
+/**
+ * Buffer size (bytes) `audiopc_wait_event` callers should provide.
+ */
+#define EVENT_JSON_MAX_BYTES 8192
+
+/**
+ * Event `kind`: playback started.
+ */
+#define EVENT_PLAYBACK_STARTED 1
+
+/**
+ * Event `kind`: playback paused at `position_ms`.
+ */
+#define EVENT_PLAYBACK_PAUSED 2
+
+/**
+ * Event `kind`: playback resumed at `position_ms`.
+ */
+#define EVENT_PLAYBACK_RESUMED 3
+
+/**
+ * Event `kind`: the source played to its end.
+ */
+#define EVENT_PLAYBACK_FINISHED 4
+
+/**
+ * Event `kind`: playback was stopped by the caller.
+ */
+#define EVENT_PLAYBACK_STOPPED 5
+
+/**
+ * Event `kind`: a new track became active (`title`, `artist`, …).
+ */
+#define EVENT_TRACK_CHANGED 6
+
+/**
+ * Event `kind`: the source finished loading (`duration_ms`,
+ * `sample_rate`, `channels`).
+ */
+#define EVENT_SOURCE_LOADED 7
+
+/**
+ * Event `kind`: the playback queue is exhausted.
+ */
+#define EVENT_QUEUE_EXHAUSTED 8
+
+/**
+ * Event `kind`: the queue length changed (`len`).  Coalesced.
+ */
+#define EVENT_QUEUE_UPDATED 9
+
+/**
+ * Event `kind`: an error occurred (`message`).
+ */
+#define EVENT_ERROR 10
+
+/**
+ * Event `kind`: the output ran dry (`count`, cumulative).  Coalesced.
+ */
+#define EVENT_UNDERRUN 11
+
+/**
+ * Event `kind`: the decoder reported a warning (`message`).
+ */
+#define EVENT_DECODER_WARNING 12
+
+/**
+ * Event `kind`: a stream is buffering (`percent`).  Coalesced.
+ */
+#define EVENT_BUFFERING 13
+
+/**
+ * Event `kind`: buffering finished.
+ */
+#define EVENT_BUFFERING_COMPLETE 14
+
+/**
+ * Event `kind`: a live stream is reconnecting (`attempt`).
+ */
+#define EVENT_RECONNECTING 15
+
+/**
+ * Event `kind`: live stream metadata arrived (`tags`).
+ */
+#define EVENT_STREAM_METADATA 16
+
+/**
+ * Event `kind`: an output device appeared (`name`, `is_default`).
+ */
+#define EVENT_DEVICE_ADDED 17
+
+/**
+ * Event `kind`: an output device disappeared (`name`, `is_default`).
+ */
+#define EVENT_DEVICE_REMOVED 18
+
+/**
+ * Event `kind`: the default output device changed (`name`, `is_default`).
+ */
+#define EVENT_DEFAULT_DEVICE_CHANGED 19
+
+/**
+ * Event `kind`: playback position (`current_ms`, `total_ms`).  Coalesced.
+ */
+#define EVENT_POSITION 20
+
+/**
+ * Event `kind`: a batch analysis made progress on a track (`job`, `path`,
+ * `percent`, `bpm` estimated so far).
+ */
+#define EVENT_ANALYSIS_PROGRESS 21
+
+/**
+ * Event `kind`: a track of a batch analysis finished (`job`, `path`, and
+ * `analysis` or `message`).  `analysis` is a summary (`bpm`, `confidence`,
+ * `duration_ms`, `beat_count`, `onset_count`); `audiopc_analyze_track`
+ * returns the beats and onsets from the cache.
+ */
+#define EVENT_ANALYSIS_RESULT 22
+
+/**
+ * Event `kind`: every track of a batch analysis is done (`job`).
+ */
+#define EVENT_ANALYSIS_FINISHED 23
+
+/**
+ * Event `kind`: a scheduled command ran (`id`, `command`, `frame` it ran
+ * at, `late_frames` after its due frame).
+ */
+#define EVENT_SCHEDULE_FIRED 24
+
+/**
+ * `audiopc_start_capture`: record 16-bit PCM WAV.
+ */
+#define CAPTURE_FORMAT_WAV_PCM16 0
+
+/**
+ * `audiopc_start_capture`: record 32-bit float WAV (keeps input headroom).
+ */
+#define CAPTURE_FORMAT_WAV_F32 1
+
+/**
+ * Seconds of input the record ring holds while the writer thread catches
+ * up.  Frames arriving when it is full are dropped and counted.
+ */
+#define CAPTURE_RING_SECONDS 4
+
+/**
+ * Frames the writer thread waits for before each file write, so the disk
+ * sees few large sequential writes.
+ */
+#define CAPTURE_WRITE_BATCH_FRAMES 8192
+
+/**
+ * How long (ms) the writer thread sleeps when less than a batch is queued.
+ */
+#define CAPTURE_WRITER_IDLE_MS 20
+
+/**
+ * Most monitored input (ms) allowed to queue ahead of the output; older
+ * input is skipped so monitoring latency stays bounded.
+ */
+#define CAPTURE_MONITOR_MAX_LATENCY_MS 20
+
+/**
+ * Mono sample rate tracks are decoded to for beat and onset analysis.
+ */
+#define ANALYSIS_SAMPLE_RATE 22050
+
+/**
+ * FFT size of the onset (spectral flux) analysis.  Must be a power of two.
+ */
+#define ANALYSIS_FFT_SIZE 1024
+
+/**
+ * Hop (samples) between analysis frames; ~23 ms at the analysis rate.
+ */
+#define ANALYSIS_HOP_SIZE 512
+
+/**
+ * Gain applied to STFT magnitudes before log compression (`ln(1 + g|X|)`).
+ */
+#define ANALYSIS_LOG_COMPRESSION 100.0
+
+/**
+ * Slowest tempo (BPM) the tempo estimator considers.
+ */
+#define ANALYSIS_MIN_BPM 60.0
+
+/**
+ * Fastest tempo (BPM) the tempo estimator considers.
+ */
+#define ANALYSIS_MAX_BPM 200.0
+
+/**
+ * Tempo the estimator prefers between octave-related candidates.
+ */
+#define ANALYSIS_PREFERRED_BPM 120.0
+
+/**
+ * Onset threshold above the local mean of the onset function, in
+ * standard deviations of the whole function.
+ */
+#define ANALYSIS_ONSET_THRESHOLD 1.0
+
+/**
+ * An onset must be the largest value within this many frames either side.
+ */
+#define ANALYSIS_ONSET_PEAK_FRAMES 3
+
+/**
+ * Frames either side averaged for the onset threshold's local mean.
+ */
+#define ANALYSIS_ONSET_MEAN_FRAMES 16
+
+/**
+ * Seconds of decoded audio between progress events of a batch analysis.
+ */
+#define ANALYSIS_PROGRESS_SECONDS 30
+
+/**
+ * Analysed tracks kept in the result cache.  The oldest are evicted first.
+ */
+#define ANALYSIS_CACHE_ENTRIES 512
+
+/**
+ * Buffer size (bytes) `audiopc_analyze_track` callers should provide.
+ */
+#define ANALYSIS_JSON_MAX_BYTES 1048576
+
+/**
+ * `audiopc_thread_priority` role: the output callback thread.
+ */
+#define THREAD_ROLE_CALLBACK 0
+
+/**
+ * `audiopc_thread_priority` role: the decode workers.
+ */
+#define THREAD_ROLE_DECODE 1
+
+/**
+ * `audiopc_thread_priority`: the thread runs at its default priority.
+ */
+#define THREAD_PRIORITY_NORMAL 0
+
+/**
+ * `audiopc_thread_priority`: the thread got a raised nice value.
+ */
+#define THREAD_PRIORITY_ELEVATED 1
+
+/**
+ * `audiopc_thread_priority`: the thread runs under `SCHED_FIFO`.
+ */
+#define THREAD_PRIORITY_REALTIME 2
+
+/**
+ * `audiopc_thread_priority`: elevation was requested but not permitted.
+ */
+#define THREAD_PRIORITY_DENIED -1
+
+/**
+ * `SCHED_FIFO` priority requested for the output callback (Linux, 1–99).
+ * Kept low so device and IRQ threads still preempt it.
+ */
+#define THREAD_RT_PRIORITY_CALLBACK 10
+
+/**
+ * Nice value for the output callback when `SCHED_FIFO` is refused.
+ */
+#define THREAD_NICE_CALLBACK -11
+
+/**
+ * Nice value for decode workers while elevated priority is enabled.
+ */
+#define THREAD_NICE_DECODE -6
+
+/**
+ * `audiopc_schedule*` command: start or resume playback.
+ */
+#define SCHEDULE_PLAY 0
+
+/**
+ * `audiopc_schedule*` command: pause playback, keeping the position.
+ */
+#define SCHEDULE_PAUSE 1
+
+/**
+ * `audiopc_schedule*` command: jump to `value` ms.  The target is decoded
+ * ahead, so the jump itself is sample-exact.
+ */
+#define SCHEDULE_SEEK 2
+
+/**
+ * `audiopc_schedule*` command: set the volume to `value`.
+ */
+#define SCHEDULE_VOLUME 3
+
+/**
+ * Commands that can be pending at once; one of them may be a seek.
+ */
+#define MAX_SCHEDULED_COMMANDS 64
+
 int32_t audiopc_default_output_sample_rate(void);
 
 int32_t audiopc_default_output_channels(void);
@@ -79,6 +572,12 @@ int32_t audiopc_set_source_path(const char *path);
 
 int32_t audiopc_set_source_url(const char *url);
 
+/**
+ * Set a live Icecast/SHOUTcast or HLS (`.m3u8`) stream as the source.  The
+ * stream is buffered, reconnects automatically and cannot seek.
+ */
+int32_t audiopc_set_source_live(const char *url);
+
 int32_t audiopc_set_source_memory(const uint8_t *data, int32_t len);
 
 int32_t audiopc_play(void);
@@ -95,8 +594,25 @@ float audiopc_get_rate(void);
 
 int32_t audiopc_set_max_queue_seconds(int32_t seconds);
 
+/**
+ * Enable (non-zero) or disable (0) TPDF dither on integer output formats.
+ */
+int32_t audiopc_set_output_dither(int32_t enabled);
+
 int32_t audiopc_get_max_queue_seconds(void);
 
+/**
+ * Choose how decoded samples are queued: `QUEUE_STORAGE_F32`,
+ * `QUEUE_STORAGE_I16` or `QUEUE_STORAGE_F16`.  The 16-bit modes halve the
+ * memory of long queues.
+ */
+int32_t audiopc_set_queue_storage(int32_t mode);
+
+/**
+ * Bytes allocated for the decoded sample queue.
+ */
+int64_t audiopc_queue_bytes(void);
+
 int32_t audiopc_buffered_samples(void);
 
 int32_t audiopc_buffered_millis(void);
@@ -105,12 +621,76 @@ int32_t audiopc_seek_millis(int32_t millis);
 
 int32_t audiopc_duration_millis(void);
 
+/**
+ * Progress of the background load started by the last `set_source` call
+ * (one of the `SOURCE_LOAD_*` constants).
+ */
+int32_t audiopc_source_load_state(void);
+
 int32_t audiopc_position_millis(void);
 
+/**
+ * Current host time (ns): the time base of `audiopc_schedule_at_time` and
+ * the clock queries, shared by everything in the process.
+ */
+int64_t audiopc_clock_now_ns(void);
+
+/**
+ * Output frame (engine sample time) heard at host time `host_ns`, or -1
+ * until the output has started.
+ */
+int64_t audiopc_clock_frame_at(int64_t host_ns);
+
+/**
+ * Host time (ns) at which output frame `frame` is heard, or -1 until the
+ * output has started.
+ */
+int64_t audiopc_clock_time_at(int64_t frame);
+
+/**
+ * Run `command` (`SCHEDULE_*`, taking `value` as its argument) when output
+ * frame `frame` is heard, splitting the callback block at that sample.
+ * Starts the output if needed.  Returns the command's id (> 0), which tags
+ * its `EVENT_SCHEDULE_FIRED` event.
+ */
+int32_t audiopc_schedule(int32_t command, double value, int64_t frame);
+
+/**
+ * Like `audiopc_schedule`, due at host time `host_ns` (see
+ * `audiopc_clock_now_ns`).
+ */
+int32_t audiopc_schedule_at_time(int32_t command, double value, int64_t host_ns);
+
+/**
+ * Cancel scheduled command `id`.
+ */
+int32_t audiopc_cancel_scheduled(int32_t id);
+
+/**
+ * Cancel every scheduled command.
+ */
+int32_t audiopc_clear_schedule(void);
+
 int32_t audiopc_is_playing(void);
 
 int32_t audiopc_get_player_state(void);
 
+/**
+ * Wait up to `timeout_ms` for the next engine event and write it into
+ * `buffer` as JSON: `{"kind": EVENT_*, ...fields}`.
+ *
+ * Blocks without holding the engine lock, so call it from a dedicated
+ * thread or isolate.  `buffer` should hold `EVENT_JSON_MAX_BYTES`.
+ * Returns the JSON length, 0 on timeout, -2 for bad arguments or an event
+ * that did not fit (it is discarded), -500 if the engine is unavailable.
+ */
+int32_t audiopc_wait_event(char *buffer, int32_t max_len, int32_t timeout_ms);
+
+/**
+ * Events discarded so far because nobody drained the bus in time.
+ */
+int64_t audiopc_dropped_event_count(void);
+
 int32_t audiopc_visualizer_available_samples(void);
 
 int32_t audiopc_visualizer_sample_rate(void);
@@ -140,3 +720,134 @@ int32_t audiopc_set_notch_filter(float center_hz, float q);
 int32_t audiopc_set_lowpass_hz(double cutoff_hz, float q);
 
 int32_t audiopc_set_high_pass_filter(float cutoff_hz, float q);
+
+/**
+ * Convolve the output with the impulse response in the file at `path`.
+ * Blocks while the IR is decoded and transformed.
+ */
+int32_t audiopc_set_convolution_ir_path(const char *path, float wet, float dry);
+
+/**
+ * Convolve the output with an impulse response given as `len` encoded
+ * bytes.
+ */
+int32_t audiopc_set_convolution_ir_memory(const uint8_t *data, int32_t len, float wet, float dry);
+
+int32_t audiopc_set_convolution_mix(float wet, float dry);
+
+int32_t audiopc_clear_convolution(void);
+
+/**
+ * Decode the file at `path` once and cache it under `key`.
+ */
+int32_t audiopc_preload_sample_path(const char *key, const char *path);
+
+/**
+ * Decode `len` encoded bytes once and cache them under `key`.
+ */
+int32_t audiopc_preload_sample_memory(const char *key, const uint8_t *data, int32_t len);
+
+/**
+ * Play the sound cached under `key` on top of the current source.
+ */
+int32_t audiopc_play_sample(const char *key, float gain);
+
+/**
+ * Remove the sound cached under `key`.  Returns `-1` if there was none.
+ */
+int32_t audiopc_unload_sample(const char *key);
+
+int32_t audiopc_clear_sample_bank(void);
+
+/**
+ * Set the sample bank's memory budget in bytes, evicting least recently
+ * used sounds if it is exceeded.
+ */
+int32_t audiopc_set_sample_bank_budget(int64_t bytes);
+
+/**
+ * Bytes currently held by cached sounds.
+ */
+int64_t audiopc_sample_bank_bytes(void);
+
+/**
+ * Record the input device `device_name` (null for the system default) to a
+ * WAV file at `path`, replacing any running capture.  `format` is
+ * `CAPTURE_FORMAT_WAV_PCM16` or `CAPTURE_FORMAT_WAV_F32`; a non-zero
+ * `monitor` also plays the input through the effect chains.
+ */
+int32_t audiopc_start_capture(const char *path, const char *device_name, int32_t format, int32_t monitor);
+
+/**
+ * Stop the running capture and finalise its file.
+ */
+int32_t audiopc_stop_capture(void);
+
+/**
+ * Start (non-zero) or stop (0) monitoring the running capture.  Fails when
+ * the input could not be opened at the output sample rate.
+ */
+int32_t audiopc_set_capture_monitor(int32_t enabled);
+
+/**
+ * Input frames the running capture dropped because the writer fell
+ * behind, or -1 when nothing is being captured.
+ */
+int64_t audiopc_capture_dropped_frames(void);
+
+/**
+ * Write the running capture's state (frames, drops, backlogs) as JSON into
+ * `buffer`.  Returns -1 when nothing is being captured.
+ */
+int32_t audiopc_get_capture_stats(char *buffer, int32_t max_len);
+
+/**
+ * Analyse the file or URL at `path` (tempo, beat grid, onsets) and write
+ * the result as JSON into `buffer`.  Blocks while decoding unless the
+ * result is cached; the engine is not needed.
+ */
+int32_t audiopc_analyze_track(const char *path, char *buffer, int32_t max_len);
+
+/**
+ * Analyse the paths in the JSON array `paths_json` in the background on up
+ * to `threads` threads (0 = one per core).  Returns the job id (> 0) that
+ * tags its `EVENT_ANALYSIS_*` events.
+ */
+int32_t audiopc_start_analysis(const char *paths_json, int32_t threads);
+
+/**
+ * Cancel a batch analysis started by `audiopc_start_analysis`.
+ */
+int32_t audiopc_cancel_analysis(int32_t job);
+
+/**
+ * Forget every cached analysis result.
+ */
+int32_t audiopc_clear_analysis_cache(void);
+
+/**
+ * Request (non-zero) or drop (0) elevated priority for the output callback
+ * and decode workers.  Linux only; applied by each thread on its next
+ * iteration, so it works before or after the engine is initialised.
+ */
+int32_t audiopc_set_realtime_priority(int32_t enabled);
+
+/**
+ * Priority most recently obtained by the threads of `role`
+ * (`THREAD_ROLE_*`), as a `THREAD_PRIORITY_*` code.
+ */
+int32_t audiopc_thread_priority(int32_t role);
+
+/**
+ * Write a JSON snapshot of the engine's runtime metrics into `buffer`.
+ */
+int32_t audiopc_get_metrics(char *buffer, int32_t max_len);
+
+/**
+ * Export the recent callback history as a Chrome trace-event JSON file.
+ */
+int32_t audiopc_write_metrics_trace(const char *path);
+
+int32_t audiopc_reset_metrics(void);
+
+int32_t audiopc_underrun_count(void);
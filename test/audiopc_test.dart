@@ -1,3 +1,5 @@
+import 'dart:io';
+import 'dart:math';
 import 'dart:typed_data';
 
 import 'package:test/test.dart';
@@ -5,6 +7,42 @@ import 'package:audiopc/audiopc.dart';
 
 const assetPath = "test/assets/";
 
+/// Writes [seconds] of a 16-bit stereo 440 Hz tone as a WAV file.
+String writeToneWav(
+  String path, {
+  double seconds = 1,
+  int sampleRate = 44100,
+}) {
+  final frames = (seconds * sampleRate).round();
+  final data = ByteData(44 + frames * 4);
+  void tag(int offset, String s) {
+    for (var i = 0; i < 4; i++) {
+      data.setUint8(offset + i, s.codeUnitAt(i));
+    }
+  }
+
+  tag(0, 'RIFF');
+  data.setUint32(4, 36 + frames * 4, Endian.little);
+  tag(8, 'WAVE');
+  tag(12, 'fmt ');
+  data.setUint32(16, 16, Endian.little);
+  data.setUint16(20, 1, Endian.little);
+  data.setUint16(22, 2, Endian.little);
+  data.setUint32(24, sampleRate, Endian.little);
+  data.setUint32(28, sampleRate * 4, Endian.little);
+  data.setUint16(32, 4, Endian.little);
+  data.setUint16(34, 16, Endian.little);
+  tag(36, 'data');
+  data.setUint32(40, frames * 4, Endian.little);
+  for (var i = 0; i < frames; i++) {
+    final v = (sin(2 * pi * 440 * i / sampleRate) * 8000).round();
+    data.setInt16(44 + i * 4, v, Endian.little);
+    data.setInt16(46 + i * 4, v, Endian.little);
+  }
+  File(path).writeAsBytesSync(data.buffer.asUint8List());
+  return path;
+}
+
 /// Placeholder test entrypoint for the audiopc package.
 void main() {
   test("Device capabilities", () {
@@ -48,4 +86,107 @@ void main() {
       );
     }, skip: true); // Skipping this test for now since it requires an actual audio file
   });
+
+  group("Cold start", () {
+    final player = AudioPlayer();
+
+    test("set_source returns before the probe", () async {
+      final dir = Directory.systemTemp.createTempSync('audiopc');
+      final path = writeToneWav('${dir.path}/tone.wav');
+      player.resetMetrics();
+
+      final watch = Stopwatch()..start();
+      final ok = player.setFileSource(path);
+      final returnedUs = watch.elapsedMicroseconds;
+      player.play();
+
+      var metrics = player.getMetrics();
+      while (metrics['startup_us']['count'] == 0 &&
+          watch.elapsed.inSeconds < 5) {
+        await Future<void>.delayed(const Duration(milliseconds: 5));
+        metrics = player.getMetrics();
+      }
+      player.stop();
+      dir.deleteSync(recursive: true);
+
+      // ignore: avoid_print
+      print(
+        'set_source returned in $returnedUs us; '
+        'probe took ${metrics['source_load_us']['max']} us; '
+        'play -> first audio ${metrics['startup_us']['max']} us',
+      );
+      expect(ok, isTrue);
+      expect(
+        returnedUs,
+        lessThan(50000),
+        reason: "set_source must not probe on the caller's thread",
+      );
+      expect(
+        metrics['startup_us']['count'],
+        greaterThan(0),
+        reason: "audio should start within 5 s",
+      );
+    });
+  });
+
+  group("Visualizer frame loop", () {
+    final player = AudioPlayer();
+
+    test("copyInto polls without allocating per frame", () async {
+      const frames = 600;
+      const maxSamples = 2048;
+      const maxBars = 64;
+
+      final dir = Directory.systemTemp.createTempSync('audiopc');
+      final path = writeToneWav('${dir.path}/tone.wav', seconds: 5);
+      expect(player.setFileSource(path), isTrue);
+      player.play();
+      final wait = Stopwatch()..start();
+      while (player.visualizerAvailableSamples < maxSamples &&
+          wait.elapsed.inSeconds < 5) {
+        await Future<void>.delayed(const Duration(milliseconds: 5));
+      }
+
+      // Fresh lists every frame, as getVisualizer* hand out.
+      var kept = 0;
+      final copying = Stopwatch()..start();
+      for (var i = 0; i < frames; i++) {
+        kept += player.getVisualizerSamples(maxSamples).length;
+        kept += player.getVisualizerSpectrum(maxBars).length;
+      }
+      copying.stop();
+
+      // One pair of lists reused for every frame.
+      final samples = Float32List(maxSamples);
+      final bars = Float32List(maxBars);
+      var written = 0;
+      final reusing = Stopwatch()..start();
+      for (var i = 0; i < frames; i++) {
+        written += player.copyVisualizerSamplesInto(samples);
+        written += player.copyVisualizerSpectrumInto(bars);
+      }
+      reusing.stop();
+
+      player.stop();
+      dir.deleteSync(recursive: true);
+
+      // ignore: avoid_print
+      print(
+        'visualizer poll per frame: '
+        'new lists ${(copying.elapsedMicroseconds / frames).toStringAsFixed(1)} us, '
+        'copyInto ${(reusing.elapsedMicroseconds / frames).toStringAsFixed(1)} us',
+      );
+      expect(
+        written,
+        greaterThan(0),
+        reason: "the tone should reach the visualizer",
+      );
+      expect(kept, greaterThan(0));
+      expect(
+        reusing.elapsedMicroseconds / frames,
+        lessThan(1000),
+        reason: "polling must fit easily in a 60 Hz frame",
+      );
+    });
+  });
 }